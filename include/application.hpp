@@ -2,6 +2,7 @@
 #define VKPLAYGROUND_APPLICATION_HPP
 
 #include <iostream>
+#include <memory>
 #include <vector>
 
 #if defined(__unix__)
@@ -14,14 +15,41 @@
 #include <GLFW/glfw3.h>
 
 #include <shader.hpp>
+#include <shader_watcher.hpp>
+#include <settings.hpp>
+#include <frame_stats.hpp>
+#include <frame_pacer.hpp>
+#include <gpu_profiler.hpp>
+#include <pipeline_cache.hpp>
+#include <pipeline_compiler.hpp>
+#include <thread_pool.hpp>
+#include <memory_allocator.hpp>
+#include <timeline_semaphore.hpp>
+#include <deletion_queue.hpp>
+#include <vk_handle.hpp>
+#include <upload_manager.hpp>
+#include <geometry.hpp>
+#include <mesh_loader.hpp>
+#include <particle_system.hpp>
+#include <compute_queue.hpp>
+#include <object_culler.hpp>
+#include <instance_renderer.hpp>
+#include <render_graph.hpp>
+#include <render_queue.hpp>
+#include <bindless_descriptors.hpp>
+#include <uniform_ring.hpp>
 #include <callbacks.hpp>
 
 namespace vk_playground {
+    struct glfw_window_deleter {
+        void operator ()(GLFWwindow* window) const {
+            glfwDestroyWindow(window);
+            glfwTerminate();
+        }
+    };
+
     class application {
         constexpr static const char* enabled_layers[] = { "VK_LAYER_KHRONOS_validation" };
-        constexpr static const char* enabled_device_extensions[] = { VK_KHR_SWAPCHAIN_EXTENSION_NAME };
-
-        constexpr static const int max_frames_in_flight = 2;
 
         constexpr static bool enable_validation_layers =
 #if defined(_GLIBCXX_DEBUG) || defined(_DEBUG)
@@ -35,38 +63,154 @@ namespace vk_playground {
         constexpr static const int width = 1280;
         constexpr static const int height = 720;
 
+        constexpr static const std::uint32_t offscreen_image_count = 3;
+        constexpr static const std::uint32_t max_profiler_regions = 16;
+        // Largest draw count of the record benchmark, the uniform ring is sized for it
+        constexpr static const std::uint32_t max_record_benchmark_draws = 100'000;
+
+        settings config{};
+        std::uint32_t max_frames_in_flight{};
+
         std::vector<VkExtensionProperties> extensions{};
         std::vector<VkQueueFamilyProperties> queue_families{};
-        std::vector<VkImage> swapchain_images{};
-        std::vector<VkImageView> swapchain_image_views{};
-        std::vector<VkFramebuffer> swapchain_framebuffers{};
 
-        VkInstance instance{};
+        // Owning members are declared parents first, so the implicit destruction after
+        // ~application() tears children down before the objects they were created from
+        std::unique_ptr<GLFWwindow, glfw_window_deleter> window{};
+        unique_instance instance{};
         VkDebugUtilsMessengerEXT debug_messenger{};
+        unique_surface surface{};
         VkPhysicalDevice physical_device{};
-        VkDevice device{};
+        VkPhysicalDeviceProperties device_properties{};
+        unique_device device{};
         VkQueue queue_handle{};
-        VkCommandPool command_pool{};
-        std::vector<VkCommandBuffer> command_buffers{};
-        VkSurfaceKHR surface{};
-        VkSwapchainKHR swapchain{};
+        // Same as the graphics family and queue when the device has no transfer-only family
+        std::uint32_t transfer_family{};
+        VkQueue transfer_queue_handle{};
+        // Compute-only family when there is one, else a second graphics family queue, else the graphics queue itself
+        std::uint32_t compute_family{};
+        VkQueue compute_queue_handle{};
+        memory_allocator allocator{};
+        deletion_queue deletions{};
+        upload_manager uploads{};
+        // --mesh file, or a single triangle when none is given
+        mesh model{};
+        // Every buffer and image shaders index, bound once per command buffer with indices pushed per draw
+        bindless_descriptors bindless{};
+        // Tint per submesh of the model, material.frag reads it through the bindless buffer array
+        buffer_allocation materials{};
+        std::uint32_t material_slot{};
+        // Per draw transforms, one region per frame in flight bound at set 1 of the bindless layout
+        uniform_ring uniforms{};
+        // The model's copies and submeshes in sort key order, rebuilt whenever the main pass is recorded
+        render_queue draw_queue{};
+        // Per recording thread, summed into recorded_binds once every thread is done
+        std::vector<bind_counts> thread_binds{};
+        bind_counts recorded_binds{};
+        // Set once the model's upload has been flushed, draws are skipped until then
+        bool geometry_ready{};
+        mesh_load_statistics mesh_load{};
+        double mesh_load_ms{};
+        particle_system particles{};
+        // --async-compute: step n of the simulation runs on the compute queue while the frame drawing step n - 1 renders
+        compute_queue compute{};
+        gpu_profiler compute_profiler{};
+        bool async_simulation{};
+        std::uint64_t particle_step{};
+        // Compute timeline value of the last submitted step, graphics waits on it before drawing the result
+        std::uint64_t particle_compute_value{};
+        // --objects, culled on the cpu or in a compute pass feeding indirect draws
+        object_culler objects{};
+        // Indirect draws need multiDrawIndirect and drawIndirectFirstInstance, the count buffer VK_KHR_draw_indirect_count
+        bool indirect_draws_supported{};
+        PFN_vkCmdDrawIndexedIndirectCount draw_indirect_count{};
+        bool gpu_driven{};
+        cull_view object_view{};
+        std::uint64_t frames_drawn{};
+        // --instances, one instanced draw with a per frame instance stream
+        instance_renderer instanced{};
+        // Passes of a frame, rebuilt when the set of passes that have work changes
+        std::unique_ptr<render_graph> frame_graph{};
+        std::uint32_t frame_graph_key{};
+        graph_resource frame_target{};
+        // What the pass callbacks record for, set before the graph is executed
+        struct graph_recording {
+            std::uint32_t image_index;
+            std::uint32_t profiler_slot;
+            std::uint32_t threads;
+        } recording{};
+
+        unique_swapchain swapchain{};
         struct final_swapchain {
             VkSurfaceFormatKHR format;
             VkPresentModeKHR present_mode;
             VkExtent2D resolution;
             std::uint32_t image_count;
         } swapchain_info{};
+        std::vector<VkImage> swapchain_images{};
+        std::vector<unique_image_view> swapchain_image_views{};
+        std::vector<unique_framebuffer> swapchain_framebuffers{};
+        std::vector<image_allocation> offscreen_images{};
+        std::uint32_t swapchain_recreations{};
+        bool framebuffer_resized{};
+
+        unique_command_pool command_pool{};
+        std::vector<VkCommandBuffer> command_buffers{};
+        std::vector<unique_command_pool> frame_command_pools{};
+        std::vector<VkCommandBuffer> frame_command_buffers{};
+        std::vector<VkCommandBuffer> upload_command_buffers{};
+        // [frame in flight][recording thread]
+        std::vector<std::vector<unique_command_pool>> secondary_command_pools{};
+        std::vector<std::vector<VkCommandBuffer>> secondary_command_buffers{};
+        std::uint32_t draw_count{};
+        std::size_t current_frame{};
+
+        shader_module_cache shader_cache{};
         std::vector<shader> shader_modules{};
-        VkRenderPass render_pass{};
-        VkPipelineLayout pipeline_layout{};
-        VkPipeline graphics_pipeline{};
+        unique_render_pass render_pass{};
+        unique_pipeline graphics_pipeline{};
+        pipeline_cache pipelines{};
+        thread_pool workers{};
+        pipeline_compiler compiler{};
+        std::future<VkPipeline> pending_graphics_pipeline{};
+        // Kept to rebuild the pipeline with new stages
+        graphics_pipeline_description graphics_pipeline_info{};
+        std::vector<std::filesystem::path> graphics_shader_sources{};
+
+        // Hot reload: changed sources wait while a compile is running, the new shader waits for its pipeline
+        shader_watcher shader_changes{};
+        std::vector<std::filesystem::path> changed_shader_sources{};
+        // Sources the running compile was started with, they decide which pipelines are rebuilt
+        std::vector<std::filesystem::path> compiling_shader_sources{};
+        std::future<bool> pending_shader_compile{};
+        bool reloading_pipelines{};
+        std::future<VkPipeline> pending_reload_pipeline{};
+        shader reloaded_shader{};
+        bench_clock::time_point reload_start{};
+        std::uint32_t shader_reloads{};
 
-        std::vector<VkSemaphore> image_available{};
-        std::vector<VkSemaphore> render_finish{};
-        std::vector<VkFence> frames_in_flight{};
-        std::vector<VkFence> images_in_flight{};
+        // Binary semaphores are still required by acquire and present, everything
+        // else waits on the graphics queue's timeline
+        std::vector<unique_semaphore> image_available{};
+        std::vector<unique_semaphore> render_finish{};
+        timeline_semaphore graphics_timeline{};
+        // Timeline value of the last submission using each frame slot / swapchain image
+        std::vector<std::uint64_t> frame_values{};
+        std::vector<std::uint64_t> image_values{};
+        // When each frame slot's last submission sampled input, pending until the timeline is seen past it
+        std::vector<bench_clock::time_point> frame_input_times{};
+        std::vector<bool> input_latency_pending{};
+        bench_clock::time_point input_time{};
+        frame_pacer pacer{};
 
-        GLFWwindow* window{};
+        gpu_profiler profiler{};
+        std::uint32_t profiler_slots{};
+        frame_timing current_timing{};
+        frame_statistics statistics{};
+        double startup_ms{};
+        double pipeline_ms{};
+        double pipeline_wait_ms{};
+        double prerecord_ms{};
 
         void setup_debug_callback();
         void enable_required_extensions();
@@ -76,26 +220,65 @@ namespace vk_playground {
         void init_physical_device();
         void init_queues_families();
         size_t get_graphics_queue_index() const;
+        std::uint32_t get_transfer_queue_index() const;
+        std::uint32_t get_compute_queue_index() const;
+        bool has_core_timeline_semaphore() const;
         void create_device();
+        void create_pipeline_cache();
         void init_command_pool();
         void init_command_buffer();
-        void create_swapchain();
+        void init_frame_command_pools();
+        void create_swapchain(VkSwapchainKHR old_swapchain = nullptr);
+        void recreate_swapchain();
+        void create_offscreen_images();
         void create_image_views();
         void create_shader_modules();
         void create_render_pass();
         void create_pipeline();
+        void create_geometry();
+        void create_uniforms();
+        void create_materials();
+        void flush_uploads_blocking();
+        bool record_uploads(std::uint64_t signal_value, std::vector<semaphore_wait>& waits);
+        void submit_graphics(const std::vector<VkCommandBuffer>&, std::uint64_t signal_value, const std::vector<semaphore_wait>& waits, bool swapchain_sync);
+        void submit_simulation(std::uint64_t graphics_value);
+        void measure_async_overlap();
+        void wait_pipelines();
+        std::vector<std::filesystem::path> reloadable_shader_sources() const;
+        void poll_shader_reload();
+        void swap_reloaded_pipelines();
+        void retire_command_buffers(std::uint64_t value);
         void create_framebuffer();
+        void record_command_buffers();
+        void record_command_buffer(const VkCommandBuffer&, std::uint32_t image_index, std::uint32_t profiler_slot, VkCommandBufferUsageFlags, std::uint32_t threads);
+        void build_frame_graph(std::uint32_t key);
+        void dump_transient_graph();
+        void record_main_pass(const VkCommandBuffer&);
+        void record_secondary(std::uint32_t image_index, std::uint32_t thread, std::uint32_t threads);
+        void build_draw_queue();
+        // Draws this thread's share of the frame, thread 0 of 1 records everything
+        void record_draws(const VkCommandBuffer&, std::uint32_t thread, std::uint32_t threads);
         void create_semaphores();
+        void init_profiler();
+        void create_graphics_profiler();
 
-        void draw_frame();
+        void collect_input_latency(std::size_t frame);
+        // False when the swapchain was out of date and recreated instead, nothing was drawn
+        bool draw_frame();
+        void report_benchmark() const;
+        void run_record_benchmark();
+        void run_cull_benchmark();
 
     public:
-        application() = default;
+        application() : application(settings{}) {}
+        explicit application(const settings&);
         ~application();
 
         void glfw_init();
         void vk_init();
         void run();
+
+        const std::vector<gpu_region_timing>& gpu_timings() const;
     };
 } // namespace vk_playground
 
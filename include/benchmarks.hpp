@@ -0,0 +1,34 @@
+#ifndef VKPLAYGROUND_BENCHMARKS_HPP
+#define VKPLAYGROUND_BENCHMARKS_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include <vulkan/vulkan.h>
+
+namespace vk_playground {
+    class memory_allocator;
+    class thread_pool;
+
+    // Writes json to path, or to stdout when path is empty
+    void emit_json(const std::string& path, const std::string& json);
+    // Contents of a JSON string literal for text that isn't ours, like the driver's device name
+    std::string json_escape(std::string_view text);
+
+    // Random allocate/free churn through tlsf_allocator, memory_allocator and plain vkAllocateMemory
+    void run_allocator_benchmark(const VkDevice&, memory_allocator&, std::uint32_t operations, const std::string& json_path);
+
+    // Per object uniforms from uniform_ring with dynamic offsets against one VkBuffer and descriptor set per object:
+    // allocations per second and cpu cost of updating and binding them per draw
+    void run_uniform_benchmark(const VkDevice&, memory_allocator&, const VkPhysicalDeviceLimits&, std::uint32_t queue_family,
+                               std::uint32_t objects, const std::string& json_path);
+
+    // render_queue's radix sort against std::sort over draw keys with random pipelines, materials and depths
+    void run_sort_benchmark(std::uint32_t draws, const std::string& json_path);
+
+    // scene_store transform update and frustum culling from 10k to 10M objects, every cull kernel the cpu runs side by side
+    void run_scene_benchmark(thread_pool&, const std::string& json_path);
+} // namespace vk_playground
+
+#endif //VKPLAYGROUND_BENCHMARKS_HPP
@@ -0,0 +1,103 @@
+#ifndef VKPLAYGROUND_BINDLESS_DESCRIPTORS_HPP
+#define VKPLAYGROUND_BINDLESS_DESCRIPTORS_HPP
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include <vk_handle.hpp>
+
+namespace vk_playground {
+    // Push constant block of every bindless pipeline, layout shared with the shaders' bindless_indices
+    struct bindless_indices {
+        std::uint32_t image;
+        std::uint32_t sampler;
+        std::uint32_t buffer;
+        // Element inside the buffer (material, object...), meaning is up to the shader
+        std::uint32_t element;
+    };
+
+    // Array sizes asked for, clamped to the device's update after bind limits
+    struct bindless_limits {
+        std::uint32_t images = 4096;
+        std::uint32_t samplers = 64;
+        std::uint32_t buffers = 1024;
+    };
+
+    // Free list over the slots of one descriptor array, released slots are handed out again before new ones
+    class descriptor_slot_allocator {
+        std::vector<std::uint32_t> free_slots{};
+        std::uint32_t next{};
+        std::uint32_t slot_count{};
+
+    public:
+        descriptor_slot_allocator() = default;
+
+        void create(std::uint32_t capacity);
+
+        std::uint32_t allocate();
+        // The slot must come from allocate() and not have been released since
+        void release(std::uint32_t slot);
+
+        std::uint32_t size() const;
+        std::uint32_t capacity() const;
+    };
+
+    // One descriptor set with every sampled image, sampler and storage buffer the renderer uses,
+    // bound once per command buffer. Draws select what they read through bindless_indices pushed
+    // as constants, so there's no per draw vkCmdBindDescriptorSets and no descriptor pool churn.
+    //
+    // Bindings are partially bound and update after bind: slots can be written while the set is
+    // bound in command buffers in flight, as long as those don't use the slots being written.
+    class bindless_descriptors {
+        VkDevice device{};
+
+        unique_descriptor_set_layout set_layout{};
+        unique_descriptor_pool descriptor_pool{};
+        VkDescriptorSet descriptor_set{};
+        // Shared by every bindless pipeline, graphics and compute
+        unique_pipeline_layout layout{};
+
+        descriptor_slot_allocator images{};
+        descriptor_slot_allocator samplers{};
+        descriptor_slot_allocator buffers{};
+        bindless_limits clamped{};
+
+    public:
+        constexpr static std::uint32_t image_binding = 0;
+        constexpr static std::uint32_t sampler_binding = 1;
+        constexpr static std::uint32_t buffer_binding = 2;
+        constexpr static VkShaderStageFlags stages = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_COMPUTE_BIT;
+
+        // Whether the descriptor indexing features it relies on are all there
+        static bool supported(const VkPhysicalDeviceDescriptorIndexingFeatures&);
+        // Only the features supported() checks for, to chain into VkDeviceCreateInfo
+        static VkPhysicalDeviceDescriptorIndexingFeatures required_features();
+
+        bindless_descriptors() = default;
+
+        // extra_sets follow the bindless set (set 0) in the shared pipeline layout
+        void create(const VkDevice&, const VkPhysicalDeviceDescriptorIndexingProperties&,
+                    std::span<const VkDescriptorSetLayout> extra_sets = {}, bindless_limits = {});
+        void destroy();
+
+        VkPipelineLayout pipeline_layout() const;
+        const bindless_limits& limits() const;
+
+        // Writes the descriptor into a free slot and returns its index
+        std::uint32_t add_image(VkImageView, VkImageLayout);
+        std::uint32_t add_sampler(VkSampler);
+        std::uint32_t add_buffer(VkBuffer, VkDeviceSize offset = 0, VkDeviceSize range = VK_WHOLE_SIZE);
+        // The slot is reused by the next add, command buffers in flight must be done with it
+        void remove_image(std::uint32_t slot);
+        void remove_sampler(std::uint32_t slot);
+        void remove_buffer(std::uint32_t slot);
+
+        void bind(const VkCommandBuffer&, VkPipelineBindPoint) const;
+        void push(const VkCommandBuffer&, const bindless_indices&) const;
+    };
+} // namespace vk_playground
+
+#endif //VKPLAYGROUND_BINDLESS_DESCRIPTORS_HPP
@@ -62,6 +62,11 @@ namespace vk_playground {
                                  callback_data->pMessage);
         return 0;
     }
+
+    static void framebuffer_resize_callback(GLFWwindow* window, int, int) {
+        // The window's user pointer is the application's resize flag
+        *static_cast<bool*>(glfwGetWindowUserPointer(window)) = true;
+    }
 }
 
 #endif //VKPLAYGROUND_CALLBACKS_HPP
@@ -0,0 +1,47 @@
+#ifndef VKPLAYGROUND_COMPUTE_QUEUE_HPP
+#define VKPLAYGROUND_COMPUTE_QUEUE_HPP
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include <timeline_semaphore.hpp>
+#include <vk_handle.hpp>
+
+namespace vk_playground {
+    // Queue for compute work that runs beside graphics (culling, simulation, post processing).
+    // It has its own timeline and a command pool per frame slot, ordering against graphics only
+    // happens through the semaphore waits given to submit() and the timeline graphics waits on.
+    class compute_queue {
+        VkDevice device{};
+        std::uint32_t family{};
+        VkQueue queue{};
+        bool separate{};
+
+        timeline_semaphore timeline{};
+        std::vector<unique_command_pool> pools{};
+        std::vector<VkCommandBuffer> command_buffers{};
+        // Timeline value of the last submission from each frame slot
+        std::vector<std::uint64_t> slot_values{};
+
+    public:
+        compute_queue() = default;
+
+        // separate is false when queue is the graphics queue itself, submissions then serialize with graphics
+        void create(const VkDevice&, std::uint32_t family, const VkQueue&, bool separate, bool core_timeline, std::uint32_t frame_count);
+        void destroy();
+
+        bool async() const;
+        std::uint32_t family_index() const;
+        const timeline_semaphore& semaphore() const;
+
+        // Waits for the slot's previous submission (usually long done), resets its pool and begins recording
+        VkCommandBuffer begin(std::uint32_t frame);
+        // Ends and submits the slot's command buffer, returns the timeline value it signals
+        std::uint64_t submit(std::uint32_t frame, std::span<const semaphore_wait> waits);
+    };
+} // namespace vk_playground
+
+#endif //VKPLAYGROUND_COMPUTE_QUEUE_HPP
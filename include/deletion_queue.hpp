@@ -0,0 +1,67 @@
+#ifndef VKPLAYGROUND_DELETION_QUEUE_HPP
+#define VKPLAYGROUND_DELETION_QUEUE_HPP
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <utility>
+
+namespace vk_playground {
+    // Keeps objects alive until the gpu has retired the last submission that may use them.
+    // Entries are tagged with the timeline value of that submission, collect() destroys everything
+    // the timeline has passed, so runtime resource churn never has to wait for the device.
+    class deletion_queue {
+        struct retired_object {
+            virtual ~retired_object() = default;
+        };
+
+        template <typename T>
+        struct retired_value final : retired_object {
+            T value;
+
+            explicit retired_value(T&& value)
+                : value(std::move(value)) {}
+        };
+
+        struct deferred_call final : retired_object {
+            std::function<void()> call;
+
+            explicit deferred_call(std::function<void()>&& call)
+                : call(std::move(call)) {}
+
+            ~deferred_call() override {
+                call();
+            }
+        };
+
+        struct entry {
+            std::uint64_t timeline_value;
+            std::unique_ptr<retired_object> object;
+        };
+
+        // Values only grow, the front is always the first to retire
+        std::deque<entry> entries{};
+
+    public:
+        deletion_queue() = default;
+
+        // Takes ownership of an RAII object (or a container of them), destroyed once the timeline reaches timeline_value
+        template <typename T>
+        void retire(std::uint64_t timeline_value, T object) {
+            entries.push_back({ timeline_value, std::make_unique<retired_value<T>>(std::move(object)) });
+        }
+
+        // For resources without an owning wrapper, call runs once the timeline reaches timeline_value
+        void defer(std::uint64_t timeline_value, std::function<void()> call);
+
+        // Destroys everything retired at or before completed_value
+        void collect(std::uint64_t completed_value);
+        // Destroys everything, the device has to be idle
+        void flush();
+
+        std::size_t size() const;
+    };
+} // namespace vk_playground
+
+#endif //VKPLAYGROUND_DELETION_QUEUE_HPP
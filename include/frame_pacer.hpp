@@ -0,0 +1,28 @@
+#ifndef VKPLAYGROUND_FRAME_PACER_HPP
+#define VKPLAYGROUND_FRAME_PACER_HPP
+
+namespace vk_playground {
+    // Delays the start of a frame (input sampling and recording) by the time it would otherwise
+    // spend blocked on fences and acquire, so the frame is built just before the gpu can take it.
+    // The blocking time is predicted from previous frames, a little slack is left so the gpu never starves.
+    class frame_pacer {
+        constexpr static double max_delay_ms = 50.0;
+
+        bool enabled = false;
+        double slack_ms = 0.0;
+        double predicted_block_ms = 0.0;
+        double last_delay_ms = 0.0;
+
+    public:
+        frame_pacer() = default;
+
+        void create(bool enabled, double slack_ms = 1.0);
+
+        // Sleeps before the frame samples input, returns the time slept in ms
+        double pace();
+        // How long the paced frame still blocked on fences and acquire
+        void update(double blocked_ms);
+    };
+} // namespace vk_playground
+
+#endif //VKPLAYGROUND_FRAME_PACER_HPP
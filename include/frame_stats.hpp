@@ -0,0 +1,92 @@
+#ifndef VKPLAYGROUND_FRAME_STATS_HPP
+#define VKPLAYGROUND_FRAME_STATS_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace vk_playground {
+    using bench_clock = std::chrono::steady_clock;
+
+    static double elapsed_ms(bench_clock::time_point start, bench_clock::time_point end = bench_clock::now()) {
+        return std::chrono::duration<double, std::milli>(end - start).count();
+    }
+
+    struct gpu_region_timing {
+        std::string name;
+        double ms = 0.0;
+        // Raw device timestamp of the region's start in ms, only comparable between regions of the same device
+        double start_ms = 0.0;
+    };
+
+    // State changes a render queue recorded, next to the draws they served
+    struct bind_counts {
+        std::uint32_t draws = 0;
+        std::uint32_t pipelines = 0;
+        std::uint32_t materials = 0;
+        std::uint32_t uniforms = 0;
+
+        bind_counts& operator +=(const bind_counts&);
+    };
+
+    struct frame_timing {
+        double cpu_ms = 0.0;
+        double fence_wait_ms = 0.0;
+        double acquire_wait_ms = 0.0;
+        double record_ms = 0.0;
+        // Writing per frame data into persistently mapped buffers (instance streams)
+        double update_ms = 0.0;
+        // Building and sorting the frame's render queue
+        double sort_ms = 0.0;
+        bind_counts binds{};
+        // Submissions the gpu hadn't finished when the frame started
+        double queue_depth = 0.0;
+        // Time the frame pacer slept before sampling input
+        double pacing_ms = 0.0;
+        // Gpu time per named region, from an earlier frame that has retired
+        std::vector<gpu_region_timing> gpu_regions{};
+        // Input sampling to gpu completion of the earlier frames that retired during this one
+        std::vector<double> input_latency_ms{};
+    };
+
+    struct distribution {
+        double mean = 0.0;
+        double p50 = 0.0;
+        double p95 = 0.0;
+        double p99 = 0.0;
+        double max = 0.0;
+
+        static distribution from_samples(std::vector<double>);
+    };
+
+    class frame_statistics {
+        std::vector<frame_timing> samples{};
+        std::map<std::string, std::vector<double>> gpu_samples{};
+        std::vector<double> latency_samples{};
+
+    public:
+        frame_statistics() = default;
+
+        void reserve(std::size_t);
+        void add(const frame_timing&);
+        std::size_t size() const;
+
+        distribution cpu() const;
+        distribution fence_wait() const;
+        distribution acquire_wait() const;
+        distribution record() const;
+        distribution update() const;
+        distribution sort() const;
+        distribution pacing() const;
+        distribution queue_depth() const;
+        distribution input_latency() const;
+        std::map<std::string, distribution> gpu() const;
+
+        std::string summary() const;
+        std::string json() const;
+    };
+} // namespace vk_playground
+
+#endif //VKPLAYGROUND_FRAME_STATS_HPP
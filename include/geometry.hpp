@@ -0,0 +1,62 @@
+#ifndef VKPLAYGROUND_GEOMETRY_HPP
+#define VKPLAYGROUND_GEOMETRY_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include <vulkan/vulkan.h>
+
+#include <memory_allocator.hpp>
+#include <mesh_format.hpp>
+
+namespace vk_playground {
+    struct vertex {
+        float position[3];
+        float color[3];
+
+        static VkVertexInputBindingDescription binding(std::uint32_t binding = 0) {
+            VkVertexInputBindingDescription description{}; {
+                description.binding = binding;
+                description.stride = sizeof(vertex);
+                description.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+            }
+
+            return description;
+        }
+
+        static std::array<VkVertexInputAttributeDescription, 2> attributes(std::uint32_t binding = 0) {
+            std::array<VkVertexInputAttributeDescription, 2> descriptions{}; {
+                descriptions[0].binding = binding;
+                descriptions[0].location = 0;
+                descriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT;
+                descriptions[0].offset = offsetof(vertex, position);
+
+                descriptions[1].binding = binding;
+                descriptions[1].location = 1;
+                descriptions[1].format = VK_FORMAT_R32G32B32_SFLOAT;
+                descriptions[1].offset = offsetof(vertex, color);
+            }
+
+            return descriptions;
+        }
+    };
+
+    // Mesh files are copied into vertex buffers as they are
+    static_assert(sizeof(vertex) == sizeof(mesh_vertex) &&
+                  offsetof(vertex, position) == offsetof(mesh_vertex, position) &&
+                  offsetof(vertex, color) == offsetof(mesh_vertex, color));
+
+    using index_type = std::uint32_t;
+    constexpr static VkIndexType vk_index_type = VK_INDEX_TYPE_UINT32;
+
+    // Device local vertex and index buffers of one mesh
+    struct mesh_buffers {
+        buffer_allocation vertices{};
+        buffer_allocation indices{};
+        std::uint32_t vertex_count{};
+        std::uint32_t index_count{};
+    };
+} // namespace vk_playground
+
+#endif //VKPLAYGROUND_GEOMETRY_HPP
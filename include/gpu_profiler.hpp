@@ -0,0 +1,49 @@
+#ifndef VKPLAYGROUND_GPU_PROFILER_HPP
+#define VKPLAYGROUND_GPU_PROFILER_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include <frame_stats.hpp>
+
+namespace vk_playground {
+    // Timestamp queries around named regions of a command buffer. Every frame slot owns its
+    // own query pool, results are only read back once the slot's submission has retired,
+    // so collecting never stalls on the gpu.
+    class gpu_profiler {
+        struct frame_queries {
+            VkQueryPool pool{};
+            std::vector<std::string> names{};
+            bool submitted = false;
+        };
+
+        VkDevice device{};
+        std::vector<frame_queries> frames{};
+        std::vector<gpu_region_timing> latest{};
+        std::vector<std::uint64_t> query_data{};
+
+        std::uint32_t max_regions{};
+        double timestamp_period{};
+        std::uint64_t timestamp_mask{};
+
+    public:
+        gpu_profiler() = default;
+
+        void create(const VkDevice&, std::uint32_t frame_count, std::uint32_t max_regions, float timestamp_period, std::uint32_t timestamp_valid_bits);
+        void destroy();
+        bool enabled() const;
+
+        void begin_frame(const VkCommandBuffer&, std::uint32_t frame);
+        std::uint32_t begin_region(const VkCommandBuffer&, std::uint32_t frame, std::string name);
+        void end_region(const VkCommandBuffer&, std::uint32_t frame, std::uint32_t region);
+        void mark_submitted(std::uint32_t frame);
+
+        bool collect(std::uint32_t frame);
+        const std::vector<gpu_region_timing>& results() const;
+    };
+} // namespace vk_playground
+
+#endif //VKPLAYGROUND_GPU_PROFILER_HPP
@@ -0,0 +1,92 @@
+#ifndef VKPLAYGROUND_INSTANCE_RENDERER_HPP
+#define VKPLAYGROUND_INSTANCE_RENDERER_HPP
+
+#include <cstdint>
+#include <filesystem>
+#include <future>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include <deletion_queue.hpp>
+#include <memory_allocator.hpp>
+#include <mesh_loader.hpp>
+#include <pipeline_compiler.hpp>
+#include <shader.hpp>
+#include <thread_pool.hpp>
+#include <vk_handle.hpp>
+
+namespace vk_playground {
+    // Per instance vertex stream, read at VK_VERTEX_INPUT_RATE_INSTANCE by instanced.vert
+    struct instance_data {
+        // xy translation, uniform scale, rotation in radians
+        float transform[4];
+        // RGBA8, a quarter of the bandwidth of a float color
+        std::uint32_t color;
+    };
+
+    // Copies of the model drawn with one instanced draw per submesh. Transforms are rewritten every
+    // frame straight into a persistently mapped buffer with one region per frame in flight, split
+    // over the worker threads, there's no staging copy between the cpu writes and vertex input.
+    class instance_renderer {
+        // Smallest share of the instances worth handing to a worker
+        constexpr static std::uint32_t min_update_chunk = 64 * 1024;
+
+        struct instance_seed {
+            float position[2];
+            float scale;
+            float angle;
+            float spin;
+            std::uint32_t color;
+        };
+
+        VkDevice device{};
+        memory_allocator* allocator{};
+        thread_pool* workers{};
+        const mesh* geometry{};
+        // Kept to rebuild the pipeline when its shaders are reloaded
+        std::filesystem::path shader_directory{};
+        VkRenderPass render_pass{};
+
+        std::vector<instance_seed> seeds{};
+        std::uint32_t frame_count{};
+        // frame_count regions of seeds.size() instances each
+        buffer_allocation instances{};
+
+        unique_pipeline_layout layout{};
+        unique_pipeline pipeline{};
+        std::future<VkPipeline> pending_pipeline{};
+
+        VkDeviceSize region_offset(std::uint32_t frame) const;
+
+    public:
+        instance_renderer() = default;
+
+        // Places count instances over the screen, the stream is host visible and device local where the device has such memory
+        void create(const VkDevice&, memory_allocator&, thread_pool&, shader_module_cache&, pipeline_compiler&,
+                    const std::filesystem::path& shader_directory, const VkRenderPass&, const mesh& model,
+                    std::uint32_t count, std::uint32_t frame_count);
+        void wait_pipelines();
+        void destroy();
+
+        // Sources of the pipeline's stages, compile_pipelines() reads their compiled binaries
+        std::vector<std::filesystem::path> shader_sources() const;
+        // Starts compiling the pipeline, the current one stays in use until wait_pipelines() or swap_pipelines()
+        void compile_pipelines(shader_module_cache&, pipeline_compiler&);
+        bool reload_ready() const;
+        // Replaces the pipeline with the compiled one, the old one is destroyed once the timeline reaches retire_value
+        void swap_pipelines(deletion_queue&, std::uint64_t retire_value);
+
+        bool enabled() const;
+        std::uint32_t size() const;
+        // Bytes written per frame
+        VkDeviceSize frame_bytes() const;
+
+        // Writes the frame slot's region for time_s, the slot's previous submission must have retired
+        void update(std::uint32_t frame, double time_s);
+        // Inside the render pass, viewport and scissor are dynamic and set by the caller
+        void record_draw(const VkCommandBuffer&, std::uint32_t frame) const;
+    };
+} // namespace vk_playground
+
+#endif //VKPLAYGROUND_INSTANCE_RENDERER_HPP
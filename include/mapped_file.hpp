@@ -0,0 +1,36 @@
+#ifndef VKPLAYGROUND_MAPPED_FILE_HPP
+#define VKPLAYGROUND_MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+
+namespace vk_playground {
+    // Read-only mapping of a whole file. Pages are faulted in on first access, so the first
+    // pass over the data is the read, nothing is copied into an intermediate buffer.
+    class mapped_file {
+        const std::byte* mapping{};
+        std::size_t length{};
+#if defined(_WIN32)
+        void* file_handle{};
+        void* mapping_handle{};
+#endif
+
+        void unmap();
+
+    public:
+        mapped_file() = default;
+        explicit mapped_file(const std::filesystem::path&);
+        ~mapped_file();
+
+        mapped_file(const mapped_file&) = delete;
+        mapped_file& operator =(const mapped_file&) = delete;
+        mapped_file(mapped_file&&) noexcept;
+        mapped_file& operator =(mapped_file&&) noexcept;
+
+        std::span<const std::byte> data() const;
+        std::size_t size() const;
+    };
+} // namespace vk_playground
+
+#endif //VKPLAYGROUND_MAPPED_FILE_HPP
@@ -0,0 +1,109 @@
+#ifndef VKPLAYGROUND_MEMORY_ALLOCATOR_HPP
+#define VKPLAYGROUND_MEMORY_ALLOCATOR_HPP
+
+#include <array>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include <suballocator.hpp>
+
+namespace vk_playground {
+    // Buffers and linear images versus optimal tiling images, the two may only share
+    // a page of bufferImageGranularity if they are kept apart.
+    enum class resource_kind {
+        linear,
+        optimal
+    };
+
+    struct allocation {
+        VkDeviceMemory memory{};
+        VkDeviceSize offset{};
+        VkDeviceSize size{};
+        // Persistent host mapping at offset, null for memory that is not host visible
+        void* mapped{};
+
+        std::uint32_t pool = UINT32_MAX;
+        std::uint32_t block{};
+        std::uint32_t handle{};
+    };
+
+    struct buffer_allocation {
+        VkBuffer buffer{};
+        allocation memory{};
+    };
+
+    struct image_allocation {
+        VkImage image{};
+        allocation memory{};
+    };
+
+    struct memory_statistics {
+        std::uint32_t device_allocations{};
+        std::uint32_t sub_allocations{};
+        VkDeviceSize reserved_bytes{};
+        VkDeviceSize used_bytes{};
+        std::uint32_t free_regions{};
+        VkDeviceSize largest_free_region{};
+        // 1 - largest free region / total free bytes, 0 when all free space is contiguous
+        double fragmentation{};
+    };
+
+    // Large VkDeviceMemory blocks per memory type, sub-allocated with tlsf_allocator.
+    // Requests larger than half a block get a dedicated allocation.
+    class memory_allocator {
+        constexpr static std::uint32_t dedicated = UINT32_MAX;
+
+        struct memory_block {
+            VkDeviceMemory memory{};
+            VkDeviceSize size{};
+            void* mapped{};
+            tlsf_allocator allocator{};
+        };
+
+        struct memory_pool {
+            std::uint32_t memory_type{};
+            std::vector<memory_block> blocks{};
+        };
+
+        VkDevice device{};
+        VkPhysicalDeviceMemoryProperties memory_properties{};
+        VkDeviceSize block_size{};
+        VkDeviceSize granularity{};
+        std::uint32_t max_allocations{};
+
+        std::array<memory_pool, VK_MAX_MEMORY_TYPES * 2> pools{};
+        std::uint32_t device_allocation_count{};
+        VkDeviceSize dedicated_bytes{};
+        std::uint32_t dedicated_count{};
+        mutable std::mutex mutex{};
+
+        std::uint32_t pool_index(std::uint32_t memory_type, resource_kind) const;
+        VkDeviceMemory allocate_device_memory(VkDeviceSize, std::uint32_t memory_type, void**);
+
+    public:
+        constexpr static VkDeviceSize default_block_size = 64ull * 1024 * 1024;
+
+        memory_allocator() = default;
+
+        void create(const VkDevice&, const VkPhysicalDevice&, VkDeviceSize block_size = default_block_size);
+        void destroy();
+
+        std::uint32_t find_memory_type(std::uint32_t type_bits, VkMemoryPropertyFlags required, VkMemoryPropertyFlags preferred = 0) const;
+        bool is_host_coherent(const allocation&) const;
+
+        allocation allocate(const VkMemoryRequirements&, VkMemoryPropertyFlags required, VkMemoryPropertyFlags preferred, resource_kind);
+        void free(const allocation&);
+
+        buffer_allocation create_buffer(const VkBufferCreateInfo&, VkMemoryPropertyFlags required, VkMemoryPropertyFlags preferred = 0);
+        image_allocation create_image(const VkImageCreateInfo&, VkMemoryPropertyFlags required, VkMemoryPropertyFlags preferred = 0);
+        void destroy_buffer(const buffer_allocation&);
+        void destroy_image(const image_allocation&);
+
+        memory_statistics statistics() const;
+    };
+} // namespace vk_playground
+
+#endif //VKPLAYGROUND_MEMORY_ALLOCATOR_HPP
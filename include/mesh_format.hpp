@@ -0,0 +1,69 @@
+#ifndef VKPLAYGROUND_MESH_FORMAT_HPP
+#define VKPLAYGROUND_MESH_FORMAT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace vk_playground {
+    // Binary mesh container, laid out so the streams can be copied straight out of a mapping:
+    //
+    //   mesh_header | mesh_submesh[submesh_count] | vertices | indices
+    //
+    // Every section starts at a multiple of mesh_stream_alignment from the start of the file,
+    // all values are little endian. Vertices are mesh_vertex, indices 32 bit.
+    constexpr static std::uint32_t mesh_magic = 0x48534d56; // "VMSH"
+    constexpr static std::uint32_t mesh_version = 1;
+    constexpr static std::uint64_t mesh_stream_alignment = 64;
+
+    struct mesh_vertex {
+        float position[3];
+        float color[3];
+    };
+
+    struct mesh_bounds {
+        float min[3];
+        float max[3];
+    };
+
+    struct mesh_header {
+        std::uint32_t magic;
+        std::uint32_t version;
+        std::uint32_t vertex_stride;
+        std::uint32_t index_size;
+        std::uint32_t vertex_count;
+        std::uint32_t index_count;
+        std::uint32_t submesh_count;
+        std::uint32_t reserved;
+        // Byte offsets from the start of the file
+        std::uint64_t submesh_offset;
+        std::uint64_t vertex_offset;
+        std::uint64_t index_offset;
+        mesh_bounds bounds;
+    };
+
+    // Range of the index stream drawn as one vkCmdDrawIndexed
+    struct mesh_submesh {
+        std::uint32_t first_index;
+        std::uint32_t index_count;
+        std::int32_t vertex_offset;
+        std::uint32_t reserved;
+        mesh_bounds bounds;
+    };
+
+    static_assert(sizeof(mesh_header) == 80 && sizeof(mesh_submesh) == 40, "mesh_format structs must not be padded");
+
+    // Views into a mesh file's bytes, nothing is copied
+    struct mesh_view {
+        const mesh_header* header{};
+        std::span<const mesh_submesh> submeshes{};
+        std::span<const std::byte> vertices{};
+        std::span<const std::byte> indices{};
+    };
+
+    // Validates the header, every section's bounds and that each submesh's indices stay in the
+    // vertex stream, throws on a malformed file
+    mesh_view parse_mesh(std::span<const std::byte> file);
+} // namespace vk_playground
+
+#endif //VKPLAYGROUND_MESH_FORMAT_HPP
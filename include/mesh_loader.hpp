@@ -0,0 +1,37 @@
+#ifndef VKPLAYGROUND_MESH_LOADER_HPP
+#define VKPLAYGROUND_MESH_LOADER_HPP
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+#include <geometry.hpp>
+#include <mesh_format.hpp>
+#include <memory_allocator.hpp>
+#include <upload_manager.hpp>
+
+namespace vk_playground {
+    struct mesh {
+        mesh_buffers buffers{};
+        std::vector<mesh_submesh> submeshes{};
+        mesh_bounds bounds{};
+    };
+
+    struct mesh_load_statistics {
+        std::uint64_t file_bytes{};
+        // Mapping and validating the file, the data itself is only read once it's staged
+        double map_ms{};
+    };
+
+    // Creates device local buffers for view and queues their uploads. The streams are read in place,
+    // owner has to keep the memory behind view alive until the uploads have gone through staging.
+    mesh upload_mesh(memory_allocator&, upload_manager&, const mesh_view&, std::shared_ptr<const void> owner);
+
+    // Maps path and uploads it straight from the mapping, the mapping is released once it's staged
+    mesh load_mesh(const std::filesystem::path&, memory_allocator&, upload_manager&, mesh_load_statistics* = nullptr);
+
+    void destroy_mesh(memory_allocator&, mesh&);
+} // namespace vk_playground
+
+#endif //VKPLAYGROUND_MESH_LOADER_HPP
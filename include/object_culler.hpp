@@ -0,0 +1,152 @@
+#ifndef VKPLAYGROUND_OBJECT_CULLER_HPP
+#define VKPLAYGROUND_OBJECT_CULLER_HPP
+
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <future>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include <deletion_queue.hpp>
+#include <memory_allocator.hpp>
+#include <mesh_loader.hpp>
+#include <pipeline_compiler.hpp>
+#include <scene_store.hpp>
+#include <shader.hpp>
+#include <upload_manager.hpp>
+#include <vk_handle.hpp>
+
+namespace vk_playground {
+    // Copy of the model placed in the xy plane, layout shared with objects.vert and cull.comp
+    struct scene_object {
+        // xy center and radius of the bounding circle, z unused
+        float bounds[4];
+        // xyz translation and uniform scale
+        float transform[4];
+    };
+
+    // 2D camera over the object field: visible area is offset +- 1 / zoom
+    struct cull_view {
+        float offset[2];
+        float zoom;
+        float unused;
+    };
+
+    // Planes of the clip space square the view sees, the same test as cull.comp up to rounding.
+    // The z planes keep everything in the xy plane
+    static frustum view_frustum(const cull_view& view) {
+        const auto extent = 1.0f / view.zoom;
+        return { {
+            { 1.0f, 0.0f, 0.0f, extent - view.offset[0] },
+            { -1.0f, 0.0f, 0.0f, extent + view.offset[0] },
+            { 0.0f, 1.0f, 0.0f, extent - view.offset[1] },
+            { 0.0f, -1.0f, 0.0f, extent + view.offset[1] },
+            { 0.0f, 0.0f, 1.0f, 1.0f },
+            { 0.0f, 0.0f, -1.0f, 1.0f }
+        } };
+    }
+
+    // Camera panning around the object field in a circle, one full turn every 600 frames
+    static cull_view orbiting_view(std::uint64_t frame) {
+        const auto angle = static_cast<float>(frame % 600) / 600.0f * 6.2831853f;
+        return { { 2.0f * std::cos(angle), 2.0f * std::sin(angle) }, 1.0f, 0.0f };
+    }
+
+    // Field of copies of the model, frustum culled either on the cpu with one draw per visible
+    // submesh, or by a compute pass compacting the visible draws into an indirect buffer that the
+    // render pass consumes with a single vkCmdDrawIndexedIndirectCount.
+    //
+    // Both paths render through the same pipeline, the object index is the draw's firstInstance
+    // and objects.vert fetches its transform from the object buffer with it.
+    class object_culler {
+        constexpr static std::uint32_t workgroup_size = 64;
+
+        struct cull_constants {
+            cull_view view;
+            std::uint32_t object_count;
+            std::uint32_t submesh_count;
+        };
+
+        struct submesh_draw {
+            std::uint32_t index_count;
+            std::uint32_t first_index;
+            std::int32_t vertex_offset;
+            std::uint32_t unused;
+        };
+
+        VkDevice device{};
+        memory_allocator* allocator{};
+        const mesh* geometry{};
+        // Kept to rebuild the pipelines when their shaders are reloaded
+        std::filesystem::path shader_directory{};
+        VkRenderPass render_pass{};
+        PFN_vkCmdDrawIndexedIndirectCount draw_indirect_count{};
+
+        std::vector<scene_object> objects{};
+        // The same bounding circles for the cpu path, culled all at once by cull_cpu()
+        scene_store scene{};
+        std::uint32_t active_count{};
+        std::uint32_t max_draws{};
+        buffer_allocation object_buffer{};
+        buffer_allocation submesh_buffer{};
+        buffer_allocation draw_buffer{};
+        buffer_allocation count_buffer{};
+
+        unique_descriptor_set_layout set_layout{};
+        unique_descriptor_pool descriptor_pool{};
+        VkDescriptorSet descriptor_set{};
+        // Shared by the cull dispatch and the draws, both push the view
+        unique_pipeline_layout layout{};
+        unique_pipeline cull_pipeline{};
+        unique_pipeline draw_pipeline{};
+        std::future<VkPipeline> pending_cull{};
+        std::future<VkPipeline> pending_draw{};
+
+        void create_buffers(upload_manager&);
+        void create_descriptors();
+        void create_pipeline_layout();
+        void bind_draw_state(const VkCommandBuffer&, const cull_view&) const;
+
+    public:
+        object_culler() = default;
+
+        // Scatters count copies of model over a field larger than the screen and queues them through uploads.
+        // Without draw_indirect_count the gpu path draws every slot, culled ones are left with no instances
+        void create(const VkDevice&, memory_allocator&, upload_manager&, thread_pool&, shader_module_cache&, pipeline_compiler&,
+                    const std::filesystem::path& shader_directory, const VkRenderPass&, const mesh& model,
+                    std::uint32_t count, PFN_vkCmdDrawIndexedIndirectCount draw_indirect_count);
+        void wait_pipelines();
+        void destroy();
+
+        // Sources of the cull and draw pipelines' stages, compile_pipelines() reads their compiled binaries
+        std::vector<std::filesystem::path> shader_sources() const;
+        // Starts compiling both pipelines, the current ones stay in use until wait_pipelines() or swap_pipelines()
+        void compile_pipelines(shader_module_cache&, pipeline_compiler&);
+        bool reload_ready() const;
+        // Replaces the pipelines with the compiled ones, the old ones are destroyed once the timeline reaches retire_value
+        void swap_pipelines(deletion_queue&, std::uint64_t retire_value);
+
+        bool enabled() const;
+        std::uint32_t size() const;
+        std::uint32_t capacity() const;
+        // Draws only the first count objects, at most capacity()
+        void resize(std::uint32_t count);
+
+        // Indirect commands and their count, written by record_culling()
+        VkBuffer draw_commands() const;
+        VkBuffer draw_count() const;
+
+        // Outside a render pass, the caller orders it after the previous draws reading its output and before the next
+        void record_culling(const VkCommandBuffer&, const cull_view&) const;
+        // Inside the render pass, viewport and scissor are dynamic and set by the caller
+        void record_indirect_draw(const VkCommandBuffer&, const cull_view&) const;
+        // Culls the active objects on the cpu over the worker threads, returns how many are visible
+        std::uint32_t cull_cpu(const cull_view&);
+        // Draws the objects in [first, first + count) the last cull_cpu() kept, returns how many were drawn
+        std::uint32_t record_cpu_draws(const VkCommandBuffer&, const cull_view&, std::uint32_t first, std::uint32_t count) const;
+    };
+} // namespace vk_playground
+
+#endif //VKPLAYGROUND_OBJECT_CULLER_HPP
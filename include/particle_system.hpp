@@ -0,0 +1,97 @@
+#ifndef VKPLAYGROUND_PARTICLE_SYSTEM_HPP
+#define VKPLAYGROUND_PARTICLE_SYSTEM_HPP
+
+#include <cstdint>
+#include <filesystem>
+#include <future>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include <deletion_queue.hpp>
+#include <memory_allocator.hpp>
+#include <pipeline_compiler.hpp>
+#include <shader.hpp>
+#include <upload_manager.hpp>
+#include <vk_handle.hpp>
+
+namespace vk_playground {
+    struct particle {
+        float position[4];
+        float velocity[4];
+    };
+
+    // Particles integrated by a compute shader each frame and drawn as points straight from the
+    // buffer it wrote. Simulation steps are fixed so prerecorded command buffers and benchmark
+    // runs see the same work every frame.
+    //
+    // On the graphics queue one buffer is integrated in place. On an async compute queue two
+    // buffers ping-pong: step s reads buffer s % 2 and writes the other one, so drawing step s - 1
+    // overlaps with computing step s.
+    class particle_system {
+        constexpr static std::uint32_t workgroup_size = 256;
+        constexpr static float time_step = 1.0f / 60.0f;
+
+        struct simulation_constants {
+            float dt;
+            std::uint32_t count;
+        };
+
+        VkDevice device{};
+        memory_allocator* allocator{};
+        // Kept to rebuild the pipelines when their shaders are reloaded
+        std::filesystem::path shader_directory{};
+        VkRenderPass render_pass{};
+        std::uint32_t particle_count{};
+        bool async{};
+        std::vector<buffer_allocation> particles{};
+
+        unique_descriptor_set_layout set_layout{};
+        unique_descriptor_pool descriptor_pool{};
+        // Per buffer read by a step
+        std::vector<VkDescriptorSet> descriptor_sets{};
+        unique_pipeline_layout simulate_layout{};
+        unique_pipeline_layout draw_layout{};
+        unique_pipeline simulate_pipeline{};
+        unique_pipeline draw_pipeline{};
+        std::future<VkPipeline> pending_simulate{};
+        std::future<VkPipeline> pending_draw{};
+
+        void create_descriptors();
+        void create_pipeline_layouts();
+
+    public:
+        particle_system() = default;
+
+        // Queues the initial state through uploads and starts compiling both pipelines. With async the
+        // simulation is recorded for a compute only queue. More than one family in queue_families makes
+        // the buffers concurrent, the uploads' ownership barriers then only act as memory barriers
+        void create(const VkDevice&, memory_allocator&, upload_manager&, shader_module_cache&, pipeline_compiler&,
+                    const std::filesystem::path& shader_directory, const VkRenderPass&, std::uint32_t count,
+                    bool async, std::vector<std::uint32_t> queue_families);
+        void wait_pipelines();
+        void destroy();
+
+        // Sources of both pipelines' stages, compile_pipelines() reads their compiled binaries
+        std::vector<std::filesystem::path> shader_sources() const;
+        // Starts compiling both pipelines, the current ones stay in use until wait_pipelines() or swap_pipelines()
+        void compile_pipelines(shader_module_cache&, pipeline_compiler&);
+        bool reload_ready() const;
+        // Replaces the pipelines with the compiled ones, the old ones are destroyed once the timeline reaches retire_value
+        void swap_pipelines(deletion_queue&, std::uint64_t retire_value);
+
+        bool enabled() const;
+        std::uint32_t size() const;
+        // Buffer drawn at step, written by the step before
+        VkBuffer buffer(std::uint64_t step) const;
+
+        // Outside a render pass. On the graphics queue ordering against the draws and the previous
+        // frame is up to the caller's render graph, on the async queue up to its semaphores
+        void record_simulation(const VkCommandBuffer&, std::uint64_t step) const;
+        // Inside the render pass, draws the result of step - 1 (the initial state for step 0).
+        // Viewport and scissor are dynamic and set by the caller
+        void record_draw(const VkCommandBuffer&, std::uint64_t step) const;
+    };
+} // namespace vk_playground
+
+#endif //VKPLAYGROUND_PARTICLE_SYSTEM_HPP
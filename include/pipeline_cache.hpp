@@ -0,0 +1,32 @@
+#ifndef VKPLAYGROUND_PIPELINE_CACHE_HPP
+#define VKPLAYGROUND_PIPELINE_CACHE_HPP
+
+#include <filesystem>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+namespace vk_playground {
+    // VkPipelineCache persisted to disk between runs. The stored blob is only used when its
+    // header matches the vendor, device and pipeline cache UUID of the current physical device.
+    class pipeline_cache {
+        VkDevice device{};
+        VkPipelineCache cache{};
+        std::filesystem::path path{};
+        bool warm = false;
+
+        static bool is_compatible(const std::vector<char>&, const VkPhysicalDeviceProperties&);
+
+    public:
+        pipeline_cache() = default;
+
+        void create(const VkDevice&, const VkPhysicalDeviceProperties&, const std::filesystem::path&);
+        void save() const;
+        void destroy();
+
+        VkPipelineCache handle() const;
+        bool loaded_from_disk() const;
+    };
+} // namespace vk_playground
+
+#endif //VKPLAYGROUND_PIPELINE_CACHE_HPP
@@ -0,0 +1,65 @@
+#ifndef VKPLAYGROUND_PIPELINE_COMPILER_HPP
+#define VKPLAYGROUND_PIPELINE_COMPILER_HPP
+
+#include <atomic>
+#include <future>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include <thread_pool.hpp>
+
+namespace vk_playground {
+    // Self-contained description of a graphics pipeline, everything the create info points to
+    // lives in here so it can be handed to another thread.
+    struct graphics_pipeline_description {
+        std::vector<VkPipelineShaderStageCreateInfo> stages{};
+        std::vector<VkVertexInputBindingDescription> vertex_bindings{};
+        std::vector<VkVertexInputAttributeDescription> vertex_attributes{};
+        std::vector<VkDynamicState> dynamic_states{};
+
+        VkPrimitiveTopology topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+        VkPolygonMode polygon_mode = VK_POLYGON_MODE_FILL;
+        VkCullModeFlags cull_mode = VK_CULL_MODE_NONE;
+        VkFrontFace front_face = VK_FRONT_FACE_CLOCKWISE;
+        VkExtent2D extent{};
+
+        VkPipelineLayout layout{};
+        VkRenderPass render_pass{};
+        std::uint32_t subpass = 0;
+    };
+
+    struct compute_pipeline_description {
+        VkPipelineShaderStageCreateInfo stage{};
+        VkPipelineLayout layout{};
+    };
+
+    // Compiles pipelines on the worker pool into one shared VkPipelineCache,
+    // the cache is internally synchronized so workers don't need any locking.
+    class pipeline_compiler {
+        VkDevice device{};
+        VkPipelineCache cache{};
+        thread_pool* workers{};
+        std::atomic<std::int64_t> compile_ns{ 0 };
+
+        VkPipeline build(const graphics_pipeline_description&);
+        VkPipeline build(const compute_pipeline_description&);
+
+    public:
+        pipeline_compiler() = default;
+
+        void create(const VkDevice&, const VkPipelineCache&, thread_pool&);
+
+        std::future<VkPipeline> compile(graphics_pipeline_description);
+        std::future<VkPipeline> compile(compute_pipeline_description);
+        std::vector<std::future<VkPipeline>> compile(std::vector<graphics_pipeline_description>);
+
+        // Sum of compile time across all workers
+        double compile_ms() const;
+    };
+
+    // True once the compile behind pending has finished, or when there's nothing pending
+    bool pipeline_ready(const std::future<VkPipeline>& pending);
+} // namespace vk_playground
+
+#endif //VKPLAYGROUND_PIPELINE_COMPILER_HPP
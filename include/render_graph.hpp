@@ -0,0 +1,186 @@
+#ifndef VKPLAYGROUND_RENDER_GRAPH_HPP
+#define VKPLAYGROUND_RENDER_GRAPH_HPP
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include <memory_allocator.hpp>
+#include <vk_handle.hpp>
+
+namespace vk_playground {
+    // How a pass touches a resource, barriers are derived from consecutive states
+    struct resource_state {
+        VkPipelineStageFlags stages{};
+        VkAccessFlags access{};
+        VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+    };
+
+    constexpr resource_state state_color_attachment{
+        VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+        VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
+    };
+    constexpr resource_state state_depth_attachment{
+        VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+        VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL
+    };
+    constexpr resource_state state_fragment_sampled{
+        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+    };
+    // Acquired swapchain images, the acquire semaphore is waited on at color attachment output
+    constexpr resource_state state_acquired{ VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, 0, VK_IMAGE_LAYOUT_UNDEFINED };
+    constexpr resource_state state_present{ VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR };
+    constexpr resource_state state_transfer_source{ VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL };
+    constexpr resource_state state_vertex_buffer{ VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT };
+    constexpr resource_state state_indirect_buffer{ VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT };
+    constexpr resource_state state_compute_read{ VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT };
+    constexpr resource_state state_compute_read_write{ VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT };
+
+    struct graph_resource {
+        std::uint32_t index = UINT32_MAX;
+    };
+
+    // Images the graph creates and owns, only alive between their first and last use in a frame
+    struct transient_image_description {
+        VkFormat format{};
+        VkExtent2D extent{};
+        VkImageUsageFlags usage{};
+    };
+
+    struct graph_barrier {
+        // Pass the barrier is recorded before, empty for the transitions into final states after the last pass
+        std::string pass{};
+        std::string resource{};
+        resource_state before{};
+        resource_state after{};
+        // First use of memory a transient used earlier in the frame
+        bool aliasing{};
+    };
+
+    // What compile() decided, for inspection and for checking graphs without recording anything
+    struct compiled_graph_info {
+        std::vector<std::string> passes{};
+        std::vector<std::string> culled_passes{};
+        std::vector<graph_barrier> barriers{};
+        // Transients without aliasing, and the memory actually allocated for them
+        VkDeviceSize transient_bytes{};
+        VkDeviceSize allocated_bytes{};
+        std::uint32_t memory_slots{};
+
+        std::string summary() const;
+    };
+
+    // Frame described as passes declaring the resources they use and how. compile() culls passes
+    // nothing observable depends on, derives the barriers and layout transitions between them and
+    // places transient images with disjoint lifetimes in the same memory. execute() then records
+    // the passes in declaration order, each preceded by one batched vkCmdPipelineBarrier.
+    //
+    // Imported resources are owned elsewhere and always count as used after the frame. Imported
+    // buffers keep their state from one frame to the next, the first use of a frame is ordered after
+    // the last use of the previous one. Imported images start and end in given states.
+    class render_graph {
+    public:
+        using pass_callback = std::function<void(const VkCommandBuffer&)>;
+
+        class pass_builder {
+            render_graph* graph{};
+            std::uint32_t pass{};
+
+        public:
+            pass_builder(render_graph*, std::uint32_t pass);
+
+            pass_builder& use(graph_resource, const resource_state&);
+            // Kept even when nothing reads what it writes (readbacks, queries)
+            pass_builder& side_effects();
+        };
+
+    private:
+        struct resource {
+            std::string name{};
+            bool image{};
+            bool imported{};
+            VkImage image_handle{};
+            VkBuffer buffer_handle{};
+            VkImageAspectFlags aspect{};
+            resource_state initial{};
+            resource_state final{};
+
+            // Transients only
+            transient_image_description description{};
+            unique_image owned_image{};
+            unique_image_view view{};
+            VkMemoryRequirements requirements{};
+            std::uint32_t slot = UINT32_MAX;
+            std::uint32_t first_use = UINT32_MAX;
+            std::uint32_t last_use{};
+        };
+
+        struct resource_use {
+            std::uint32_t resource{};
+            resource_state state{};
+        };
+
+        struct pass {
+            std::string name{};
+            std::vector<resource_use> uses{};
+            pass_callback callback{};
+            bool side_effects{};
+        };
+
+        struct planned_barrier {
+            std::uint32_t resource{};
+            resource_state before{};
+            resource_state after{};
+            bool aliasing{};
+        };
+
+        struct planned_pass {
+            std::uint32_t pass{};
+            std::vector<planned_barrier> barriers{};
+        };
+
+        VkDevice device{};
+        memory_allocator* allocator{};
+        std::vector<resource> resources{};
+        std::vector<pass> passes{};
+
+        std::vector<planned_pass> plan{};
+        std::vector<planned_barrier> final_barriers{};
+        std::vector<allocation> memory_slots{};
+        compiled_graph_info compiled{};
+
+        std::vector<std::uint32_t> cull_passes() const;
+        void allocate_transients();
+        void plan_barriers();
+        void record_barriers(const VkCommandBuffer&, const std::vector<planned_barrier>&) const;
+
+    public:
+        render_graph() = default;
+        ~render_graph();
+
+        render_graph(const render_graph&) = delete;
+        render_graph& operator =(const render_graph&) = delete;
+
+        // The handle is bound later with bind_image(), it may change between executions (swapchain images)
+        graph_resource import_image(std::string name, VkImageAspectFlags, const resource_state& initial, const resource_state& final);
+        graph_resource import_buffer(std::string name, VkBuffer);
+        graph_resource create_image(std::string name, const transient_image_description&);
+        pass_builder add_pass(std::string name, pass_callback);
+
+        // Once, after all passes are added. Transient images and their views exist from then on
+        void compile(const VkDevice&, memory_allocator&);
+        void destroy();
+
+        void bind_image(graph_resource, VkImage);
+        VkImage image(graph_resource) const;
+        VkImageView image_view(graph_resource) const;
+        const compiled_graph_info& info() const;
+
+        void execute(const VkCommandBuffer&) const;
+    };
+} // namespace vk_playground
+
+#endif //VKPLAYGROUND_RENDER_GRAPH_HPP
@@ -0,0 +1,97 @@
+#ifndef VKPLAYGROUND_RENDER_QUEUE_HPP
+#define VKPLAYGROUND_RENDER_QUEUE_HPP
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include <bindless_descriptors.hpp>
+#include <frame_stats.hpp>
+#include <uniform_ring.hpp>
+
+namespace vk_playground {
+    // 64 bit sort key, most significant field first:
+    // pass (4 bits) | pipeline (12 bits) | depth (32 bits) | material (16 bits)
+    //
+    // Depth ranks above the material: draws of one object share its depth and its uniform
+    // descriptor bind, and only the pushed material index changes between them.
+    struct sort_key {
+        constexpr static std::uint32_t pass_bits = 4;
+        constexpr static std::uint32_t pipeline_bits = 12;
+        constexpr static std::uint32_t depth_bits = 32;
+        constexpr static std::uint32_t material_bits = 16;
+
+        constexpr static std::uint32_t material_shift = 0;
+        constexpr static std::uint32_t depth_shift = material_shift + material_bits;
+        constexpr static std::uint32_t pipeline_shift = depth_shift + depth_bits;
+        constexpr static std::uint32_t pass_shift = pipeline_shift + pipeline_bits;
+
+        static std::uint64_t make(std::uint32_t pass, std::uint32_t pipeline, std::uint32_t material, std::uint32_t depth);
+
+        static std::uint32_t pass(std::uint64_t key);
+        static std::uint32_t pipeline(std::uint64_t key);
+        static std::uint32_t material(std::uint64_t key);
+    };
+
+    // What the key's fields refer to while recording
+    struct render_queue_bindings {
+        // Indexed by the key's pipeline field, all created with the bindless pipeline layout
+        std::span<const VkPipeline> pipelines;
+        const bindless_descriptors* bindless;
+        // Bindless buffer slot holding the materials, the key's material field indexes into it
+        std::uint32_t material_buffer;
+        // Set the per draw uniforms are bound at
+        const uniform_ring* uniforms;
+        std::uint32_t uniform_set;
+    };
+
+    // Draws of a frame submitted in key order, so consecutive draws share as much state as
+    // possible and the recording skips binds whose state is already set.
+    //
+    // Keys and the draw each one refers to live in parallel arrays, sort() runs an LSD radix
+    // sort over them that skips the digits every key agrees on: unused key fields cost nothing.
+    class render_queue {
+        constexpr static std::uint32_t digit_bits = 8;
+        constexpr static std::uint32_t digit_count = 64 / digit_bits;
+        constexpr static std::uint32_t bucket_count = 1u << digit_bits;
+
+        // Parallel arrays, order[i] is the draw keys[i] belongs to
+        std::vector<std::uint64_t> keys{};
+        std::vector<std::uint32_t> order{};
+        std::vector<std::uint64_t> key_scratch{};
+        std::vector<std::uint32_t> order_scratch{};
+
+        // Draw parameters by submission index
+        std::vector<std::uint32_t> index_counts{};
+        std::vector<std::uint32_t> first_indices{};
+        std::vector<std::int32_t> vertex_offsets{};
+        std::vector<std::uint32_t> uniform_offsets{};
+
+        // Calls the binder for every state change of the sorted draws [first, last) and for every draw
+        template <typename Binder>
+        bind_counts walk(std::uint32_t first, std::uint32_t last, Binder& binder) const;
+
+    public:
+        render_queue() = default;
+
+        void clear();
+        void reserve(std::size_t draws);
+        std::uint32_t size() const;
+
+        // Indexed draw with the uniform ring's dynamic offset it reads its per draw data from
+        void push(std::uint64_t key, std::uint32_t index_count, std::uint32_t first_index, std::int32_t vertex_offset, std::uint32_t uniform_offset);
+        // Stable, draws with equal keys keep their submission order
+        void sort();
+        std::uint64_t key(std::uint32_t index) const;
+
+        // Records the sorted draws [first, last) into a command buffer with no state bound yet,
+        // vertex and index buffers excepted. Ranges of one queue can be recorded in parallel
+        bind_counts record(const VkCommandBuffer&, const render_queue_bindings&, std::uint32_t first, std::uint32_t last) const;
+        // What record() would bind for the same range, without a command buffer
+        bind_counts count_binds(std::uint32_t first, std::uint32_t last) const;
+    };
+} // namespace vk_playground
+
+#endif //VKPLAYGROUND_RENDER_QUEUE_HPP
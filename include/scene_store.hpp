@@ -0,0 +1,99 @@
+#ifndef VKPLAYGROUND_SCENE_STORE_HPP
+#define VKPLAYGROUND_SCENE_STORE_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include <thread_pool.hpp>
+
+namespace vk_playground {
+    // Six planes with normals pointing inwards, a point p is inside when dot(n, p) + d >= 0
+    struct frustum {
+        float planes[6][4];
+    };
+
+    // Translation and uniform scale, relative to the parent
+    struct scene_transform {
+        float position[3];
+        float scale;
+    };
+
+    enum class cull_kernel {
+        scalar,
+        sse,
+        avx2
+    };
+
+    const char* cull_kernel_name(cull_kernel);
+    // Widest kernel this cpu runs, checked once at runtime
+    cull_kernel best_cull_kernel();
+    bool cull_kernel_supported(cull_kernel);
+
+    // Cpu side scene: transforms, hierarchy and bounding spheres in structure of arrays layout,
+    // culled against a frustum by SIMD kernels walking the arrays 4 or 8 objects at a time.
+    //
+    // Objects are stored level by level, every parent before its children, so the world
+    // transforms of a whole level only depend on the levels before it: both the transform
+    // update and the culling are split over the worker threads without any locking.
+    class scene_store {
+        // Smallest share of the objects worth handing to a worker
+        constexpr static std::uint32_t min_task_objects = 16 * 1024;
+
+        thread_pool* workers{};
+        cull_kernel kernel{};
+
+        // Local transform and parent, set by add() and set_transform()
+        std::vector<float> local_x{};
+        std::vector<float> local_y{};
+        std::vector<float> local_z{};
+        std::vector<float> local_scale{};
+        std::vector<std::uint32_t> parents{};
+        // Bounding sphere around the object's origin, in local units
+        std::vector<float> radius{};
+        // World transform, written by update_transforms()
+        std::vector<float> world_x{};
+        std::vector<float> world_y{};
+        std::vector<float> world_z{};
+        std::vector<float> world_scale{};
+        // Objects [level_offsets[i], level_offsets[i + 1]) are i levels below a root
+        std::vector<std::uint32_t> level_offsets{ 0 };
+        // One bit per object, written by cull() for objects [0, culled_count)
+        std::vector<std::uint32_t> visibility{};
+        std::uint32_t culled_count{};
+
+        template <typename Fn>
+        void parallel_range(std::uint32_t first, std::uint32_t last, std::uint32_t granularity, Fn&& fn);
+
+    public:
+        constexpr static std::uint32_t no_parent = ~0u;
+
+        scene_store() = default;
+
+        void create(thread_pool&, cull_kernel = best_cull_kernel());
+
+        void clear();
+        void reserve(std::uint32_t objects);
+        std::uint32_t size() const;
+        std::uint32_t levels() const;
+
+        // Parents must be added before their children and objects in increasing depth, returns the object's index
+        std::uint32_t add(std::uint32_t parent, const scene_transform& local, float radius);
+        void set_transform(std::uint32_t index, const scene_transform& local);
+        scene_transform world_transform(std::uint32_t index) const;
+
+        // Recomputes every world transform from the local ones, level by level
+        void update_transforms();
+
+        cull_kernel active_kernel() const;
+        // Throws if this cpu can't run the kernel
+        void set_kernel(cull_kernel);
+
+        // Tests the bounding spheres of objects [0, count) against the frustum, returns how many are visible
+        std::uint32_t cull(const frustum&, std::uint32_t count);
+        std::uint32_t cull(const frustum&);
+        // Result of the last cull()
+        bool visible(std::uint32_t index) const;
+    };
+} // namespace vk_playground
+
+#endif //VKPLAYGROUND_SCENE_STORE_HPP
@@ -0,0 +1,105 @@
+#ifndef VKPLAYGROUND_SETTINGS_HPP
+#define VKPLAYGROUND_SETTINGS_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+namespace vk_playground {
+    enum class record_mode {
+        // Record the frame's command buffer every frame from a transient per-frame pool
+        per_frame,
+        // Record one command buffer per swapchain image once at startup and resubmit it
+        prerecorded
+    };
+
+    enum class present_mode {
+        // Each falls back to the closest supported mode, fifo is always available
+        immediate,
+        mailbox,
+        fifo,
+        fifo_relaxed
+    };
+
+    struct settings {
+        // Render into a ring of offscreen images instead of a window + swapchain,
+        // no display or surface extensions are required.
+        bool headless = false;
+        // Number of frames to render before exiting, 0 means until the window is closed.
+        std::uint32_t frame_count = 0;
+
+        // Benchmark mode, render warmup_frames unmeasured frames followed by frame_count
+        // measured ones, then print a summary and write json to json_path (stdout if empty).
+        bool benchmark = false;
+        std::uint32_t warmup_frames = 100;
+        std::string json_path{};
+
+        // Allocator stress benchmark instead of rendering, number of allocation requests, 0 disables it.
+        std::uint32_t allocator_benchmark = 0;
+        // Per object uniform update benchmark instead of rendering, number of objects, 0 disables it.
+        std::uint32_t uniform_benchmark = 0;
+        // Draw key sort benchmark instead of rendering, number of draws, 0 disables it.
+        std::uint32_t sort_benchmark = 0;
+        // Cpu scene update and culling benchmark instead of rendering
+        bool scene_benchmark = false;
+
+        // On-disk pipeline cache, empty disables loading and saving it (cold start every run).
+        std::string pipeline_cache_path = "pipeline_cache.bin";
+
+        // Re-record the frame's command buffer every frame or record one per image up front.
+        record_mode recording = record_mode::per_frame;
+        // Split the frame's draws across this many secondary command buffers recorded in parallel,
+        // 1 records everything inline into the primary. Only used with per frame recording.
+        std::uint32_t record_threads = 1;
+        // Draws issued per frame, each one a copy of the triangle
+        std::uint32_t draw_count = 1;
+        // Sweep recording time over thread counts and draw counts instead of rendering
+        bool record_benchmark = false;
+
+        // Requested swapchain present mode, ignored when headless.
+        present_mode presentation = present_mode::immediate;
+        // Frames the cpu may record ahead of the gpu.
+        std::uint32_t frames_in_flight = 2;
+        // Sleep before sampling input so the frame is recorded just before the gpu needs it.
+        bool frame_pacing = false;
+
+        // Binary mesh to draw (see mesh_converter), empty draws a single triangle.
+        std::string mesh_path{};
+
+        // Particles simulated in compute and drawn as points every frame, 0 disables the particle workload.
+        std::uint32_t particle_count = 0;
+        // Simulate the particles on a separate compute queue overlapping the frame's rendering,
+        // falls back to the graphics queue when the device has no second queue. Needs per frame recording.
+        bool async_compute = false;
+
+        // Copies of the model scattered over a field larger than the screen and frustum culled every frame,
+        // 0 disables them. Needs per frame recording, the view moves every frame.
+        std::uint32_t object_count = 0;
+        // Cull in a compute pass and draw with one indirect call instead of culling and drawing on the cpu
+        bool gpu_culling = false;
+        // Compare cpu and gpu culling over several object counts instead of rendering
+        bool cull_benchmark = false;
+
+        // Copies of the model drawn with one instanced draw, their transforms rewritten every frame.
+        // 0 disables them. Needs per frame recording, each frame slot has its own instance stream.
+        std::uint32_t instance_count = 0;
+
+        // Print the compiled frame graph (passes, barriers, transient memory) whenever it's rebuilt,
+        // and once a depth and post processing graph that exercises transient aliasing.
+        bool dump_graph = false;
+
+        // GLSL sources, compiled SPIR-V is read from the compiled/ directory inside it.
+        std::string shader_directory = "../resources/shaders";
+        // Watch shader_directory, recompile changed sources with glslc and swap the pipelines using them.
+        bool hot_reload = false;
+        std::string glslc = "glslc";
+
+        // Worker threads for pipeline compilation and other background jobs.
+        std::uint32_t worker_threads = std::max(1u, std::thread::hardware_concurrency());
+
+        static settings from_args(int, char**);
+    };
+} // namespace vk_playground
+
+#endif //VKPLAYGROUND_SETTINGS_HPP
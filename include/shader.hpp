@@ -1,22 +1,95 @@
 #ifndef VKPLAYGROUND_SHADER_HPP
 #define VKPLAYGROUND_SHADER_HPP
 
+#include <cstdint>
 #include <filesystem>
-#include <fstream>
+#include <map>
+#include <mutex>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
 #include <vulkan/vulkan.h>
 
+#include <mapped_file.hpp>
+#include <vk_handle.hpp>
+
 namespace vk_playground {
-    class shader {
-        std::array<VkShaderModule, 2> shader_module{};
-        std::array<VkPipelineShaderStageCreateInfo, 2> shader_stages{};
+    // SPIR-V module mapped from disk. Mappings start on a page boundary, so the words are
+    // handed to vkCreateShaderModule in place without a copy or an alignment fixup.
+    class spirv_file {
+        mapped_file file{};
+
+    public:
+        explicit spirv_file(const std::filesystem::path&);
+
+        std::span<const std::uint32_t> code() const;
+    };
+
+    // One VkShaderModule per distinct SPIR-V blob, keyed by a hash of its contents and its size.
+    // Pipelines sharing a stage, or two paths holding the same binary, get the same module. A hit
+    // is confirmed against a copy of the words, colliding blobs get modules of their own. A module
+    // stays cached while some binary path last loaded it, reloads hand back the ones they replaced.
+    // Safe to call from several threads.
+    class shader_module_cache {
+        struct key {
+            std::uint64_t hash;
+            std::size_t words;
+
+            bool operator ==(const key&) const = default;
+        };
+
+        struct key_hash {
+            std::size_t operator ()(const key& value) const {
+                return value.hash ^ (value.words * 0x9e3779b97f4a7c15ull);
+            }
+        };
+
+        struct entry {
+            std::vector<std::uint32_t> code;
+            unique_shader_module module;
+        };
 
-        std::string vertex_spv{}, fragment_spv{};
+        VkDevice device{};
+        // Every blob with the key's hash and size
+        std::unordered_map<key, std::vector<entry>, key_hash> modules{};
+        // The module each binary was last loaded into
+        std::map<std::filesystem::path, VkShaderModule> loaded{};
+        std::uint32_t hit_count{};
+        std::uint32_t miss_count{};
+        mutable std::mutex lock{};
+
+        // With the lock held
+        VkShaderModule get(std::span<const std::uint32_t> code);
+
+    public:
+        shader_module_cache() = default;
+
+        void create(const VkDevice&);
+        void destroy();
+
+        // Maps the binary at path, its module is shared with every other binary of the same contents
+        VkShaderModule load(const std::filesystem::path&);
+        // Removes the modules no path loads anymore, the caller destroys them once the pipelines
+        // created from them have retired
+        std::vector<unique_shader_module> take_superseded();
+
+        std::uint32_t size() const;
+        std::uint32_t hits() const;
+        std::uint32_t misses() const;
+    };
+
+    // Any set of stages, each with its module from the cache
+    class shader {
+        std::vector<VkPipelineShaderStageCreateInfo> shader_stages{};
 
     public:
-        shader(const std::filesystem::path&, const std::filesystem::path&);
+        shader() = default;
+
+        shader& add_stage(VkShaderStageFlagBits, const std::filesystem::path&, shader_module_cache&, const char* entry = "main");
 
-        void create_module(const VkDevice&);
-        std::array<VkShaderModule, 2>& get_modules();
+        const std::vector<VkPipelineShaderStageCreateInfo>& stages() const;
+        VkShaderModule module(VkShaderStageFlagBits) const;
     };
 } // namespace vk_playground
 
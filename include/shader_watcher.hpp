@@ -0,0 +1,50 @@
+#ifndef VKPLAYGROUND_SHADER_WATCHER_HPP
+#define VKPLAYGROUND_SHADER_WATCHER_HPP
+
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include <frame_stats.hpp>
+
+namespace vk_playground {
+    // Reports files written in one directory (not its subdirectories). Uses inotify on Linux,
+    // elsewhere it compares modification times, at most a few times a second.
+    class shader_watcher {
+        std::filesystem::path directory{};
+#if defined(__linux__)
+        int inotify_fd = -1;
+#else
+        std::unordered_map<std::string, std::filesystem::file_time_type> write_times{};
+        bench_clock::time_point last_scan{};
+#endif
+
+    public:
+        shader_watcher() = default;
+        ~shader_watcher();
+
+        shader_watcher(const shader_watcher&) = delete;
+        shader_watcher& operator =(const shader_watcher&) = delete;
+
+        void create(const std::filesystem::path& directory);
+        void destroy();
+
+        // Files changed since the last call, never blocks
+        std::vector<std::filesystem::path> poll();
+    };
+
+    // GLSL source path -> stage, by extension the way glslc infers it. Throws on anything else
+    VkShaderStageFlagBits shader_stage_from_path(const std::filesystem::path&);
+    bool is_shader_source(const std::filesystem::path&);
+
+    // <directory>/triangle.vert -> <directory>/compiled/triangle_vert.spv, the layout compile_shaders uses
+    std::filesystem::path compiled_shader_path(const std::filesystem::path& source);
+
+    // Runs glslc on source, blocking until it exits. Diagnostics go to the console, returns false on failure
+    bool compile_glsl(const std::filesystem::path& source, const std::filesystem::path& output, const std::string& glslc);
+} // namespace vk_playground
+
+#endif //VKPLAYGROUND_SHADER_WATCHER_HPP
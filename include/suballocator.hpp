@@ -0,0 +1,121 @@
+#ifndef VKPLAYGROUND_SUBALLOCATOR_HPP
+#define VKPLAYGROUND_SUBALLOCATOR_HPP
+
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <vector>
+
+namespace vk_playground {
+    // Offset-only allocators, they never touch the memory they hand out so the same
+    // code manages VkDeviceMemory blocks, buffer ranges or anything else addressable.
+
+    struct suballocation {
+        std::uint64_t offset{};
+        std::uint32_t handle{};
+    };
+
+    // Two-level segregated fit, O(1) allocate and free for long-lived resources.
+    class tlsf_allocator {
+        constexpr static std::uint32_t sl_index_log2 = 5;
+        constexpr static std::uint32_t sl_count = 1u << sl_index_log2;
+        constexpr static std::uint32_t fl_count = 64 - sl_index_log2 + 1;
+        constexpr static std::uint32_t null_block = UINT32_MAX;
+
+        struct block {
+            std::uint64_t offset{};
+            std::uint64_t size{};
+            std::uint32_t prev_physical = null_block;
+            std::uint32_t next_physical = null_block;
+            std::uint32_t prev_free = null_block;
+            std::uint32_t next_free = null_block;
+            bool free = false;
+        };
+
+        std::vector<block> blocks{};
+        std::vector<std::uint32_t> unused_blocks{};
+
+        std::uint64_t fl_bitmap{};
+        std::uint32_t sl_bitmap[fl_count]{};
+        std::uint32_t free_heads[fl_count][sl_count]{};
+
+        std::uint64_t capacity{};
+        std::uint64_t used{};
+        std::uint32_t allocation_count{};
+        std::uint32_t free_count{};
+
+        static void mapping_insert(std::uint64_t, std::uint32_t&, std::uint32_t&);
+        static void mapping_search(std::uint64_t, std::uint32_t&, std::uint32_t&);
+
+        std::uint32_t new_block();
+        void insert_free(std::uint32_t);
+        void remove_free(std::uint32_t);
+        std::uint32_t split(std::uint32_t, std::uint64_t);
+        void merge_into_prev(std::uint32_t);
+        std::uint32_t find_free(std::uint64_t);
+
+    public:
+        tlsf_allocator() = default;
+        explicit tlsf_allocator(std::uint64_t);
+
+        std::optional<suballocation> allocate(std::uint64_t size, std::uint64_t alignment);
+        void free(std::uint32_t handle);
+
+        std::uint64_t size() const;
+        std::uint64_t used_bytes() const;
+        std::uint32_t allocations() const;
+        std::uint32_t free_regions() const;
+        std::uint64_t largest_free_region() const;
+        bool empty() const;
+    };
+
+    // Bump pointer over a fixed range, freed all at once, for data that lives a single frame.
+    class linear_allocator {
+        std::uint64_t base{};
+        std::uint64_t capacity{};
+        std::uint64_t head{};
+
+    public:
+        linear_allocator() = default;
+        linear_allocator(std::uint64_t base, std::uint64_t size);
+
+        std::optional<std::uint64_t> allocate(std::uint64_t size, std::uint64_t alignment);
+        void reset();
+
+        std::uint64_t size() const;
+        std::uint64_t used_bytes() const;
+    };
+
+    // Circular FIFO over a fixed range for data the gpu consumes in submission order (staging).
+    // Allocations since the last mark() are released together once release() is given a
+    // completed value at or past the one they were marked with.
+    class ring_allocator {
+        struct marked_range {
+            std::uint64_t bytes{};
+            std::uint64_t value{};
+        };
+
+        std::uint64_t capacity{};
+        std::uint64_t head{};
+        std::uint64_t used{};
+        std::uint64_t unmarked{};
+        std::deque<marked_range> in_flight{};
+
+    public:
+        ring_allocator() = default;
+        explicit ring_allocator(std::uint64_t size);
+
+        std::optional<std::uint64_t> allocate(std::uint64_t size, std::uint64_t alignment);
+        void mark(std::uint64_t value);
+        void release(std::uint64_t completed_value);
+
+        std::uint64_t size() const;
+        std::uint64_t used_bytes() const;
+    };
+
+    static std::uint64_t align_up(std::uint64_t value, std::uint64_t alignment) {
+        return alignment <= 1 ? value : (value + alignment - 1) / alignment * alignment;
+    }
+} // namespace vk_playground
+
+#endif //VKPLAYGROUND_SUBALLOCATOR_HPP
@@ -0,0 +1,71 @@
+#ifndef VKPLAYGROUND_THREAD_POOL_HPP
+#define VKPLAYGROUND_THREAD_POOL_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace vk_playground {
+    class thread_pool {
+        std::vector<std::thread> workers{};
+        std::deque<std::function<void()>> tasks{};
+        std::mutex mutex{};
+        std::condition_variable condition{};
+        bool stopping = false;
+
+        void worker_loop();
+        void enqueue(std::function<void()>);
+
+    public:
+        thread_pool() = default;
+        ~thread_pool();
+
+        thread_pool(const thread_pool&) = delete;
+        thread_pool& operator =(const thread_pool&) = delete;
+
+        void start(std::size_t thread_count);
+        void stop();
+        std::size_t size() const;
+
+        template <typename Fn>
+        auto submit(Fn&& fn) -> std::future<std::invoke_result_t<Fn>> {
+            using result_type = std::invoke_result_t<Fn>;
+
+            // std::function needs a copyable target, packaged_task is move only
+            auto task = std::make_shared<std::packaged_task<result_type()>>(std::forward<Fn>(fn));
+            auto future = task->get_future();
+
+            enqueue([task]() { (*task)(); });
+
+            return future;
+        }
+
+        // Runs fn(0) .. fn(count - 1) on the pool and the calling thread, returns once all are done
+        template <typename Fn>
+        void parallel_for(std::uint32_t count, Fn&& fn) {
+            if (count == 0) {
+                return;
+            }
+
+            std::vector<std::future<void>> pending{};
+            pending.reserve(count - 1);
+            for (std::uint32_t i = 0; i + 1 < count; ++i) {
+                pending.emplace_back(submit([&fn, i]() { fn(i); }));
+            }
+
+            fn(count - 1);
+
+            for (auto& future : pending) {
+                future.get();
+            }
+        }
+    };
+} // namespace vk_playground
+
+#endif //VKPLAYGROUND_THREAD_POOL_HPP
@@ -0,0 +1,50 @@
+#ifndef VKPLAYGROUND_TIMELINE_SEMAPHORE_HPP
+#define VKPLAYGROUND_TIMELINE_SEMAPHORE_HPP
+
+#include <cstdint>
+
+#include <vulkan/vulkan.h>
+
+namespace vk_playground {
+    // A timeline value a submission waits for before the given stages
+    struct semaphore_wait {
+        VkSemaphore semaphore{};
+        std::uint64_t value{};
+        VkPipelineStageFlags stages{};
+    };
+
+    // One monotonically increasing counter per queue. Every submission signals the next value,
+    // anything that has to know whether the gpu is done with a submission (frame slots, deferred
+    // deletion, readbacks) remembers its value and compares or waits against this single semaphore.
+    class timeline_semaphore {
+        VkDevice device{};
+        VkSemaphore semaphore{};
+        std::uint64_t submitted = 0;
+        std::uint64_t completed_value = 0;
+
+        PFN_vkWaitSemaphores wait_semaphores{};
+        PFN_vkGetSemaphoreCounterValue get_counter_value{};
+
+    public:
+        timeline_semaphore() = default;
+
+        // core picks the Vulkan 1.2 entry points, otherwise the VK_KHR_timeline_semaphore ones
+        void create(const VkDevice&, bool core);
+        void destroy();
+
+        VkSemaphore handle() const;
+
+        // Value for the next submission to signal, it becomes the last submitted value
+        std::uint64_t next();
+        std::uint64_t last_submitted() const;
+
+        // Queries the value the gpu has reached
+        std::uint64_t poll();
+        // Value seen by the last poll or wait, no api call
+        std::uint64_t completed() const;
+        // Blocks until the gpu reaches value, returns right away when it's already known to have
+        void wait(std::uint64_t value);
+    };
+} // namespace vk_playground
+
+#endif //VKPLAYGROUND_TIMELINE_SEMAPHORE_HPP
@@ -0,0 +1,73 @@
+#ifndef VKPLAYGROUND_UNIFORM_RING_HPP
+#define VKPLAYGROUND_UNIFORM_RING_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+#include <vulkan/vulkan.h>
+
+#include <memory_allocator.hpp>
+#include <vk_handle.hpp>
+
+namespace vk_playground {
+    struct uniform_allocation {
+        void* data;
+        // Dynamic offset to bind the ring's descriptor with
+        std::uint32_t offset;
+    };
+
+    // Per draw constants (transforms, material parameters) bump allocated from a persistently
+    // mapped buffer with one region per frame in flight. A region is recycled as a whole once
+    // the frame slot's previous submission retired, nothing is freed one by one. Every
+    // allocation is read through the same UNIFORM_BUFFER_DYNAMIC descriptor, a draw only
+    // passes its dynamic offset to vkCmdBindDescriptorSets.
+    class uniform_ring {
+        VkDevice device{};
+        memory_allocator* allocator{};
+
+        buffer_allocation ring{};
+        std::uint32_t frame_count{};
+        VkDeviceSize alignment{};
+        VkDeviceSize region_size{};
+        // Size of the descriptor's window, the largest single allocation
+        VkDeviceSize range{};
+        VkDeviceSize region_start{};
+        // Relative to region_start, shared by the recording threads
+        std::atomic<VkDeviceSize> head{};
+
+        unique_descriptor_set_layout set_layout{};
+        unique_descriptor_pool descriptor_pool{};
+        VkDescriptorSet descriptor_set{};
+
+    public:
+        uniform_ring() = default;
+
+        // Regions hold at least bytes_per_frame, allocations are at most max_allocation bytes each.
+        // Offsets are aligned to minUniformBufferOffsetAlignment
+        void create(const VkDevice&, memory_allocator&, const VkPhysicalDeviceLimits&, std::uint32_t frame_count,
+                    VkDeviceSize bytes_per_frame, VkDeviceSize max_allocation);
+        void destroy();
+
+        // Binding 0, visible to the vertex and fragment stages
+        VkDescriptorSetLayout descriptor_set_layout() const;
+        VkDeviceSize capacity() const;
+        VkDeviceSize used() const;
+
+        // Starts allocating from the frame slot's region again, its previous submission must have retired
+        void begin_frame(std::uint32_t frame);
+        // Thread safe, throws once the region is full
+        uniform_allocation allocate(VkDeviceSize size);
+
+        template <typename T>
+        std::uint32_t push(const T& value) {
+            const auto memory = allocate(sizeof(T));
+            std::memcpy(memory.data, &value, sizeof(T));
+            return memory.offset;
+        }
+
+        void bind(const VkCommandBuffer&, VkPipelineBindPoint, VkPipelineLayout, std::uint32_t set, std::uint32_t offset) const;
+    };
+} // namespace vk_playground
+
+#endif //VKPLAYGROUND_UNIFORM_RING_HPP
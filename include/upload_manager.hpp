@@ -0,0 +1,104 @@
+#ifndef VKPLAYGROUND_UPLOAD_MANAGER_HPP
+#define VKPLAYGROUND_UPLOAD_MANAGER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include <memory_allocator.hpp>
+#include <suballocator.hpp>
+#include <timeline_semaphore.hpp>
+#include <vk_handle.hpp>
+
+namespace vk_playground {
+    struct upload_statistics {
+        std::uint64_t bytes{};
+        std::uint64_t copies{};
+        std::uint64_t batches{};
+        // Host time spent copying into staging, for mapped files this includes reading them
+        double staging_ms{};
+        bool dedicated_queue{};
+    };
+
+    // Streams data into device local buffers through a persistently mapped staging ring.
+    // Pending uploads are batched once per frame by flush(), at most half the ring per batch,
+    // so a large upload is spread over several frames instead of stalling one.
+    //
+    // With a dedicated transfer family the batch is submitted on the transfer queue, which
+    // signals its own timeline and releases the written ranges to the graphics family, the
+    // matching acquire barriers go into the graphics command buffer. Without one, the copies
+    // are recorded straight into the graphics command buffer.
+    class upload_manager {
+        constexpr static VkDeviceSize min_chunk = 64 * 1024;
+        constexpr static VkDeviceSize copy_alignment = 16;
+
+        struct pending_upload {
+            VkBuffer buffer{};
+            VkDeviceSize offset{};
+            std::span<const std::byte> data{};
+            // Keeps data alive until it has been copied to staging
+            std::shared_ptr<const void> owner{};
+            VkDeviceSize uploaded{};
+        };
+
+        struct transfer_batch {
+            unique_command_pool pool{};
+            VkCommandBuffer command_buffer{};
+            std::uint64_t value{};
+        };
+
+        VkDevice device{};
+        memory_allocator* allocator{};
+        std::uint32_t graphics_family{};
+        std::uint32_t transfer_family{};
+        VkQueue transfer_queue{};
+
+        buffer_allocation staging{};
+        ring_allocator ring{};
+        timeline_semaphore transfer_timeline{};
+        std::vector<transfer_batch> batches{};
+        std::deque<pending_upload> pending{};
+        upload_statistics stats{};
+
+        transfer_batch& next_batch();
+
+    public:
+        constexpr static VkDeviceSize default_staging_size = 32ull * 1024 * 1024;
+        // Consumers of uploaded data, what the graphics side waits for and makes visible to.
+        // Compute may also write over it in place (simulation state), that needs the write access too
+        constexpr static VkPipelineStageFlags consumer_stages =
+            VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+        constexpr static VkAccessFlags consumer_access =
+            VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+        upload_manager() = default;
+
+        // transfer_family == graphics_family falls back to recording copies on the graphics queue
+        void create(const VkDevice&, memory_allocator&, std::uint32_t graphics_family, std::uint32_t transfer_family,
+                    const VkQueue& transfer_queue, bool core_timeline, VkDeviceSize staging_size = default_staging_size);
+        void destroy();
+
+        bool dedicated() const;
+        bool idle() const;
+        const upload_statistics& statistics() const;
+        // Semaphore the graphics submission waits on for the value flush() returns
+        VkSemaphore semaphore() const;
+
+        // Copies data aside, it may be freed once this returns
+        void upload(VkBuffer, VkDeviceSize offset, std::span<const std::byte> data);
+        // Uses data in place, owner keeps it alive until it has gone through staging
+        void upload(VkBuffer, VkDeviceSize offset, std::span<const std::byte> data, std::shared_ptr<const void> owner);
+
+        // Moves pending data through staging and makes it visible to graphics_command_buffer.
+        // graphics_value is the graphics timeline value that command buffer signals, graphics_completed the
+        // last one known to be done. Returns the transfer timeline value to wait on, 0 when there's none.
+        std::uint64_t flush(const VkCommandBuffer& graphics_command_buffer, std::uint64_t graphics_value, std::uint64_t graphics_completed);
+    };
+} // namespace vk_playground
+
+#endif //VKPLAYGROUND_UPLOAD_MANAGER_HPP
@@ -0,0 +1,142 @@
+#ifndef VKPLAYGROUND_VK_HANDLE_HPP
+#define VKPLAYGROUND_VK_HANDLE_HPP
+
+#include <utility>
+
+#include <vulkan/vulkan.h>
+
+namespace vk_playground {
+    // Move-only owner of a Vulkan handle created from a parent object (device or instance),
+    // destroys it with destroy_fn(parent, handle, nullptr) when reset or going out of scope.
+    // Converts to the raw handle so it can be passed straight to Vulkan calls.
+    template <typename Parent, typename T, auto destroy_fn>
+    class vk_handle {
+        Parent parent{};
+        T handle{};
+
+    public:
+        vk_handle() = default;
+        vk_handle(Parent parent, T handle)
+            : parent(parent), handle(handle) {}
+
+        ~vk_handle() {
+            reset();
+        }
+
+        vk_handle(const vk_handle&) = delete;
+        vk_handle& operator =(const vk_handle&) = delete;
+
+        vk_handle(vk_handle&& other) noexcept
+            : parent(other.parent), handle(std::exchange(other.handle, T{})) {}
+
+        vk_handle& operator =(vk_handle&& other) noexcept {
+            if (this != &other) {
+                reset();
+                parent = other.parent;
+                handle = std::exchange(other.handle, T{});
+            }
+            return *this;
+        }
+
+        void reset() {
+            if (handle != T{}) {
+                destroy_fn(parent, handle, nullptr);
+                handle = T{};
+            }
+        }
+
+        // Destroys the current handle and returns storage for vkCreate* to write the new one to
+        T* put(Parent new_parent) {
+            reset();
+            parent = new_parent;
+            return &handle;
+        }
+
+        T get() const {
+            return handle;
+        }
+
+        // For create info structs that take arrays of handles
+        const T* address() const {
+            return &handle;
+        }
+
+        operator T() const {
+            return handle;
+        }
+
+        explicit operator bool() const {
+            return handle != T{};
+        }
+    };
+
+    // Same for the root objects, which have no parent
+    template <typename T, auto destroy_fn>
+    class vk_root_handle {
+        T handle{};
+
+    public:
+        vk_root_handle() = default;
+
+        ~vk_root_handle() {
+            reset();
+        }
+
+        vk_root_handle(const vk_root_handle&) = delete;
+        vk_root_handle& operator =(const vk_root_handle&) = delete;
+
+        vk_root_handle(vk_root_handle&& other) noexcept
+            : handle(std::exchange(other.handle, T{})) {}
+
+        vk_root_handle& operator =(vk_root_handle&& other) noexcept {
+            if (this != &other) {
+                reset();
+                handle = std::exchange(other.handle, T{});
+            }
+            return *this;
+        }
+
+        void reset() {
+            if (handle != T{}) {
+                destroy_fn(handle, nullptr);
+                handle = T{};
+            }
+        }
+
+        T* put() {
+            reset();
+            return &handle;
+        }
+
+        T get() const {
+            return handle;
+        }
+
+        operator T() const {
+            return handle;
+        }
+
+        explicit operator bool() const {
+            return handle != T{};
+        }
+    };
+
+    using unique_instance = vk_root_handle<VkInstance, vkDestroyInstance>;
+    using unique_device = vk_root_handle<VkDevice, vkDestroyDevice>;
+    using unique_surface = vk_handle<VkInstance, VkSurfaceKHR, vkDestroySurfaceKHR>;
+    using unique_swapchain = vk_handle<VkDevice, VkSwapchainKHR, vkDestroySwapchainKHR>;
+    using unique_image = vk_handle<VkDevice, VkImage, vkDestroyImage>;
+    using unique_image_view = vk_handle<VkDevice, VkImageView, vkDestroyImageView>;
+    using unique_framebuffer = vk_handle<VkDevice, VkFramebuffer, vkDestroyFramebuffer>;
+    using unique_render_pass = vk_handle<VkDevice, VkRenderPass, vkDestroyRenderPass>;
+    using unique_pipeline_layout = vk_handle<VkDevice, VkPipelineLayout, vkDestroyPipelineLayout>;
+    using unique_pipeline = vk_handle<VkDevice, VkPipeline, vkDestroyPipeline>;
+    using unique_shader_module = vk_handle<VkDevice, VkShaderModule, vkDestroyShaderModule>;
+    using unique_descriptor_set_layout = vk_handle<VkDevice, VkDescriptorSetLayout, vkDestroyDescriptorSetLayout>;
+    using unique_descriptor_pool = vk_handle<VkDevice, VkDescriptorPool, vkDestroyDescriptorPool>;
+    using unique_command_pool = vk_handle<VkDevice, VkCommandPool, vkDestroyCommandPool>;
+    using unique_semaphore = vk_handle<VkDevice, VkSemaphore, vkDestroySemaphore>;
+    using unique_fence = vk_handle<VkDevice, VkFence, vkDestroyFence>;
+} // namespace vk_playground
+
+#endif //VKPLAYGROUND_VK_HANDLE_HPP
@@ -0,0 +1,18 @@
+#version 460 core
+#extension GL_ARB_separate_shader_objects : enable
+
+layout (location = 0) in vec3 in_position;
+layout (location = 1) in vec3 in_color;
+// Per instance: xy translation, scale, rotation and an RGBA8 tint
+layout (location = 2) in vec4 in_transform;
+layout (location = 3) in vec4 in_tint;
+
+layout (location = 0) out vec3 frag_color;
+
+void main() {
+    float s = sin(in_transform.w);
+    float c = cos(in_transform.w);
+    vec2 rotated = mat2(c, s, -s, c) * in_position.xy;
+    gl_Position = vec4(rotated * in_transform.z + in_transform.xy, 0.0, 1.0);
+    frag_color = in_color * in_tint.rgb;
+}
@@ -0,0 +1,25 @@
+#version 460 core
+#extension GL_ARB_separate_shader_objects : enable
+#extension GL_EXT_nonuniform_qualifier : enable
+
+layout(location = 0) in vec3 frag_color;
+
+layout (location = 0) out vec4 color;
+
+// Bindless set, see bindless_descriptors. Every pipeline declares the whole set and indexes into it
+layout (set = 0, binding = 0) uniform texture2D textures[];
+layout (set = 0, binding = 1) uniform sampler samplers[];
+layout (set = 0, binding = 2) readonly buffer materials {
+    vec4 tint[];
+} buffers[];
+
+layout (push_constant) uniform bindless_indices {
+    uint image;
+    uint sampler_index;
+    uint buffer_index;
+    uint element;
+} indices;
+
+void main() {
+    color = vec4(frag_color, 1.0) * buffers[indices.buffer_index].tint[indices.element];
+}
\ No newline at end of file
@@ -0,0 +1,29 @@
+#version 460 core
+#extension GL_ARB_separate_shader_objects : enable
+
+struct scene_object {
+    vec4 bounds;
+    vec4 transform;
+};
+
+layout (std430, set = 0, binding = 0) readonly buffer object_buffer {
+    scene_object objects[];
+};
+
+layout (push_constant) uniform culling {
+    vec2 view_offset;
+    float zoom;
+};
+
+layout (location = 0) in vec3 in_position;
+layout (location = 1) in vec3 in_color;
+
+layout (location = 0) out vec3 frag_color;
+
+void main() {
+    // The draw's firstInstance is the object index
+    vec4 transform = objects[gl_InstanceIndex].transform;
+    vec2 world = in_position.xy * transform.w + transform.xy;
+    gl_Position = vec4((world - view_offset) * zoom, 0.0, 1.0);
+    frag_color = in_color;
+}
@@ -0,0 +1,13 @@
+#version 460 core
+#extension GL_ARB_separate_shader_objects : enable
+
+layout (location = 0) in vec4 in_position;
+layout (location = 1) in vec4 in_velocity;
+
+layout (location = 0) out vec3 frag_color;
+
+void main() {
+    gl_Position = vec4(in_position.xy, 0.0, 1.0);
+    gl_PointSize = 1.0;
+    frag_color = mix(vec3(0.1, 0.3, 1.0), vec3(1.0, 0.5, 0.1), clamp(length(in_velocity.xy), 0.0, 1.0));
+}
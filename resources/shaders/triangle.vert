@@ -1,19 +1,20 @@
 #version 460 core
 #extension GL_ARB_separate_shader_objects : enable
 
-layout (location = 0) out vec3 frag_color;
+layout (location = 0) in vec3 in_position;
+layout (location = 1) in vec3 in_color;
 
-vec3[] vertices = vec3[3](
-    vec3(0.5, 0.5, 0.0),
-    vec3(-0.5, 0.5, 0.0),
-    vec3(0.0, -0.5, 0.0));
+layout (location = 0) out vec3 frag_color;
 
-vec3[] colors = vec3[3](
-    vec3(1.0, 0.0, 0.0),
-    vec3(0.0, 1.0, 0.0),
-    vec3(0.0, 0.0, 1.0));
+// Per draw, read at the dynamic offset the draw was bound with: xy translation, scale, rotation
+layout (set = 1, binding = 0) uniform draw_uniforms {
+    vec4 transform;
+} draw;
 
 void main() {
-    gl_Position = vec4(vertices[gl_VertexIndex], 1.0);
-    frag_color = colors[gl_VertexIndex];
-}
\ No newline at end of file
+    float s = sin(draw.transform.w);
+    float c = cos(draw.transform.w);
+    vec2 rotated = mat2(c, s, -s, c) * in_position.xy;
+    gl_Position = vec4(rotated * draw.transform.z + draw.transform.xy, in_position.z, 1.0);
+    frag_color = in_color;
+}
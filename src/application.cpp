@@ -1,73 +1,512 @@
 #include "application.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include <benchmarks.hpp>
+
 namespace vk_playground {
+    static const char* present_mode_name(VkPresentModeKHR mode) {
+        switch (mode) {
+            case VK_PRESENT_MODE_IMMEDIATE_KHR: return "immediate";
+            case VK_PRESENT_MODE_MAILBOX_KHR: return "mailbox";
+            case VK_PRESENT_MODE_FIFO_KHR: return "fifo";
+            case VK_PRESENT_MODE_FIFO_RELAXED_KHR: return "fifo_relaxed";
+            default: return "unknown";
+        }
+    }
+
+    // Requested mode first, then the closest alternatives. Fifo is required to be supported
+    static std::vector<VkPresentModeKHR> present_mode_preference(present_mode mode) {
+        switch (mode) {
+            case present_mode::immediate: return { VK_PRESENT_MODE_IMMEDIATE_KHR, VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_FIFO_KHR };
+            case present_mode::mailbox: return { VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_IMMEDIATE_KHR, VK_PRESENT_MODE_FIFO_KHR };
+            case present_mode::fifo_relaxed: return { VK_PRESENT_MODE_FIFO_RELAXED_KHR, VK_PRESENT_MODE_FIFO_KHR };
+            default: return { VK_PRESENT_MODE_FIFO_KHR };
+        }
+    }
+
+    // Same layout as triangle.vert's draw_uniforms: xy translation, scale, rotation
+    struct draw_uniforms {
+        float transform[4];
+    };
+
+    // Copies of the model tile the screen, a single draw covers it whole
+    static draw_uniforms grid_placement(std::uint32_t index, std::uint32_t count) {
+        const auto side = static_cast<std::uint32_t>(std::ceil(std::sqrt(static_cast<double>(std::max(count, 1u)))));
+        const auto cell = 2.0f / side;
+        return { { -1.0f + cell * (index % side + 0.5f), -1.0f + cell * (index / side + 0.5f), 1.0f / side, 0.0f } };
+    }
+
+    application::application(const settings& config)
+        : config(config), max_frames_in_flight(config.frames_in_flight), draw_count(config.draw_count) {}
+
     void application::vk_init() {
+        const auto init_start = bench_clock::now();
+
+        pacer.create(config.frame_pacing);
+
         enable_required_extensions();
         create_instance();
         setup_debug_callback();
-        create_surface();
+        if (!config.headless) {
+            create_surface();
+        }
         init_physical_device();
         init_queues_families();
         create_device();
-        create_swapchain();
-        create_image_views();
-        init_command_pool();
-        init_command_buffer();
+        allocator.create(device, physical_device);
+        uploads.create(device, allocator, get_graphics_queue_index(), transfer_family, transfer_queue_handle, has_core_timeline_semaphore());
+        if (config.async_compute) {
+            compute.create(device, compute_family, compute_queue_handle, compute_queue_handle != queue_handle, has_core_timeline_semaphore(), max_frames_in_flight);
+            async_simulation = compute.async() && config.particle_count > 0;
+            if (!async_simulation) {
+                std::cout << "No separate compute queue, the simulation stays on the graphics queue\n";
+            }
+        }
+        create_geometry();
+        create_uniforms();
+        create_materials();
+        create_pipeline_cache();
+        workers.start(config.worker_threads);
+        compiler.create(device, pipelines.handle(), workers);
+        if (config.headless) {
+            create_offscreen_images();
+        } else {
+            create_swapchain();
+        }
+        // Pipelines only need the shaders and the render pass, get them compiling
+        // before the remaining setup so both overlap
         create_shader_modules();
         create_render_pass();
         create_pipeline();
-        create_framebuffer();
+        init_command_pool();
+        init_command_buffer();
+        init_frame_command_pools();
         create_semaphores();
+        // A mesh file is loaded up front, timed from open to device local memory before the particle,
+        // object and instance uploads queue up behind it
+        if (!config.mesh_path.empty()) {
+            const auto load_start = bench_clock::now();
+            flush_uploads_blocking();
+            mesh_load_ms = mesh_load.map_ms + elapsed_ms(load_start);
+            std::cout << fmt::format("Loaded {} ({} submeshes, {:.2f} MiB) in {:.2f} ms, {:.2f} GB/s\n",
+                                     config.mesh_path, model.submeshes.size(), mesh_load.file_bytes / (1024.0 * 1024.0),
+                                     mesh_load_ms, mesh_load.file_bytes / (mesh_load_ms * 1e6));
+        }
+        if (config.particle_count > 0) {
+            particles.create(device, allocator, uploads, shader_cache, compiler, config.shader_directory, render_pass, config.particle_count,
+                             async_simulation, async_simulation ? std::vector<std::uint32_t>{ static_cast<std::uint32_t>(get_graphics_queue_index()), transfer_family, compute_family }
+                                                                : std::vector<std::uint32_t>{ static_cast<std::uint32_t>(get_graphics_queue_index()) });
+        }
+        if (config.object_count > 0) {
+            objects.create(device, allocator, uploads, workers, shader_cache, compiler, config.shader_directory, render_pass, model, config.object_count, draw_indirect_count);
+            gpu_driven = config.gpu_culling && indirect_draws_supported;
+            if (config.gpu_culling && !indirect_draws_supported) {
+                std::cout << "Device lacks multiDrawIndirect or drawIndirectFirstInstance, culling on the cpu\n";
+            }
+        }
+        if (config.instance_count > 0) {
+            instanced.create(device, allocator, workers, shader_cache, compiler, config.shader_directory, render_pass, model, config.instance_count, max_frames_in_flight);
+        }
+        create_image_views();
+        if (config.dump_graph) {
+            dump_transient_graph();
+        }
+        init_profiler();
+        create_framebuffer();
+        wait_pipelines();
+        // Prerecorded command buffers can't pick up uploads later, the geometry has to be there first
+        if (config.recording == record_mode::prerecorded) {
+            flush_uploads_blocking();
+        }
+        record_command_buffers();
+
+        startup_ms = elapsed_ms(init_start);
     }
 
     void application::glfw_init() {
+        if (config.headless) {
+            return;
+        }
+
         if (!glfwInit()) {
             throw std::runtime_error("Failed glfw init\n");
         }
 
         glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
-        glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
+        glfwWindowHint(GLFW_RESIZABLE, GLFW_TRUE);
 
-        window = glfwCreateWindow(width, height, "Vulkan Playground", nullptr, nullptr);
+        window.reset(glfwCreateWindow(width, height, "Vulkan Playground", nullptr, nullptr));
+        if (!window) {
+            glfwTerminate();
+            throw std::runtime_error("Failed creating window");
+        }
+        glfwSetWindowUserPointer(window.get(), &framebuffer_resized);
+        glfwSetFramebufferSizeCallback(window.get(), framebuffer_resize_callback);
     }
 
     application::~application() {
-        for (const auto& framebuffer : swapchain_framebuffers) {
-            vkDestroyFramebuffer(device, framebuffer, nullptr);
-        }
-        vkDestroyPipeline(device, graphics_pipeline, nullptr);
-        vkDestroyPipelineLayout(device, pipeline_layout, nullptr);
-        vkDestroyRenderPass(device, render_pass, nullptr);
-        for (auto& module : shader_modules) {
-            const auto& [vert, frag] = module.get_modules();
-            vkDestroyShaderModule(device, vert, nullptr);
-            vkDestroyShaderModule(device, frag, nullptr);
-        }
-        for (const auto& image_view : swapchain_image_views) {
-            vkDestroyImageView(device, image_view, nullptr);
-        }
-        vkDestroyCommandPool(device, command_pool, nullptr);
-        vkDestroySwapchainKHR(device, swapchain, nullptr);
-        vkDestroySurfaceKHR(instance, surface, nullptr);
-        vkDestroyDevice(device, nullptr);
-
-        if (enable_validation_layers) {
+        workers.stop();
+        // A hot reload pipeline that finished compiling but was never swapped in
+        if (pending_reload_pipeline.valid()) {
+            try {
+                unique_pipeline(device, pending_reload_pipeline.get());
+            } catch (const std::exception&) {}
+        }
+        if (device) {
+            vkDeviceWaitIdle(device);
+        }
+        deletions.flush();
+
+        // Helpers with their own destroy(), the owning handles are released after this
+        // body in reverse declaration order
+        pipelines.save();
+        pipelines.destroy();
+        uploads.destroy();
+        destroy_mesh(allocator, model);
+        bindless.destroy();
+        if (materials.buffer) {
+            allocator.destroy_buffer(materials);
+        }
+        uniforms.destroy();
+        particles.destroy();
+        if (config.async_compute) {
+            compute.destroy();
+        }
+        compute_profiler.destroy();
+        objects.destroy();
+        instanced.destroy();
+        frame_graph.reset();
+        graphics_timeline.destroy();
+        profiler.destroy();
+        // Views go before the offscreen images they were created from
+        swapchain_framebuffers.clear();
+        swapchain_image_views.clear();
+        for (const auto& image : offscreen_images) {
+            allocator.destroy_image(image);
+        }
+        allocator.destroy();
+
+        if (debug_messenger) {
             auto destroy_debug = reinterpret_cast<PFN_vkDestroyDebugUtilsMessengerEXT>(vkGetInstanceProcAddr(instance, "vkDestroyDebugUtilsMessengerEXT"));
             destroy_debug(instance, debug_messenger, nullptr);
         }
+    }
 
-        vkDestroyInstance(instance, nullptr);
+    void application::run() {
+        if (config.allocator_benchmark > 0) {
+            run_allocator_benchmark(device, allocator, config.allocator_benchmark, config.json_path);
+            return;
+        }
+        if (config.uniform_benchmark > 0) {
+            run_uniform_benchmark(device, allocator, device_properties.limits, get_graphics_queue_index(), config.uniform_benchmark, config.json_path);
+            return;
+        }
+        if (config.sort_benchmark > 0) {
+            run_sort_benchmark(config.sort_benchmark, config.json_path);
+            return;
+        }
+        if (config.scene_benchmark) {
+            run_scene_benchmark(workers, config.json_path);
+            return;
+        }
+
+        if (config.record_benchmark) {
+            run_record_benchmark();
+            return;
+        }
+        if (config.cull_benchmark) {
+            run_cull_benchmark();
+            return;
+        }
+
+        const std::uint32_t warmup_frames = config.benchmark ? config.warmup_frames : 0;
+        const std::uint32_t total_frames = config.frame_count == 0 ? 0 : config.frame_count + warmup_frames;
+
+        if (config.benchmark) {
+            statistics.reserve(config.frame_count);
+        }
+
+        // Frames aborted by a swapchain recreation measure the recreation, they don't count
+        for (std::uint32_t frame = 0; total_frames == 0 || frame < total_frames;) {
+            const auto frame_start = bench_clock::now();
+            current_timing = {};
+
+            current_timing.pacing_ms = pacer.pace();
+            if (!config.headless) {
+                if (glfwWindowShouldClose(window.get())) {
+                    break;
+                }
+                glfwPollEvents();
+            }
+            input_time = bench_clock::now();
+            if (config.hot_reload) {
+                poll_shader_reload();
+            }
+            if (!draw_frame()) {
+                continue;
+            }
+            pacer.update(current_timing.fence_wait_ms + current_timing.acquire_wait_ms);
 
-        glfwDestroyWindow(window);
+            current_timing.cpu_ms = elapsed_ms(frame_start);
+            if (config.benchmark && frame >= warmup_frames) {
+                statistics.add(current_timing);
+            }
+            ++frame;
+        }
+        vkDeviceWaitIdle(device);
 
-        glfwTerminate();
+        if (config.benchmark) {
+            report_benchmark();
+        }
     }
 
-    void application::run() {
-        while (!glfwWindowShouldClose(window)) {
-            draw_frame();
+    void application::run_record_benchmark() {
+        constexpr std::uint32_t warmup_iterations = 10;
+        constexpr std::uint32_t measured_iterations = 50;
+        constexpr std::uint32_t draw_counts[] = { 10'000, max_record_benchmark_draws };
+
+        std::vector<std::uint32_t> thread_counts{};
+        for (std::uint32_t threads = 1; threads < config.record_threads; threads *= 2) {
+            thread_counts.emplace_back(threads);
+        }
+        thread_counts.emplace_back(config.record_threads);
+
+        flush_uploads_blocking();
+
+        // Nothing is in flight, frame slot 0 can be reset and re-recorded freely
+        current_frame = 0;
+
+        std::cout << fmt::format("Recording time in ms per frame ({} iterations, 1 thread records inline):\n", measured_iterations);
+        std::cout << fmt::format("{:>10}", "threads");
+        for (auto draws : draw_counts) {
+            std::cout << fmt::format("{:>14}", fmt::format("{} draws", draws));
+        }
+        std::cout << '\n';
+
+        std::string json_rows{};
+        for (auto threads : thread_counts) {
+            std::cout << fmt::format("{:>10}", threads);
+            for (auto draws : draw_counts) {
+                draw_count = draws;
+
+                double total_ms = 0.0;
+                for (std::uint32_t i = 0; i < warmup_iterations + measured_iterations; ++i) {
+                    const auto record_start = bench_clock::now();
+                    vkResetCommandPool(device, frame_command_pools[current_frame], 0);
+                    uniforms.begin_frame(static_cast<std::uint32_t>(current_frame));
+                    record_command_buffer(frame_command_buffers[current_frame], 0, 0, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT, threads);
+                    if (i >= warmup_iterations) {
+                        total_ms += elapsed_ms(record_start);
+                    }
+                }
+
+                const auto mean_ms = total_ms / measured_iterations;
+                std::cout << fmt::format("{:>14.3f}", mean_ms);
+                json_rows += fmt::format(R"({}{{ "threads": {}, "draws": {}, "record_ms": {:.6f} }})",
+                                         json_rows.empty() ? "" : ", ", threads, draws, mean_ms);
+            }
+            std::cout << '\n';
+        }
+
+        draw_count = config.draw_count;
+        emit_json(config.json_path, fmt::format(R"({{ "device": "{}", "record_scaling": [ {} ] }})", json_escape(device_properties.deviceName), json_rows));
+    }
+
+    void application::run_cull_benchmark() {
+        constexpr std::uint32_t warmup_frames = 20;
+        constexpr std::uint32_t measured_frames = 200;
+        constexpr std::uint32_t object_counts[] = { 10'000, 100'000, 1'000'000 };
+
+        flush_uploads_blocking();
+
+        std::cout << fmt::format("Culled object field, ms per frame ({} frames, {} recording threads for the cpu path{}):\n",
+                                 measured_frames, config.record_threads,
+                                 !indirect_draws_supported ? ", gpu path unsupported" : draw_indirect_count ? "" : ", no draw count, culled slots are drawn empty");
+        std::cout << fmt::format("{:>10}{:>8}{:>12}{:>12}{:>12}\n", "objects", "path", "cpu frame", "recording", "gpu");
+
+        std::string json_rows{};
+        for (auto count : object_counts) {
+            if (count > objects.capacity()) {
+                break;
+            }
+            objects.resize(count);
+
+            for (const bool gpu : { false, true }) {
+                if (gpu && !indirect_draws_supported) {
+                    continue;
+                }
+                gpu_driven = gpu;
+
+                // Timestamps lag behind by the frames in flight, warmup flushes those of the previous run
+                double cpu_ms = 0.0;
+                double record_ms = 0.0;
+                double gpu_ms = 0.0;
+                std::uint32_t gpu_samples = 0;
+                for (std::uint32_t frame = 0; frame < warmup_frames + measured_frames;) {
+                    const auto frame_start = bench_clock::now();
+                    current_timing = {};
+                    if (!config.headless) {
+                        glfwPollEvents();
+                    }
+                    if (!draw_frame() || frame++ < warmup_frames) {
+                        continue;
+                    }
+
+                    cpu_ms += elapsed_ms(frame_start);
+                    record_ms += current_timing.record_ms;
+                    if (!current_timing.gpu_regions.empty()) {
+                        for (const auto& region : current_timing.gpu_regions) {
+                            gpu_ms += region.ms;
+                        }
+                        ++gpu_samples;
+                    }
+                }
+
+                cpu_ms /= measured_frames;
+                record_ms /= measured_frames;
+                gpu_ms = gpu_samples > 0 ? gpu_ms / gpu_samples : 0.0;
+                std::cout << fmt::format("{:>10}{:>8}{:>12.3f}{:>12.3f}{:>12.3f}\n", count, gpu ? "gpu" : "cpu", cpu_ms, record_ms, gpu_ms);
+                json_rows += fmt::format(R"({}{{ "objects": {}, "path": "{}", "cpu_ms": {:.6f}, "record_ms": {:.6f}, "gpu_ms": {:.6f} }})",
+                                         json_rows.empty() ? "" : ", ", count, gpu ? "gpu" : "cpu", cpu_ms, record_ms, gpu_ms);
+            }
         }
         vkDeviceWaitIdle(device);
+
+        objects.resize(objects.capacity());
+        gpu_driven = config.gpu_culling && indirect_draws_supported;
+        emit_json(config.json_path, fmt::format(R"({{ "device": "{}", "draw_indirect_count": {}, "culling": [ {} ] }})",
+                                                json_escape(device_properties.deviceName), draw_indirect_count != nullptr, json_rows));
+    }
+
+    const std::vector<gpu_region_timing>& application::gpu_timings() const {
+        return profiler.results();
+    }
+
+    void application::report_benchmark() const {
+        std::cout << fmt::format("Benchmark on {} ({}x{}, {}):\n",
+                                 device_properties.deviceName,
+                                 swapchain_info.resolution.width,
+                                 swapchain_info.resolution.height,
+                                 config.headless ? "headless" : "windowed");
+        std::cout << fmt::format("{}, {} frames in flight, frame pacing {}\n",
+                                 config.headless ? "offscreen" : present_mode_name(swapchain_info.present_mode),
+                                 max_frames_in_flight, config.frame_pacing ? "on" : "off");
+        std::cout << fmt::format("{} command buffers{}\n",
+                                 config.recording == record_mode::per_frame ? "per frame" : "prerecorded",
+                                 config.recording == record_mode::per_frame ? "" : fmt::format(", recorded once in {:.3f} ms", prerecord_ms));
+        std::cout << fmt::format("startup {:.2f} ms, pipelines {:.2f} ms on {} workers, {:.2f} ms blocked ({} pipeline cache)\n",
+                                 startup_ms, pipeline_ms, workers.size(), pipeline_wait_ms, pipelines.loaded_from_disk() ? "warm" : "cold");
+        if (swapchain_recreations > 0) {
+            std::cout << fmt::format("swapchain recreated {} times\n", swapchain_recreations);
+        }
+        std::cout << fmt::format("shader modules: {} created for {} stages, {} hot reloads\n",
+                                 shader_cache.size(), shader_cache.hits() + shader_cache.misses(), shader_reloads);
+        std::cout << statistics.summary();
+
+        const auto& transfers = uploads.statistics();
+        std::cout << fmt::format("uploads: {:.2f} KiB in {} copies over {} batches, {}, staged at {:.2f} GB/s\n",
+                                 transfers.bytes / 1024.0, transfers.copies, transfers.batches,
+                                 transfers.dedicated_queue ? "dedicated transfer queue" : "graphics queue",
+                                 transfers.staging_ms > 0.0 ? transfers.bytes / (transfers.staging_ms * 1e6) : 0.0);
+        if (!config.mesh_path.empty()) {
+            std::cout << fmt::format("mesh: {:.2f} MiB loaded in {:.2f} ms ({:.2f} ms mapping), {:.2f} GB/s\n",
+                                     mesh_load.file_bytes / (1024.0 * 1024.0), mesh_load_ms, mesh_load.map_ms,
+                                     mesh_load.file_bytes / (mesh_load_ms * 1e6));
+        }
+
+        // Simulation throughput from the dispatch's own gpu time, and overall from the frame rate
+        double simulation_ms = 0.0;
+        double simulated_per_second = 0.0;
+        double frame_particles_per_second = 0.0;
+        if (particles.enabled()) {
+            const auto gpu = statistics.gpu();
+            if (const auto found = gpu.find(async_simulation ? "async simulation" : "simulation"); found != gpu.end() && found->second.mean > 0.0) {
+                simulation_ms = found->second.mean;
+                simulated_per_second = particles.size() / (simulation_ms / 1000.0);
+            }
+            if (const auto cpu = statistics.cpu(); cpu.mean > 0.0) {
+                frame_particles_per_second = particles.size() / (cpu.mean / 1000.0);
+            }
+            std::cout << fmt::format("particles: {}, simulation {:.3f} ms gpu, {:.1f} M particles/s simulated, {:.1f} M particles/s at the frame rate\n",
+                                     particles.size(), simulation_ms, simulated_per_second / 1e6, frame_particles_per_second / 1e6);
+        }
+
+        // Time the simulation ran beside the frame's graphics work instead of before it
+        double overlap_ms = 0.0;
+        if (async_simulation) {
+            const auto gpu = statistics.gpu();
+            if (const auto found = gpu.find("async overlap"); found != gpu.end()) {
+                overlap_ms = found->second.mean;
+            }
+        }
+        if (config.async_compute) {
+            std::cout << fmt::format("async compute: {}, {:.3f} ms of {:.3f} ms simulation overlapped with graphics\n",
+                                     !async_simulation ? "unavailable, serialized on the graphics queue"
+                                                       : compute_family != get_graphics_queue_index() ? "compute family" : "second graphics queue",
+                                     overlap_ms, simulation_ms);
+        }
+
+        if (instanced.enabled()) {
+            const auto update = statistics.update();
+            std::cout << fmt::format("instances: {}, {:.2f} MiB streamed per frame, updated in {:.3f} ms ({:.2f} GB/s)\n",
+                                     instanced.size(), instanced.frame_bytes() / (1024.0 * 1024.0), update.mean,
+                                     update.mean > 0.0 ? instanced.frame_bytes() / (update.mean * 1e6) : 0.0);
+        }
+        if (objects.enabled()) {
+            const auto gpu = statistics.gpu();
+            const auto culling = gpu.find("culling");
+            std::cout << fmt::format("objects: {}, culled on the {}{}\n", objects.size(), gpu_driven ? "gpu" : "cpu",
+                                     culling != gpu.end() ? fmt::format(" in {:.3f} ms", culling->second.mean) : "");
+        }
+
+        const auto memory = allocator.statistics();
+        std::cout << fmt::format("gpu memory: {} device allocations, {} sub-allocations, {:.1f} of {:.1f} MiB used\n",
+                                 memory.device_allocations, memory.sub_allocations,
+                                 memory.used_bytes / (1024.0 * 1024.0), memory.reserved_bytes / (1024.0 * 1024.0));
+
+        auto json = fmt::format(R"({{ "device": "{}", "headless": {}, "width": {}, "height": {}, "warmup_frames": {}, "present_mode": "{}", "frames_in_flight": {}, "frame_pacing": {}, )"
+                                R"("record_mode": "{}", "prerecord_ms": {:.6f}, "startup_ms": {:.6f}, "pipeline_ms": {:.6f}, "pipeline_wait_ms": {:.6f}, "warm_pipeline_cache": {}, "swapchain_recreations": {}, )"
+                                R"("uploads": {{ "bytes": {}, "copies": {}, "batches": {}, "dedicated_queue": {}, "staging_ms": {:.6f} }}, "mesh_bytes": {}, "mesh_load_ms": {:.6f}, )"
+                                R"("particles": {}, "particle_simulation_ms": {:.6f}, "particles_per_second": {:.1f}, "frame_particles_per_second": {:.1f}, )"
+                                R"("async_compute": {}, "async_overlap_ms": {:.6f}, "objects": {}, "gpu_culling": {}, "instances": {}, "statistics": {} }})",
+                                json_escape(device_properties.deviceName),
+                                config.headless,
+                                swapchain_info.resolution.width,
+                                swapchain_info.resolution.height,
+                                config.warmup_frames,
+                                config.headless ? "offscreen" : present_mode_name(swapchain_info.present_mode),
+                                max_frames_in_flight,
+                                config.frame_pacing,
+                                config.recording == record_mode::per_frame ? "per_frame" : "prerecorded",
+                                prerecord_ms,
+                                startup_ms,
+                                pipeline_ms,
+                                pipeline_wait_ms,
+                                pipelines.loaded_from_disk(),
+                                swapchain_recreations,
+                                transfers.bytes,
+                                transfers.copies,
+                                transfers.batches,
+                                transfers.dedicated_queue,
+                                transfers.staging_ms,
+                                mesh_load.file_bytes,
+                                mesh_load_ms,
+                                particles.size(),
+                                simulation_ms,
+                                simulated_per_second,
+                                frame_particles_per_second,
+                                async_simulation,
+                                overlap_ms,
+                                objects.size(),
+                                gpu_driven,
+                                instanced.size(),
+                                statistics.json());
+
+        emit_json(config.json_path, json);
     }
 
     void application::create_instance() {
@@ -77,7 +516,8 @@ namespace vk_playground {
             application_info.applicationVersion = VK_API_VERSION_1_1;
             application_info.pEngineName = "no u";
             application_info.engineVersion = VK_API_VERSION_1_1;
-            application_info.apiVersion = VK_API_VERSION_1_1;
+            // 1.2 for core timeline semaphores, 1.1 devices still work through VK_KHR_timeline_semaphore
+            application_info.apiVersion = VK_API_VERSION_1_2;
         }
 
         VkInstanceCreateInfo info{}; {
@@ -93,13 +533,15 @@ namespace vk_playground {
             info.ppEnabledExtensionNames = enabled_extensions.data();
         }
 
-        if (vkCreateInstance(&info, nullptr, &instance) != VK_SUCCESS) {
+        if (vkCreateInstance(&info, nullptr, instance.put()) != VK_SUCCESS) {
             throw std::runtime_error("Could not create instance");
         }
     }
 
     void application::create_surface() {
-        glfwCreateWindowSurface(instance, window, nullptr, &surface);
+        if (glfwCreateWindowSurface(instance, window.get(), nullptr, surface.put(instance)) != VK_SUCCESS) {
+            throw std::runtime_error("Failed creating window surface");
+        }
     }
 
     void application::enable_all_extensions() {
@@ -131,9 +573,16 @@ namespace vk_playground {
             }
         }
 
+        // No discrete gpu, take whatever is there (integrated gpus, software ICDs like lavapipe on CI)
+        if (physical_device == nullptr && !physical_devices.empty()) {
+            physical_device = physical_devices.front();
+        }
+
         if (physical_device == nullptr) {
-            throw std::runtime_error("Error, can't find a discrete gpu with vulkan support");
+            throw std::runtime_error("Error, can't find a device with vulkan support");
         }
+
+        vkGetPhysicalDeviceProperties(physical_device, &device_properties);
     }
 
     void application::init_queues_families() {
@@ -146,8 +595,10 @@ namespace vk_playground {
 
     size_t application::get_graphics_queue_index() const {
         for (size_t i = 0; i < queue_families.size(); ++i) {
-            VkBool32 present_support = false;
-            vkGetPhysicalDeviceSurfaceSupportKHR(physical_device, i, surface, &present_support);
+            VkBool32 present_support = config.headless;
+            if (!config.headless) {
+                vkGetPhysicalDeviceSurfaceSupportKHR(physical_device, i, surface, &present_support);
+            }
             if ((queue_families[i].queueFlags & VK_QUEUE_GRAPHICS_BIT) &&
                 present_support) {
                 return i;
@@ -157,30 +608,167 @@ namespace vk_playground {
         return -1;
     }
 
+    std::uint32_t application::get_transfer_queue_index() const {
+        // Transfer-only families map to the copy engines, uploads there run beside rendering
+        for (std::uint32_t i = 0; i < queue_families.size(); ++i) {
+            const auto flags = queue_families[i].queueFlags;
+            if ((flags & VK_QUEUE_TRANSFER_BIT) && !(flags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT))) {
+                return i;
+            }
+        }
+
+        return get_graphics_queue_index();
+    }
+
+    std::uint32_t application::get_compute_queue_index() const {
+        // Compute-only families map to the async compute engines
+        for (std::uint32_t i = 0; i < queue_families.size(); ++i) {
+            const auto flags = queue_families[i].queueFlags;
+            if ((flags & VK_QUEUE_COMPUTE_BIT) && !(flags & VK_QUEUE_GRAPHICS_BIT)) {
+                return i;
+            }
+        }
+
+        return get_graphics_queue_index();
+    }
+
+    bool application::has_core_timeline_semaphore() const {
+        return device_properties.apiVersion >= VK_API_VERSION_1_2;
+    }
+
     void application::create_device() {
         auto graphics_queue_index = get_graphics_queue_index();
 
-        float queue_priority = 1.0f;
-        VkDeviceQueueCreateInfo queue_create_info{}; {
-            queue_create_info.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
-            queue_create_info.queueFamilyIndex = graphics_queue_index;
-            queue_create_info.queueCount = 1;
-            queue_create_info.pQueuePriorities = &queue_priority;
+        transfer_family = get_transfer_queue_index();
+
+        // Without a compute-only family a second queue of the graphics family can still run beside the first
+        compute_family = config.async_compute ? get_compute_queue_index() : static_cast<std::uint32_t>(graphics_queue_index);
+        std::uint32_t compute_queue_index = 0;
+        if (config.async_compute && compute_family == graphics_queue_index && queue_families[compute_family].queueCount > 1) {
+            compute_queue_index = 1;
+        }
+
+        const float queue_priorities[] = { 1.0f, 1.0f };
+        std::vector<VkDeviceQueueCreateInfo> queue_create_infos{};
+        const auto request_queue = [&queue_create_infos, &queue_priorities](std::uint32_t family, std::uint32_t index) {
+            for (auto& queue_create_info : queue_create_infos) {
+                if (queue_create_info.queueFamilyIndex == family) {
+                    queue_create_info.queueCount = std::max(queue_create_info.queueCount, index + 1);
+                    return;
+                }
+            }
+
+            VkDeviceQueueCreateInfo queue_create_info{}; {
+                queue_create_info.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+                queue_create_info.queueFamilyIndex = family;
+                queue_create_info.queueCount = index + 1;
+                queue_create_info.pQueuePriorities = queue_priorities;
+            }
+            queue_create_infos.emplace_back(queue_create_info);
+        };
+        request_queue(graphics_queue_index, 0);
+        request_queue(transfer_family, 0);
+        request_queue(compute_family, compute_queue_index);
+
+        std::vector<const char*> device_extensions{};
+        if (!config.headless) {
+            device_extensions.emplace_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+        }
+        if (!has_core_timeline_semaphore()) {
+            device_extensions.emplace_back(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+        }
+
+        std::uint32_t extension_count = 0;
+        vkEnumerateDeviceExtensionProperties(physical_device, nullptr, &extension_count, nullptr);
+        std::vector<VkExtensionProperties> device_extension_properties(extension_count);
+        vkEnumerateDeviceExtensionProperties(physical_device, nullptr, &extension_count, device_extension_properties.data());
+        const auto extension_supported = [&device_extension_properties](const char* name) {
+            return std::any_of(device_extension_properties.begin(), device_extension_properties.end(), [name](const VkExtensionProperties& extension) {
+                return std::strcmp(extension.extensionName, name) == 0;
+            });
+        };
+
+        // Core in 1.2 as well, the bindless set needs it
+        if (!has_core_timeline_semaphore()) {
+            if (!extension_supported(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME)) {
+                throw std::runtime_error("Error, device doesn't support descriptor indexing");
+            }
+            device_extensions.emplace_back(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+        }
+
+        // Same feature structs for core 1.2 and the extensions
+        VkPhysicalDeviceDescriptorIndexingFeatures indexing_features{}; {
+            indexing_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+        }
+
+        VkPhysicalDeviceTimelineSemaphoreFeatures timeline_features{}; {
+            timeline_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES;
+            timeline_features.pNext = &indexing_features;
+        }
+
+        VkPhysicalDeviceFeatures2 features{}; {
+            features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+            features.pNext = &timeline_features;
+        }
+
+        vkGetPhysicalDeviceFeatures2(physical_device, &features);
+        if (!timeline_features.timelineSemaphore) {
+            throw std::runtime_error("Error, device doesn't support timeline semaphores");
+        }
+        if (!bindless_descriptors::supported(indexing_features)) {
+            throw std::runtime_error("Error, device doesn't support the descriptor indexing features bindless descriptors need");
+        }
+
+        // Only what's used, not everything the query reported
+        auto enabled_indexing_features = bindless_descriptors::required_features();
+        timeline_features.pNext = &enabled_indexing_features;
+
+        // material.frag picks its buffer from the bindless array with a pushed index
+        if (!features.features.shaderStorageBufferArrayDynamicIndexing) {
+            throw std::runtime_error("Error, device doesn't support dynamically indexed storage buffer arrays");
+        }
+        VkPhysicalDeviceFeatures enabled_features{};
+        enabled_features.shaderStorageBufferArrayDynamicIndexing = true;
+
+        // Culled draws carry their object index in firstInstance, many of them per indirect call
+        bool indirect_count_supported = false;
+        if (config.object_count > 0) {
+            indirect_draws_supported = features.features.multiDrawIndirect && features.features.drawIndirectFirstInstance;
+            enabled_features.multiDrawIndirect = indirect_draws_supported;
+            enabled_features.drawIndirectFirstInstance = indirect_draws_supported;
+
+            indirect_count_supported = indirect_draws_supported && extension_supported(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+            if (indirect_count_supported) {
+                device_extensions.emplace_back(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+            }
         }
 
         VkDeviceCreateInfo device_create_info{}; {
             device_create_info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
-            device_create_info.pQueueCreateInfos = &queue_create_info;
-            device_create_info.queueCreateInfoCount = 1;
-            device_create_info.ppEnabledExtensionNames = enabled_device_extensions;
-            device_create_info.enabledExtensionCount = 1;
+            device_create_info.pNext = &timeline_features;
+            device_create_info.pQueueCreateInfos = queue_create_infos.data();
+            device_create_info.queueCreateInfoCount = queue_create_infos.size();
+            device_create_info.ppEnabledExtensionNames = device_extensions.data();
+            device_create_info.enabledExtensionCount = device_extensions.size();
+            device_create_info.pEnabledFeatures = &enabled_features;
         }
 
-        if (vkCreateDevice(physical_device, &device_create_info, nullptr, &device) != VK_SUCCESS) {
+        if (vkCreateDevice(physical_device, &device_create_info, nullptr, device.put()) != VK_SUCCESS) {
             throw std::runtime_error("Failed creating logical device");
         }
 
         vkGetDeviceQueue(device, graphics_queue_index, 0, &queue_handle);
+        vkGetDeviceQueue(device, transfer_family, 0, &transfer_queue_handle);
+        vkGetDeviceQueue(device, compute_family, compute_queue_index, &compute_queue_handle);
+
+        // The extension's entry point works on 1.1 devices too, core 1.2 would need the drawIndirectCount feature enabled
+        if (indirect_count_supported) {
+            draw_indirect_count = reinterpret_cast<PFN_vkCmdDrawIndexedIndirectCount>(vkGetDeviceProcAddr(device, "vkCmdDrawIndexedIndirectCountKHR"));
+        }
+    }
+
+    void application::create_pipeline_cache() {
+        pipelines.create(device, device_properties, config.pipeline_cache_path);
     }
 
     void application::init_command_pool() {
@@ -190,12 +778,79 @@ namespace vk_playground {
             command_pool_info.flags = 0;
         }
 
-        if (vkCreateCommandPool(device, &command_pool_info, nullptr, &command_pool) != VK_SUCCESS) {
+        if (vkCreateCommandPool(device, &command_pool_info, nullptr, command_pool.put(device)) != VK_SUCCESS) {
             throw std::runtime_error("Failed creating command pool");
         }
     }
 
+    void application::init_frame_command_pools() {
+        // Every mode needs somewhere to record the frame's uploads, the frame's own command
+        // buffer comes from the same pool when it's recorded per frame
+        const bool per_frame = config.recording == record_mode::per_frame;
+        frame_command_pools.resize(max_frames_in_flight);
+        frame_command_buffers.resize(per_frame ? max_frames_in_flight : 0);
+        upload_command_buffers.resize(max_frames_in_flight);
+
+        VkCommandPoolCreateInfo command_pool_info{}; {
+            command_pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+            command_pool_info.queueFamilyIndex = get_graphics_queue_index();
+            // Reset wholesale every frame, buffers are never reset individually
+            command_pool_info.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+        }
+
+        for (std::uint32_t i = 0; i < max_frames_in_flight; ++i) {
+            if (vkCreateCommandPool(device, &command_pool_info, nullptr, frame_command_pools[i].put(device)) != VK_SUCCESS) {
+                throw std::runtime_error("Failed creating frame command pool");
+            }
+
+            VkCommandBufferAllocateInfo command_buf_info{}; {
+                command_buf_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+                command_buf_info.commandPool = frame_command_pools[i];
+                command_buf_info.commandBufferCount = 1;
+                command_buf_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+            }
+
+            if (vkAllocateCommandBuffers(device, &command_buf_info, &upload_command_buffers[i]) != VK_SUCCESS ||
+                (per_frame && vkAllocateCommandBuffers(device, &command_buf_info, &frame_command_buffers[i]) != VK_SUCCESS)) {
+                throw std::runtime_error("Failed allocating frame command buffer");
+            }
+        }
+
+        if (!per_frame || config.record_threads <= 1) {
+            return;
+        }
+
+        secondary_command_pools.resize(max_frames_in_flight);
+        secondary_command_buffers.resize(max_frames_in_flight);
+
+        for (std::uint32_t i = 0; i < max_frames_in_flight; ++i) {
+            secondary_command_pools[i].resize(config.record_threads);
+            secondary_command_buffers[i].resize(config.record_threads);
+
+            for (std::uint32_t thread = 0; thread < config.record_threads; ++thread) {
+                if (vkCreateCommandPool(device, &command_pool_info, nullptr, secondary_command_pools[i][thread].put(device)) != VK_SUCCESS) {
+                    throw std::runtime_error("Failed creating secondary command pool");
+                }
+
+                VkCommandBufferAllocateInfo command_buf_info{}; {
+                    command_buf_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+                    command_buf_info.commandPool = secondary_command_pools[i][thread];
+                    command_buf_info.commandBufferCount = 1;
+                    command_buf_info.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+                }
+
+                if (vkAllocateCommandBuffers(device, &command_buf_info, &secondary_command_buffers[i][thread]) != VK_SUCCESS) {
+                    throw std::runtime_error("Failed allocating secondary command buffer");
+                }
+            }
+        }
+    }
+
     void application::init_command_buffer() {
+        if (config.recording != record_mode::prerecorded) {
+            return;
+        }
+
         command_buffers.resize(swapchain_info.image_count);
         VkCommandBufferAllocateInfo command_buf_info{}; {
             command_buf_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
@@ -209,14 +864,16 @@ namespace vk_playground {
         }
     }
 
-    void application::create_swapchain() {
+    void application::create_swapchain(VkSwapchainKHR old_swapchain) {
         VkSurfaceCapabilitiesKHR surface_capabilities{};
         vkGetPhysicalDeviceSurfaceCapabilitiesKHR(physical_device, surface, &surface_capabilities);
 
         if (surface_capabilities.currentExtent.width != UINT32_MAX) {
             swapchain_info.resolution = surface_capabilities.currentExtent;
         } else {
-            VkExtent2D actual_extent{ width, height };
+            int framebuffer_width{}, framebuffer_height{};
+            glfwGetFramebufferSize(window.get(), &framebuffer_width, &framebuffer_height);
+            VkExtent2D actual_extent{ static_cast<std::uint32_t>(framebuffer_width), static_cast<std::uint32_t>(framebuffer_height) };
 
             actual_extent.width = std::clamp(actual_extent.width, surface_capabilities.minImageExtent.width, surface_capabilities.maxImageExtent.width);
             actual_extent.height = std::clamp(actual_extent.height, surface_capabilities.minImageExtent.height, surface_capabilities.maxImageExtent.height);
@@ -228,30 +885,34 @@ namespace vk_playground {
             swapchain_info.image_count = surface_capabilities.maxImageCount;
         }
 
-        std::uint32_t format_count{};
-        vkGetPhysicalDeviceSurfaceFormatsKHR(physical_device, surface, &format_count, nullptr);
-        std::vector<VkSurfaceFormatKHR> formats(format_count);
-        vkGetPhysicalDeviceSurfaceFormatsKHR(physical_device, surface, &format_count, formats.data());
-
-        swapchain_info.format = formats[0];
-        for (const auto& format : formats) {
-            if ((format.format == VK_FORMAT_B8G8R8A8_SRGB ||
-                format.format == VK_FORMAT_R8G8B8A8_SRGB) &&
-                format.colorSpace == VK_COLOR_SPACE_SRGB_NONLINEAR_KHR) {
-                swapchain_info.format = format;
-                break;
+        // The render pass and pipeline were built for the first format, recreation keeps it
+        if (old_swapchain == nullptr) {
+            std::uint32_t format_count{};
+            vkGetPhysicalDeviceSurfaceFormatsKHR(physical_device, surface, &format_count, nullptr);
+            std::vector<VkSurfaceFormatKHR> formats(format_count);
+            vkGetPhysicalDeviceSurfaceFormatsKHR(physical_device, surface, &format_count, formats.data());
+
+            swapchain_info.format = formats[0];
+            for (const auto& format : formats) {
+                if ((format.format == VK_FORMAT_B8G8R8A8_SRGB ||
+                    format.format == VK_FORMAT_R8G8B8A8_SRGB) &&
+                    format.colorSpace == VK_COLOR_SPACE_SRGB_NONLINEAR_KHR) {
+                    swapchain_info.format = format;
+                    break;
+                }
             }
-        }
 
-        std::uint32_t present_mode_count{};
-        vkGetPhysicalDeviceSurfacePresentModesKHR(physical_device, surface, &present_mode_count, nullptr);
-        std::vector<VkPresentModeKHR> present_modes(present_mode_count);
-        vkGetPhysicalDeviceSurfacePresentModesKHR(physical_device, surface, &present_mode_count, present_modes.data());
-
-        swapchain_info.present_mode = VK_PRESENT_MODE_FIFO_KHR;
-        for (const auto& mode : present_modes) {
-            if (mode == VK_PRESENT_MODE_IMMEDIATE_KHR) {
-                swapchain_info.present_mode = mode;
+            std::uint32_t present_mode_count{};
+            vkGetPhysicalDeviceSurfacePresentModesKHR(physical_device, surface, &present_mode_count, nullptr);
+            std::vector<VkPresentModeKHR> present_modes(present_mode_count);
+            vkGetPhysicalDeviceSurfacePresentModesKHR(physical_device, surface, &present_mode_count, present_modes.data());
+
+            swapchain_info.present_mode = VK_PRESENT_MODE_FIFO_KHR;
+            for (const auto& mode : present_mode_preference(config.presentation)) {
+                if (std::find(present_modes.begin(), present_modes.end(), mode) != present_modes.end()) {
+                    swapchain_info.present_mode = mode;
+                    break;
+                }
             }
         }
 
@@ -271,18 +932,98 @@ namespace vk_playground {
             swapchain_create_info.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
             swapchain_create_info.presentMode = swapchain_info.present_mode;
             swapchain_create_info.clipped = true;
-            swapchain_create_info.oldSwapchain = nullptr;
+            // Lets the presentation engine hand over from the old swapchain without a gap
+            swapchain_create_info.oldSwapchain = old_swapchain;
         }
 
-        if (vkCreateSwapchainKHR(device, &swapchain_create_info, nullptr, &swapchain) != VK_SUCCESS) {
+        if (vkCreateSwapchainKHR(device, &swapchain_create_info, nullptr, swapchain.put(device)) != VK_SUCCESS) {
             throw std::runtime_error("failed to create swap chain!");
         }
 
+        swapchain_images.clear();
         vkGetSwapchainImagesKHR(device, swapchain, &swapchain_info.image_count, nullptr);
         swapchain_images.resize(swapchain_info.image_count);
         vkGetSwapchainImagesKHR(device, swapchain, &swapchain_info.image_count, swapchain_images.data());
     }
 
+    void application::recreate_swapchain() {
+        int framebuffer_width{}, framebuffer_height{};
+        glfwGetFramebufferSize(window.get(), &framebuffer_width, &framebuffer_height);
+        // Minimized, there's nothing to present to until the window comes back
+        while (framebuffer_width == 0 || framebuffer_height == 0) {
+            if (glfwWindowShouldClose(window.get())) {
+                return;
+            }
+            glfwWaitEvents();
+            glfwGetFramebufferSize(window.get(), &framebuffer_width, &framebuffer_height);
+        }
+        framebuffer_resized = false;
+
+        // Frames still in flight keep using these, the deletion queue releases them once retired.
+        // The render pass, pipeline and per frame command pools don't depend on the extent and stay
+        const auto retire_value = graphics_timeline.last_submitted();
+        deletions.retire(retire_value, std::exchange(swapchain_framebuffers, {}));
+        deletions.retire(retire_value, std::exchange(swapchain_image_views, {}));
+        retire_command_buffers(retire_value);
+
+        auto old_swapchain = std::move(swapchain);
+        create_swapchain(old_swapchain);
+        deletions.retire(retire_value, std::move(old_swapchain));
+
+        // Prerecorded buffers use one profiler slot per image, frames in flight still write the old query pools
+        if (config.recording == record_mode::prerecorded && swapchain_info.image_count != profiler_slots) {
+            deletions.defer(retire_value, [old_profiler = std::exchange(profiler, {})]() mutable {
+                old_profiler.destroy();
+            });
+            create_graphics_profiler();
+        }
+
+        create_image_views();
+        create_framebuffer();
+        init_command_buffer();
+        record_command_buffers();
+
+        // Submissions using the old images say nothing about the new ones
+        image_values.assign(swapchain_info.image_count, 0);
+        ++swapchain_recreations;
+    }
+
+    void application::retire_command_buffers(std::uint64_t value) {
+        if (command_buffers.empty()) {
+            return;
+        }
+
+        deletions.defer(value, [device = device.get(), pool = command_pool.get(), buffers = std::exchange(command_buffers, {})]() {
+            vkFreeCommandBuffers(device, pool, buffers.size(), buffers.data());
+        });
+    }
+
+    void application::create_offscreen_images() {
+        swapchain_info.format = { VK_FORMAT_R8G8B8A8_UNORM, VK_COLOR_SPACE_SRGB_NONLINEAR_KHR };
+        swapchain_info.present_mode = VK_PRESENT_MODE_IMMEDIATE_KHR;
+        swapchain_info.resolution = { width, height };
+        swapchain_info.image_count = offscreen_image_count;
+
+        VkImageCreateInfo image_create_info{}; {
+            image_create_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+            image_create_info.imageType = VK_IMAGE_TYPE_2D;
+            image_create_info.format = swapchain_info.format.format;
+            image_create_info.extent = { swapchain_info.resolution.width, swapchain_info.resolution.height, 1 };
+            image_create_info.mipLevels = 1;
+            image_create_info.arrayLayers = 1;
+            image_create_info.samples = VK_SAMPLE_COUNT_1_BIT;
+            image_create_info.tiling = VK_IMAGE_TILING_OPTIMAL;
+            image_create_info.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+            image_create_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+            image_create_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        }
+
+        for (std::uint32_t i = 0; i < swapchain_info.image_count; ++i) {
+            auto& image = offscreen_images.emplace_back(allocator.create_image(image_create_info, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT));
+            swapchain_images.emplace_back(image.image);
+        }
+    }
+
     void application::setup_debug_callback() {
         if (!enable_validation_layers) {
             return;
@@ -302,10 +1043,12 @@ namespace vk_playground {
     }
 
     void application::enable_required_extensions() {
-        std::uint32_t req_count{};
-        auto req_extensions = glfwGetRequiredInstanceExtensions(&req_count);
-        for (int i = 0; i < req_count; ++i) {
-            enabled_extensions.emplace_back(req_extensions[i]);
+        if (!config.headless) {
+            std::uint32_t req_count{};
+            auto req_extensions = glfwGetRequiredInstanceExtensions(&req_count);
+            for (int i = 0; i < req_count; ++i) {
+                enabled_extensions.emplace_back(req_extensions[i]);
+            }
         }
 
         enabled_extensions.emplace_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
@@ -329,16 +1072,25 @@ namespace vk_playground {
 
         for (const auto& image : swapchain_images) {
             image_view_info.image = image;
-            if (vkCreateImageView(device, &image_view_info, nullptr, &swapchain_image_views.emplace_back()) != VK_SUCCESS) {
+            if (vkCreateImageView(device, &image_view_info, nullptr, swapchain_image_views.emplace_back().put(device)) != VK_SUCCESS) {
                 throw std::runtime_error("Failed to create image view");
             }
         }
     }
 
     void application::create_shader_modules() {
-        shader_modules.emplace_back(
-            "../resources/shaders/compiled/triangle_vert.spv",
-            "../resources/shaders/compiled/triangle_frag.spv").create_module(device);
+        const std::filesystem::path directory = config.shader_directory;
+        graphics_shader_sources = { directory / "triangle.vert", directory / "material.frag" };
+
+        shader_cache.create(device);
+        auto& graphics_shader = shader_modules.emplace_back();
+        for (const auto& source : graphics_shader_sources) {
+            graphics_shader.add_stage(shader_stage_from_path(source), compiled_shader_path(source), shader_cache);
+        }
+
+        if (config.hot_reload) {
+            shader_changes.create(directory);
+        }
     }
 
     void application::create_render_pass() {
@@ -349,8 +1101,9 @@ namespace vk_playground {
             color_attachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
             color_attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
             color_attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-            color_attachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-            color_attachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+            // The frame graph transitions the image into the pass and out to present or transfer
+            color_attachment.initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+            color_attachment.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
         }
 
         VkAttachmentReference color_attachment_ref{}; {
@@ -372,145 +1125,392 @@ namespace vk_playground {
             render_pass_info.pSubpasses = &subpass_description;
         }
 
-        if (vkCreateRenderPass(device, &render_pass_info, nullptr, &render_pass) != VK_SUCCESS) {
+        if (vkCreateRenderPass(device, &render_pass_info, nullptr, render_pass.put(device)) != VK_SUCCESS) {
             throw std::runtime_error("Failed to create renderpass");
         }
     }
 
     void application::create_pipeline() {
-        VkPipelineShaderStageCreateInfo vert_pipeline_create_info{}; {
-            vert_pipeline_create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-            vert_pipeline_create_info.stage = VK_SHADER_STAGE_VERTEX_BIT;
-            vert_pipeline_create_info.module = shader_modules.back().get_modules()[0];
-            vert_pipeline_create_info.pName = "main";
+        graphics_pipeline_description description{}; {
+            description.stages = shader_modules.back().stages();
+            description.vertex_bindings = { vertex::binding() };
+            const auto attributes = vertex::attributes();
+            description.vertex_attributes.assign(attributes.begin(), attributes.end());
+            description.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+            // Viewport and scissor are set while recording, a resize doesn't need a new pipeline
+            description.dynamic_states = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+            description.extent = swapchain_info.resolution;
+            // Materials come from the bindless set, the one layout every bindless pipeline shares
+            description.layout = bindless.pipeline_layout();
+            description.render_pass = render_pass;
+            description.subpass = 0;
         }
 
-        VkPipelineShaderStageCreateInfo frag_pipeline_create_info{}; {
-            frag_pipeline_create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-            frag_pipeline_create_info.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-            frag_pipeline_create_info.module = shader_modules.back().get_modules()[1];
-            frag_pipeline_create_info.pName = "main";
+        // Compiled on the worker pool, the rest of vk_init() keeps going in the meantime
+        graphics_pipeline_info = description;
+        pending_graphics_pipeline = compiler.compile(std::move(description));
+    }
+
+    void application::create_geometry() {
+        if (!config.mesh_path.empty()) {
+            model = load_mesh(config.mesh_path, allocator, uploads, &mesh_load);
+            return;
         }
 
-        VkPipelineVertexInputStateCreateInfo vertex_input_info{}; {
-            vertex_input_info.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-            vertex_input_info.vertexBindingDescriptionCount = 0;
-            vertex_input_info.pVertexBindingDescriptions = nullptr;
-            vertex_input_info.vertexAttributeDescriptionCount = 0;
-            vertex_input_info.pVertexAttributeDescriptions = nullptr;
+        // Same triangle the vertex shader used to hardcode, kept in the layout of a mesh file
+        struct triangle_data {
+            mesh_header header{};
+            mesh_submesh submesh{};
+            std::array<mesh_vertex, 3> vertices{};
+            std::array<index_type, 3> indices{};
+        };
+
+        auto triangle = std::make_shared<triangle_data>(); {
+            triangle->vertices = {{
+                { {  0.5f,  0.5f, 0.0f }, { 1.0f, 0.0f, 0.0f } },
+                { { -0.5f,  0.5f, 0.0f }, { 0.0f, 1.0f, 0.0f } },
+                { {  0.0f, -0.5f, 0.0f }, { 0.0f, 0.0f, 1.0f } }
+            }};
+            triangle->indices = { 0, 1, 2 };
+            triangle->header.vertex_count = triangle->vertices.size();
+            triangle->header.index_count = triangle->indices.size();
+            triangle->header.bounds = { { -0.5f, -0.5f, 0.0f }, { 0.5f, 0.5f, 0.0f } };
+            triangle->submesh = { 0, 3, 0, 0, triangle->header.bounds };
         }
 
-        VkPipelineInputAssemblyStateCreateInfo input_assembly{}; {
-            input_assembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-            input_assembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-            input_assembly.primitiveRestartEnable = false;
+        mesh_view view{}; {
+            view.header = &triangle->header;
+            view.submeshes = { &triangle->submesh, 1 };
+            view.vertices = std::as_bytes(std::span(triangle->vertices));
+            view.indices = std::as_bytes(std::span(triangle->indices));
         }
 
-        VkViewport viewport{}; {
-            viewport.x = 0.0f;
-            viewport.y = 0.0f;
-            viewport.width = static_cast<float>(swapchain_info.resolution.width);
-            viewport.height = static_cast<float>(swapchain_info.resolution.height);
-            viewport.minDepth = 0.0f;
-            viewport.maxDepth = 1.0f;
+        model = upload_mesh(allocator, uploads, view, std::move(triangle));
+    }
+
+    void application::create_uniforms() {
+        // The record benchmark draws more copies than the command line asks for
+        const auto draws = config.record_benchmark ? std::max(config.draw_count, max_record_benchmark_draws) : config.draw_count;
+        const auto stride = align_up(sizeof(draw_uniforms), device_properties.limits.minUniformBufferOffsetAlignment);
+        uniforms.create(device, allocator, device_properties.limits, max_frames_in_flight, draws * stride, sizeof(draw_uniforms));
+    }
+
+    void application::create_materials() {
+        VkPhysicalDeviceDescriptorIndexingProperties indexing_properties{}; {
+            indexing_properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES;
         }
 
-        VkRect2D scissor{}; {
-            scissor.extent = swapchain_info.resolution;
-            scissor.offset = { 0, 0 };
+        VkPhysicalDeviceProperties2 properties{}; {
+            properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+            properties.pNext = &indexing_properties;
+        }
+
+        vkGetPhysicalDeviceProperties2(physical_device, &properties);
+        // The uniform ring's dynamic offset set follows the bindless one
+        const VkDescriptorSetLayout extra_sets[] = { uniforms.descriptor_set_layout() };
+        bindless.create(device, indexing_properties, extra_sets);
+
+        // Same layout as material.frag's materials
+        struct material_data {
+            float tint[4];
+        };
+
+        // The first submesh stays untinted, the default triangle keeps its vertex colors
+        constexpr material_data palette[] = {
+            { { 1.0f, 1.0f, 1.0f, 1.0f } }, { { 1.0f, 0.6f, 0.6f, 1.0f } }, { { 0.6f, 1.0f, 0.6f, 1.0f } },
+            { { 0.6f, 0.6f, 1.0f, 1.0f } }, { { 1.0f, 1.0f, 0.6f, 1.0f } }, { { 0.6f, 1.0f, 1.0f, 1.0f } }
+        };
+        auto tints = std::make_shared<std::vector<material_data>>();
+        for (std::size_t i = 0; i < model.submeshes.size(); ++i) {
+            tints->push_back(palette[i % std::size(palette)]);
         }
 
-        VkPipelineViewportStateCreateInfo viewport_state_info{}; {
-            viewport_state_info.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
-            viewport_state_info.viewportCount = 1;
-            viewport_state_info.pViewports = &viewport;
-            viewport_state_info.scissorCount = 1;
-            viewport_state_info.pScissors = &scissor;
-        }
-
-        VkPipelineRasterizationStateCreateInfo rasterizer_state_info{}; {
-            rasterizer_state_info.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
-            rasterizer_state_info.depthClampEnable = false;
-            rasterizer_state_info.rasterizerDiscardEnable = false;
-            rasterizer_state_info.polygonMode = VK_POLYGON_MODE_FILL;
-            rasterizer_state_info.lineWidth = 1.0f;
-            rasterizer_state_info.cullMode = VK_CULL_MODE_NONE;
-            rasterizer_state_info.frontFace = VK_FRONT_FACE_CLOCKWISE;
-            rasterizer_state_info.depthBiasEnable = false;
-        }
-
-        VkPipelineMultisampleStateCreateInfo multisampling_state_info{}; {
-            multisampling_state_info.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
-            multisampling_state_info.sampleShadingEnable = false;
-            multisampling_state_info.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
-            multisampling_state_info.minSampleShading = 1.0f;
-            multisampling_state_info.pSampleMask = nullptr;
-            multisampling_state_info.alphaToCoverageEnable = false;
-            multisampling_state_info.alphaToOneEnable = false;
-        }
-
-        VkPipelineColorBlendAttachmentState color_blend_attachment{}; {
-            color_blend_attachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT |
-                                                    VK_COLOR_COMPONENT_G_BIT |
-                                                    VK_COLOR_COMPONENT_B_BIT |
-                                                    VK_COLOR_COMPONENT_A_BIT;
-            color_blend_attachment.blendEnable = false;
-            color_blend_attachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
-            color_blend_attachment.dstColorBlendFactor = VK_BLEND_FACTOR_ZERO;
-            color_blend_attachment.colorBlendOp = VK_BLEND_OP_ADD;
-            color_blend_attachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
-            color_blend_attachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
-            color_blend_attachment.alphaBlendOp = VK_BLEND_OP_ADD;
-        }
-
-        VkPipelineColorBlendStateCreateInfo color_blend_info{}; {
-            color_blend_info.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
-            color_blend_info.logicOpEnable = false;
-            color_blend_info.logicOp = VK_LOGIC_OP_COPY;
-            color_blend_info.attachmentCount = 1;
-            color_blend_info.pAttachments = &color_blend_attachment;
-            color_blend_info.blendConstants[0] = 0.0f;
-            color_blend_info.blendConstants[1] = 0.0f;
-            color_blend_info.blendConstants[2] = 0.0f;
-            color_blend_info.blendConstants[3] = 0.0f;
-        }
-
-        VkPipelineLayoutCreateInfo pipeline_layout_info{}; {
-            pipeline_layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-            pipeline_layout_info.setLayoutCount = 0;
-            pipeline_layout_info.pSetLayouts = nullptr;
-            pipeline_layout_info.pushConstantRangeCount = 0;
-            pipeline_layout_info.pPushConstantRanges = nullptr;
-        }
-
-        if (vkCreatePipelineLayout(device, &pipeline_layout_info, nullptr, &pipeline_layout) != VK_SUCCESS) {
-            throw std::runtime_error("Failed to create pipeline layout");
-        }
-
-        VkPipelineShaderStageCreateInfo shader_stages[] = { vert_pipeline_create_info, frag_pipeline_create_info };
-
-        VkGraphicsPipelineCreateInfo pipeline_info{}; {
-            pipeline_info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-            pipeline_info.stageCount = 2;
-            pipeline_info.pStages = shader_stages;
-            pipeline_info.pVertexInputState = &vertex_input_info;
-            pipeline_info.pInputAssemblyState = &input_assembly;
-            pipeline_info.pViewportState = &viewport_state_info;
-            pipeline_info.pRasterizationState = &rasterizer_state_info;
-            pipeline_info.pMultisampleState = &multisampling_state_info;
-            pipeline_info.pDepthStencilState = nullptr;
-            pipeline_info.pColorBlendState = &color_blend_info;
-            pipeline_info.pDynamicState = nullptr;
-            pipeline_info.layout = pipeline_layout;
-            pipeline_info.renderPass = render_pass;
-            pipeline_info.subpass = 0;
-            pipeline_info.basePipelineHandle = nullptr;
-            pipeline_info.basePipelineIndex = -1;
-        }
-
-       if (vkCreateGraphicsPipelines(device, nullptr, 1, &pipeline_info, nullptr, &graphics_pipeline) != VK_SUCCESS) {
-            throw std::runtime_error("Failed to create graphics pipeline");
-       }
+        VkBufferCreateInfo buffer_info{}; {
+            buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+            buffer_info.size = tints->size() * sizeof(material_data);
+            buffer_info.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+            buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        }
+        materials = allocator.create_buffer(buffer_info, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        uploads.upload(materials.buffer, 0, std::as_bytes(std::span(*tints)), tints);
+
+        material_slot = bindless.add_buffer(materials.buffer);
+    }
+
+    bool application::record_uploads(std::uint64_t signal_value, std::vector<semaphore_wait>& waits) {
+        if (uploads.idle()) {
+            return false;
+        }
+
+        const auto& command_buffer = upload_command_buffers[current_frame];
+
+        VkCommandBufferBeginInfo begin_info{}; {
+            begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+            begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        }
+
+        if (vkBeginCommandBuffer(command_buffer, &begin_info) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to begin upload command buffer");
+        }
+
+        if (const auto transfer_value = uploads.flush(command_buffer, signal_value, graphics_timeline.completed()); transfer_value != 0) {
+            waits.push_back({ uploads.semaphore(), transfer_value, upload_manager::consumer_stages });
+        }
+
+        if (vkEndCommandBuffer(command_buffer) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to end upload command buffer");
+        }
+
+        // Everything is submitted ahead of the frame's draws in the same batch,
+        // the acquire barriers make it visible before vertex input reads it
+        geometry_ready = uploads.idle();
+        return true;
+    }
+
+    void application::flush_uploads_blocking() {
+        current_frame = 0;
+        while (!uploads.idle()) {
+            graphics_timeline.wait(frame_values[current_frame]);
+            vkResetCommandPool(device, frame_command_pools[current_frame], 0);
+
+            const auto signal_value = graphics_timeline.next();
+            std::vector<semaphore_wait> waits{};
+            record_uploads(signal_value, waits);
+            submit_graphics({ upload_command_buffers[current_frame] }, signal_value, waits, false);
+
+            frame_values[current_frame] = signal_value;
+            graphics_timeline.wait(signal_value);
+        }
+    }
+
+    void application::submit_graphics(const std::vector<VkCommandBuffer>& submitted, std::uint64_t signal_value, const std::vector<semaphore_wait>& waits, bool swapchain_sync) {
+        std::vector<VkSemaphore> wait_semaphores{};
+        std::vector<std::uint64_t> wait_values{};
+        std::vector<VkPipelineStageFlags> wait_stages{};
+        if (swapchain_sync) {
+            // The binary semaphore ignores its value
+            wait_semaphores.emplace_back(image_available[current_frame]);
+            wait_values.emplace_back(0);
+            wait_stages.emplace_back(VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+        }
+        for (const auto& wait : waits) {
+            wait_semaphores.emplace_back(wait.semaphore);
+            wait_values.emplace_back(wait.value);
+            wait_stages.emplace_back(wait.stages);
+        }
+
+        const VkSemaphore signal_semaphores[] = { graphics_timeline.handle(), render_finish[current_frame] };
+        const std::uint64_t signal_values[] = { signal_value, 0 };
+        // Offscreen images are never acquired or presented, only the timeline is signaled
+        const std::uint32_t signal_count = swapchain_sync ? 2 : 1;
+
+        VkTimelineSemaphoreSubmitInfo timeline_submit_info{}; {
+            timeline_submit_info.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+            timeline_submit_info.waitSemaphoreValueCount = wait_values.size();
+            timeline_submit_info.pWaitSemaphoreValues = wait_values.data();
+            timeline_submit_info.signalSemaphoreValueCount = signal_count;
+            timeline_submit_info.pSignalSemaphoreValues = signal_values;
+        }
+
+        VkSubmitInfo submit_info{}; {
+            submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+            submit_info.pNext = &timeline_submit_info;
+            submit_info.commandBufferCount = submitted.size();
+            submit_info.pCommandBuffers = submitted.data();
+            submit_info.signalSemaphoreCount = signal_count;
+            submit_info.pSignalSemaphores = signal_semaphores;
+            submit_info.waitSemaphoreCount = wait_semaphores.size();
+            submit_info.pWaitSemaphores = wait_semaphores.data();
+            submit_info.pWaitDstStageMask = wait_stages.data();
+        }
+
+        if (vkQueueSubmit(queue_handle, 1, &submit_info, nullptr) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to submit command buffer");
+        }
+    }
+
+    void application::submit_simulation(std::uint64_t graphics_value) {
+        const auto frame = static_cast<std::uint32_t>(current_frame);
+        const auto command_buffer = compute.begin(frame);
+        // begin() waited for the slot's previous step, so did the graphics slot wait for its frame
+        if (compute_profiler.collect(frame)) {
+            measure_async_overlap();
+        }
+
+        compute_profiler.begin_frame(command_buffer, frame);
+        const auto simulation_region = compute_profiler.begin_region(command_buffer, frame, "async simulation");
+        particles.record_simulation(command_buffer, particle_step);
+        compute_profiler.end_region(command_buffer, frame, simulation_region);
+
+        // This step overwrites the buffer the previous frame drew. The first step waits for
+        // this frame instead, its uploads wrote the initial state
+        const semaphore_wait graphics_wait{
+            graphics_timeline.handle(), particle_step == 0 ? graphics_value : graphics_value - 1, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT
+        };
+        particle_compute_value = compute.submit(frame, { &graphics_wait, 1 });
+        compute_profiler.mark_submitted(frame);
+        ++particle_step;
+    }
+
+    void application::measure_async_overlap() {
+        const auto& simulation = compute_profiler.results().front();
+
+        // Graphics timestamps of the same frame slot were collected at the start of this frame.
+        // Timestamps of different queues are assumed to share the device clock, true on current desktop drivers
+        double graphics_start = std::numeric_limits<double>::max();
+        double graphics_end = 0.0;
+        for (const auto& region : current_timing.gpu_regions) {
+            graphics_start = std::min(graphics_start, region.start_ms);
+            graphics_end = std::max(graphics_end, region.start_ms + region.ms);
+        }
+
+        current_timing.gpu_regions.emplace_back(simulation);
+        if (graphics_end > 0.0) {
+            const auto overlap = std::min(graphics_end, simulation.start_ms + simulation.ms) - std::max(graphics_start, simulation.start_ms);
+            current_timing.gpu_regions.push_back({ "async overlap", std::max(overlap, 0.0), std::max(graphics_start, simulation.start_ms) });
+        }
+    }
+
+    void application::wait_pipelines() {
+        const auto wait_start = bench_clock::now();
+        graphics_pipeline = unique_pipeline(device, pending_graphics_pipeline.get());
+        particles.wait_pipelines();
+        objects.wait_pipelines();
+        instanced.wait_pipelines();
+        pipeline_wait_ms = elapsed_ms(wait_start);
+        pipeline_ms = compiler.compile_ms();
+    }
+
+    // Whether any of the changed sources is one of sources
+    static bool uses_any(const std::vector<std::filesystem::path>& sources, const std::vector<std::filesystem::path>& changed) {
+        return std::any_of(changed.begin(), changed.end(), [&sources](const std::filesystem::path& path) {
+            return std::find(sources.begin(), sources.end(), path) != sources.end();
+        });
+    }
+
+    std::vector<std::filesystem::path> application::reloadable_shader_sources() const {
+        auto sources = graphics_shader_sources;
+        const auto add = [&sources](const std::vector<std::filesystem::path>& subsystem_sources) {
+            sources.insert(sources.end(), subsystem_sources.begin(), subsystem_sources.end());
+        };
+        if (particles.enabled()) {
+            add(particles.shader_sources());
+        }
+        if (objects.enabled()) {
+            add(objects.shader_sources());
+        }
+        if (instanced.enabled()) {
+            add(instanced.shader_sources());
+        }
+
+        return sources;
+    }
+
+    void application::poll_shader_reload() {
+        const auto reloadable = reloadable_shader_sources();
+        for (auto& path : shader_changes.poll()) {
+            const bool used = std::find(reloadable.begin(), reloadable.end(), path) != reloadable.end();
+            if (used && std::find(changed_shader_sources.begin(), changed_shader_sources.end(), path) == changed_shader_sources.end()) {
+                changed_shader_sources.emplace_back(std::move(path));
+            }
+        }
+
+        // One stage of the reload at a time, each is picked up at the start of a later frame.
+        // Nothing here waits on the gpu, the old pipelines keep drawing until the new ones are swapped in
+        if (reloading_pipelines) {
+            if (!pipeline_ready(pending_reload_pipeline) || !particles.reload_ready() || !objects.reload_ready() || !instanced.reload_ready()) {
+                return;
+            }
+
+            reloading_pipelines = false;
+            try {
+                swap_reloaded_pipelines();
+                std::cout << fmt::format("Reloaded shaders in {:.2f} ms\n", elapsed_ms(reload_start));
+            } catch (const std::exception& error) {
+                std::cout << fmt::format("Shader reload failed: {}\n", error.what());
+            }
+            return;
+        }
+
+        if (pending_shader_compile.valid()) {
+            if (pending_shader_compile.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                return;
+            }
+            const auto compiled_sources = std::exchange(compiling_shader_sources, {});
+            if (!pending_shader_compile.get()) {
+                std::cout << "Shader compilation failed, keeping the current pipelines\n";
+                return;
+            }
+
+            // Only the pipelines using a recompiled source are rebuilt. Unchanged stages hit the
+            // module cache, only the recompiled ones create modules
+            reloading_pipelines = true;
+            try {
+                if (uses_any(graphics_shader_sources, compiled_sources)) {
+                    reloaded_shader = shader{};
+                    for (const auto& source : graphics_shader_sources) {
+                        reloaded_shader.add_stage(shader_stage_from_path(source), compiled_shader_path(source), shader_cache);
+                    }
+
+                    auto description = graphics_pipeline_info;
+                    description.stages = reloaded_shader.stages();
+                    pending_reload_pipeline = compiler.compile(std::move(description));
+                }
+                if (particles.enabled() && uses_any(particles.shader_sources(), compiled_sources)) {
+                    particles.compile_pipelines(shader_cache, compiler);
+                }
+                if (objects.enabled() && uses_any(objects.shader_sources(), compiled_sources)) {
+                    objects.compile_pipelines(shader_cache, compiler);
+                }
+                if (instanced.enabled() && uses_any(instanced.shader_sources(), compiled_sources)) {
+                    instanced.compile_pipelines(shader_cache, compiler);
+                }
+            } catch (const std::exception& error) {
+                // Whatever started compiling before the failure is still swapped in
+                std::cout << fmt::format("Shader reload failed: {}\n", error.what());
+            }
+            return;
+        }
+
+        if (changed_shader_sources.empty()) {
+            return;
+        }
+
+        // glslc runs as a separate process, a worker just waits for it
+        reload_start = bench_clock::now();
+        compiling_shader_sources = std::exchange(changed_shader_sources, {});
+        pending_shader_compile = workers.submit([sources = compiling_shader_sources, glslc = config.glslc]() {
+            bool compiled = true;
+            for (const auto& source : sources) {
+                compiled &= compile_glsl(source, compiled_shader_path(source), glslc);
+            }
+
+            return compiled;
+        });
+    }
+
+    void application::swap_reloaded_pipelines() {
+        // Frames in flight still reference the old pipelines, they're destroyed once they retire
+        const auto retire_value = graphics_timeline.last_submitted();
+        if (pending_reload_pipeline.valid()) {
+            deletions.retire(retire_value, std::exchange(graphics_pipeline, unique_pipeline(device, pending_reload_pipeline.get())));
+            shader_modules.back() = std::move(reloaded_shader);
+            graphics_pipeline_info.stages = shader_modules.back().stages();
+        }
+        // The last async simulation step may still run the old pipeline, the next frame waits for it
+        particles.swap_pipelines(deletions, async_simulation ? retire_value + 1 : retire_value);
+        objects.swap_pipelines(deletions, retire_value);
+        instanced.swap_pipelines(deletions, retire_value);
+        // Modules of the replaced binaries, the new pipelines were created from their own
+        deletions.retire(retire_value, shader_cache.take_superseded());
+
+        // Prerecorded buffers have the old pipelines baked in, per frame ones pick them up on their own
+        if (config.recording == record_mode::prerecorded) {
+            retire_command_buffers(retire_value);
+            init_command_buffer();
+            record_command_buffers();
+        }
+        ++shader_reloads;
     }
 
     void application::create_framebuffer() {
@@ -521,114 +1521,454 @@ namespace vk_playground {
                 framebuffer_info.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
                 framebuffer_info.renderPass = render_pass;
                 framebuffer_info.attachmentCount = 1;
-                framebuffer_info.pAttachments = &swapchain_image_views[i];
+                framebuffer_info.pAttachments = swapchain_image_views[i].address();
                 framebuffer_info.width = swapchain_info.resolution.width;
                 framebuffer_info.height = swapchain_info.resolution.height;
                 framebuffer_info.layers = 1;
             }
 
-            if (vkCreateFramebuffer(device, &framebuffer_info, nullptr, &swapchain_framebuffers[i]) != VK_SUCCESS) {
+            if (vkCreateFramebuffer(device, &framebuffer_info, nullptr, swapchain_framebuffers[i].put(device)) != VK_SUCCESS) {
                 throw std::runtime_error("Failed to create framebuffer");
             }
         }
+    }
+
+    void application::record_command_buffers() {
+        if (config.recording != record_mode::prerecorded) {
+            return;
+        }
 
+        const auto record_start = bench_clock::now();
+        for (std::uint32_t i = 0; i < swapchain_framebuffers.size(); ++i) {
+            // Every image's buffer writes the same transforms at the same offsets of region 0, so re-recording
+            // while older buffers are in flight rewrites bytes they read with identical values
+            uniforms.begin_frame(0);
+            record_command_buffer(command_buffers[i], i, i % profiler_slots, 0, 1);
+        }
+        prerecord_ms = elapsed_ms(record_start);
+    }
+
+    void application::record_command_buffer(const VkCommandBuffer& command_buffer, std::uint32_t image_index, std::uint32_t profiler_slot, VkCommandBufferUsageFlags usage, std::uint32_t threads) {
         VkCommandBufferBeginInfo cmd_buf_begin_info{}; {
             cmd_buf_begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-            cmd_buf_begin_info.flags = 0;
+            cmd_buf_begin_info.flags = usage;
             cmd_buf_begin_info.pInheritanceInfo = nullptr;
         }
 
-        for (size_t i = 0; i < swapchain_framebuffers.size(); ++i) {
-            vkBeginCommandBuffer(command_buffers[i], &cmd_buf_begin_info);
+        vkBeginCommandBuffer(command_buffer, &cmd_buf_begin_info);
+        profiler.begin_frame(command_buffer, profiler_slot);
+
+        // Until the initial state is uploaded there's nothing to integrate or cull
+        const auto serial_simulation = particles.enabled() && geometry_ready && !async_simulation;
+        const auto gpu_culling = objects.enabled() && geometry_ready && gpu_driven;
+        const auto graph_key = static_cast<std::uint32_t>(serial_simulation) | static_cast<std::uint32_t>(gpu_culling) << 1;
+        if (!frame_graph || graph_key != frame_graph_key) {
+            build_frame_graph(graph_key);
+        }
+
+        recording = { image_index, profiler_slot, threads };
+        frame_graph->bind_image(frame_target, swapchain_images[image_index]);
+        frame_graph->execute(command_buffer);
+
+        vkEndCommandBuffer(command_buffer);
+    }
+
+    void application::build_frame_graph(std::uint32_t key) {
+        // Frames in flight may still use the old graph's transient images
+        if (frame_graph) {
+            deletions.retire(graphics_timeline.last_submitted(), std::move(frame_graph));
+        }
+        frame_graph = std::make_unique<render_graph>();
+        frame_graph_key = key;
+        auto& graph = *frame_graph;
+
+        frame_target = graph.import_image("frame", VK_IMAGE_ASPECT_COLOR_BIT, state_acquired, config.headless ? state_transfer_source : state_present);
+        std::vector<std::pair<graph_resource, resource_state>> main_pass_inputs{};
+
+        // On the async queue the simulation is ordered by semaphores, it's not part of the graph
+        if (key & 1) {
+            const auto particle_buffer = graph.import_buffer("particles", particles.buffer(0));
+            graph.add_pass("simulation", [this](const VkCommandBuffer& command_buffer) {
+                const auto region = profiler.begin_region(command_buffer, recording.profiler_slot, "simulation");
+                particles.record_simulation(command_buffer, 0);
+                profiler.end_region(command_buffer, recording.profiler_slot, region);
+            }).use(particle_buffer, state_compute_read_write);
+            main_pass_inputs.emplace_back(particle_buffer, state_vertex_buffer);
+        }
+
+        if (key & 2) {
+            // Both buffers are cleared before the dispatch fills them
+            constexpr resource_state cull_output{
+                VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT
+            };
+            const auto draw_commands = graph.import_buffer("draw commands", objects.draw_commands());
+            const auto draw_count = graph.import_buffer("draw count", objects.draw_count());
+            graph.add_pass("culling", [this](const VkCommandBuffer& command_buffer) {
+                const auto region = profiler.begin_region(command_buffer, recording.profiler_slot, "culling");
+                objects.record_culling(command_buffer, object_view);
+                profiler.end_region(command_buffer, recording.profiler_slot, region);
+            }).use(draw_commands, cull_output).use(draw_count, cull_output);
+            main_pass_inputs.emplace_back(draw_commands, state_indirect_buffer);
+            main_pass_inputs.emplace_back(draw_count, state_indirect_buffer);
+        }
+
+        auto main_pass = graph.add_pass("main pass", [this](const VkCommandBuffer& command_buffer) {
+            const auto region = profiler.begin_region(command_buffer, recording.profiler_slot, "main pass");
+            record_main_pass(command_buffer);
+            profiler.end_region(command_buffer, recording.profiler_slot, region);
+        });
+        main_pass.use(frame_target, state_color_attachment);
+        for (const auto& [input, state] : main_pass_inputs) {
+            main_pass.use(input, state);
+        }
+
+        graph.compile(device, allocator);
+        if (config.dump_graph) {
+            fmt::print("{}", graph.info().summary());
+        }
+    }
+
+    void application::dump_transient_graph() {
+        // The frame graph only imports resources. This one is compiled for its placement and barriers
+        // and never executed: depth is dead by the time bloom is written, so both can share memory,
+        // while hdr is still read alongside bloom and needs its own. The overlay is never read and culled
+        render_graph graph{};
+        const auto extent = swapchain_info.resolution;
+        const auto frame = graph.import_image("frame", VK_IMAGE_ASPECT_COLOR_BIT, state_acquired, config.headless ? state_transfer_source : state_present);
+        const auto depth = graph.create_image("depth", { VK_FORMAT_D16_UNORM, extent, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT });
+        const auto hdr = graph.create_image("hdr", { VK_FORMAT_R16G16B16A16_SFLOAT, extent, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT });
+        const auto bloom = graph.create_image("bloom", { VK_FORMAT_R16G16B16A16_SFLOAT, extent, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT });
+        const auto overlay = graph.create_image("overlay", { VK_FORMAT_R8G8B8A8_UNORM, extent, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT });
+
+        graph.add_pass("depth prepass", {}).use(depth, state_depth_attachment);
+        graph.add_pass("main pass", {}).use(depth, state_depth_attachment).use(hdr, state_color_attachment);
+        graph.add_pass("bloom", {}).use(hdr, state_fragment_sampled).use(bloom, state_color_attachment);
+        graph.add_pass("overlay", {}).use(overlay, state_color_attachment);
+        graph.add_pass("tonemap", {}).use(hdr, state_fragment_sampled).use(bloom, state_fragment_sampled).use(frame, state_color_attachment);
+        graph.compile(device, allocator);
+
+        const auto& info = graph.info();
+        const auto aliasing = std::count_if(info.barriers.begin(), info.barriers.end(), [](const graph_barrier& barrier) { return barrier.aliasing; });
+        fmt::print("depth and post processing {}{} aliasing barriers, {} KiB saved\n", info.summary(), aliasing, (info.transient_bytes - info.allocated_bytes) / 1024);
+    }
 
-            VkRenderPassBeginInfo render_pass_begin_info{}; {
-                render_pass_begin_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-                render_pass_begin_info.renderPass = render_pass;
-                render_pass_begin_info.framebuffer = swapchain_framebuffers[i];
-                render_pass_begin_info.renderArea.offset = { 0, 0 };
-                render_pass_begin_info.renderArea.extent = swapchain_info.resolution;
-                VkClearValue clear_color{ 0.0f, 0.0f, 0.0f, 1.0f };
-                render_pass_begin_info.clearValueCount = 1;
-                render_pass_begin_info.pClearValues = &clear_color;
+    void application::record_main_pass(const VkCommandBuffer& command_buffer) {
+        const auto image_index = recording.image_index;
+        const auto threads = recording.threads;
 
-                vkCmdBeginRenderPass(command_buffers[i], &render_pass_begin_info, VK_SUBPASS_CONTENTS_INLINE);
-                vkCmdBindPipeline(command_buffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, graphics_pipeline);
-                vkCmdDraw(command_buffers[i], 3, 1, 0, 0);
-                vkCmdEndRenderPass(command_buffers[i]);
+        if (geometry_ready) {
+            build_draw_queue();
+        }
+        // Once for the frame, the recording threads only read the result
+        if (geometry_ready && objects.enabled() && !gpu_driven) {
+            objects.cull_cpu(object_view);
+        }
+        thread_binds.assign(threads, {});
+
+        VkRenderPassBeginInfo render_pass_begin_info{}; {
+            render_pass_begin_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+            render_pass_begin_info.renderPass = render_pass;
+            render_pass_begin_info.framebuffer = swapchain_framebuffers[image_index];
+            render_pass_begin_info.renderArea.offset = { 0, 0 };
+            render_pass_begin_info.renderArea.extent = swapchain_info.resolution;
+            VkClearValue clear_color{ 0.0f, 0.0f, 0.0f, 1.0f };
+            render_pass_begin_info.clearValueCount = 1;
+            render_pass_begin_info.pClearValues = &clear_color;
+
+            if (threads <= 1) {
+                vkCmdBeginRenderPass(command_buffer, &render_pass_begin_info, VK_SUBPASS_CONTENTS_INLINE);
+                record_draws(command_buffer, 0, 1);
+            } else {
+                workers.parallel_for(threads, [this, image_index, threads](std::uint32_t thread) {
+                    record_secondary(image_index, thread, threads);
+                });
+
+                const auto& secondaries = secondary_command_buffers[current_frame];
+                vkCmdBeginRenderPass(command_buffer, &render_pass_begin_info, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+                vkCmdExecuteCommands(command_buffer, threads, secondaries.data());
             }
+            vkCmdEndRenderPass(command_buffer);
+        }
 
-            vkEndCommandBuffer(command_buffers[i]);
+        recorded_binds = {};
+        for (const auto& binds : thread_binds) {
+            recorded_binds += binds;
         }
     }
 
-    void application::draw_frame() {
-        static std::size_t current_frame = 0;
+    void application::build_draw_queue() {
+        const auto build_start = bench_clock::now();
+
+        draw_queue.clear();
+        draw_queue.reserve(std::size_t(draw_count) * model.submeshes.size());
+        for (std::uint32_t i = 0; i < draw_count; ++i) {
+            // Copies are laid out on a grid and don't overlap, their index stands in for depth. Depth ranks
+            // above the material, so a copy's submeshes stay together behind its one uniform bind
+            const auto uniform_offset = uniforms.push(grid_placement(i, draw_count));
+            for (std::uint32_t j = 0; j < model.submeshes.size(); ++j) {
+                const auto& submesh = model.submeshes[j];
+                draw_queue.push(sort_key::make(0, 0, j, i), submesh.index_count, submesh.first_index, submesh.vertex_offset, uniform_offset);
+            }
+        }
+        draw_queue.sort();
+
+        current_timing.sort_ms = elapsed_ms(build_start);
+    }
 
-        vkWaitForFences(device, 1, &frames_in_flight[current_frame], true, UINT64_MAX);
+    void application::record_secondary(std::uint32_t image_index, std::uint32_t thread, std::uint32_t threads) {
+        // Each recording thread owns its pool for this frame, no synchronization needed
+        vkResetCommandPool(device, secondary_command_pools[current_frame][thread], 0);
+        const auto& command_buffer = secondary_command_buffers[current_frame][thread];
 
-        std::uint32_t image_index{};
-        vkAcquireNextImageKHR(device, swapchain, UINT64_MAX, image_available[current_frame], nullptr, &image_index);
+        VkCommandBufferInheritanceInfo inheritance_info{}; {
+            inheritance_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+            inheritance_info.renderPass = render_pass;
+            inheritance_info.subpass = 0;
+            inheritance_info.framebuffer = swapchain_framebuffers[image_index];
+        }
 
-        if (images_in_flight[image_index] != nullptr) {
-            vkWaitForFences(device, 1, &images_in_flight[image_index], true, UINT64_MAX);
+        VkCommandBufferBeginInfo cmd_buf_begin_info{}; {
+            cmd_buf_begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+            cmd_buf_begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+            cmd_buf_begin_info.pInheritanceInfo = &inheritance_info;
         }
 
-        images_in_flight[image_index] = frames_in_flight[current_frame];
+        vkBeginCommandBuffer(command_buffer, &cmd_buf_begin_info);
+        record_draws(command_buffer, thread, threads);
+        vkEndCommandBuffer(command_buffer);
+    }
 
-        constexpr VkPipelineStageFlags pipeline_stage_flags = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    // Splits [0, count) evenly over threads, returns this thread's first and one past its last
+    static std::pair<std::uint32_t, std::uint32_t> thread_range(std::uint32_t count, std::uint32_t thread, std::uint32_t threads) {
+        return { static_cast<std::uint32_t>(std::uint64_t(count) * thread / threads),
+                 static_cast<std::uint32_t>(std::uint64_t(count) * (thread + 1) / threads) };
+    }
 
-        VkSubmitInfo submit_info{}; {
-            submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-            submit_info.commandBufferCount = 1;
-            submit_info.pCommandBuffers = &command_buffers[image_index];
-            submit_info.signalSemaphoreCount = 1;
-            submit_info.pSignalSemaphores = &render_finish[current_frame];
-            submit_info.waitSemaphoreCount = 1;
-            submit_info.pWaitSemaphores = &image_available[current_frame];
-            submit_info.pWaitDstStageMask = &pipeline_stage_flags;
+    void application::record_draws(const VkCommandBuffer& command_buffer, std::uint32_t thread, std::uint32_t threads) {
+        // Secondaries don't inherit pipeline or dynamic state, every command buffer sets its own
+        VkViewport viewport{}; {
+            viewport.x = 0.0f;
+            viewport.y = 0.0f;
+            viewport.width = static_cast<float>(swapchain_info.resolution.width);
+            viewport.height = static_cast<float>(swapchain_info.resolution.height);
+            viewport.minDepth = 0.0f;
+            viewport.maxDepth = 1.0f;
         }
 
-        vkResetFences(device, 1, &frames_in_flight[current_frame]);
+        VkRect2D scissor{}; {
+            scissor.extent = swapchain_info.resolution;
+            scissor.offset = { 0, 0 };
+        }
 
-        if (vkQueueSubmit(queue_handle, 1, &submit_info, frames_in_flight[current_frame]) != VK_SUCCESS) {
-            throw std::runtime_error("Failed to submit command buffer");
+        if (!geometry_ready) {
+            return;
+        }
+
+        // Every pipeline here has viewport and scissor dynamic, set once for all of them
+        vkCmdSetViewport(command_buffer, 0, 1, &viewport);
+        vkCmdSetScissor(command_buffer, 0, 1, &scissor);
+
+        // Single draws go to the first thread
+        if (thread == 0 && particles.enabled()) {
+            particles.record_draw(command_buffer, particle_step);
+        }
+        if (thread == 0 && instanced.enabled()) {
+            instanced.record_draw(command_buffer, static_cast<std::uint32_t>(current_frame));
+        }
+
+        // Pipelines, materials and uniforms are bound by the queue as its keys change
+        const auto [first, last] = thread_range(draw_queue.size(), thread, threads);
+        constexpr VkDeviceSize vertex_offset = 0;
+        vkCmdBindVertexBuffers(command_buffer, 0, 1, &model.buffers.vertices.buffer, &vertex_offset);
+        vkCmdBindIndexBuffer(command_buffer, model.buffers.indices.buffer, 0, vk_index_type);
+        const VkPipeline pipelines[] = { graphics_pipeline };
+        thread_binds[thread] = draw_queue.record(command_buffer, { pipelines, &bindless, material_slot, &uniforms, 1 }, first, last);
+
+        if (!objects.enabled()) {
+            return;
+        }
+        if (gpu_driven) {
+            if (thread == 0) {
+                objects.record_indirect_draw(command_buffer, object_view);
+            }
+        } else {
+            const auto [first_object, last_object] = thread_range(objects.size(), thread, threads);
+            objects.record_cpu_draws(command_buffer, object_view, first_object, last_object - first_object);
+        }
+    }
+
+    void application::collect_input_latency(std::size_t frame) {
+        if (input_latency_pending[frame]) {
+            current_timing.input_latency_ms.emplace_back(elapsed_ms(frame_input_times[frame]));
+            input_latency_pending[frame] = false;
+        }
+    }
+
+    bool application::draw_frame() {
+        static std::uint32_t offscreen_index = 0;
+
+        // One query tells how far the gpu got, the frame slot, retired swapchains and
+        // latency tracking below all compare against it
+        const auto completed = graphics_timeline.poll();
+        current_timing.queue_depth = static_cast<double>(graphics_timeline.last_submitted() - completed);
+
+        // Core vulkan doesn't say when an image reaches the display, gpu completion of the frame is
+        // the closest observable point. Already completed frames are only noticed here, once per frame
+        for (std::size_t frame = 0; frame < max_frames_in_flight; ++frame) {
+            if (frame_values[frame] <= completed) {
+                collect_input_latency(frame);
+            }
+        }
+
+        auto wait_start = bench_clock::now();
+        graphics_timeline.wait(frame_values[current_frame]);
+        current_timing.fence_wait_ms += elapsed_ms(wait_start);
+        collect_input_latency(current_frame);
+        deletions.collect(graphics_timeline.completed());
+
+        std::uint32_t image_index{};
+        if (config.headless) {
+            image_index = offscreen_index;
+            offscreen_index = (offscreen_index + 1) % swapchain_info.image_count;
+        } else {
+            wait_start = bench_clock::now();
+            const auto result = vkAcquireNextImageKHR(device, swapchain, UINT64_MAX, image_available[current_frame], nullptr, &image_index);
+            current_timing.acquire_wait_ms += elapsed_ms(wait_start);
+
+            // Nothing was acquired and the semaphore stays unsignaled, try again next frame.
+            // Suboptimal still hands out an image, it's recreated after presenting it
+            if (result == VK_ERROR_OUT_OF_DATE_KHR) {
+                recreate_swapchain();
+                return false;
+            }
+            if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
+                throw std::runtime_error("Failed to acquire swapchain image");
+            }
+        }
+
+        // Usually already satisfied by the frame slot wait, then this doesn't call into the driver
+        wait_start = bench_clock::now();
+        graphics_timeline.wait(image_values[image_index]);
+        current_timing.fence_wait_ms += elapsed_ms(wait_start);
+
+        // Prerecorded buffers are tied to their image, per frame ones to the frame slot.
+        // Either way the previous submission using that slot has retired and its timestamps are ready
+        const bool per_frame = config.recording == record_mode::per_frame;
+        const auto profiler_slot = per_frame ? static_cast<std::uint32_t>(current_frame) : image_index % profiler_slots;
+        if (profiler.collect(profiler_slot)) {
+            current_timing.gpu_regions = profiler.results();
+        }
+
+        // The frame slot was waited on above, everything allocated from its pool is free to go
+        vkResetCommandPool(device, frame_command_pools[current_frame], 0);
+        // Same for its uniform region. Prerecorded buffers own theirs for good
+        if (per_frame) {
+            uniforms.begin_frame(static_cast<std::uint32_t>(current_frame));
+        }
+        // Fixed time step like the particles, benchmark runs animate the same every time
+        if (instanced.enabled()) {
+            const auto update_start = bench_clock::now();
+            instanced.update(static_cast<std::uint32_t>(current_frame), frames_drawn / 60.0);
+            current_timing.update_ms = elapsed_ms(update_start);
+        }
+        object_view = orbiting_view(frames_drawn++);
+        const auto signal_value = graphics_timeline.next();
+
+        std::vector<VkCommandBuffer> submitted{};
+        std::vector<semaphore_wait> waits{};
+        if (record_uploads(signal_value, waits)) {
+            submitted.emplace_back(upload_command_buffers[current_frame]);
+        }
+        // The frame draws what the last simulation step wrote
+        if (async_simulation && particle_compute_value != 0) {
+            waits.push_back({ compute.semaphore().handle(), particle_compute_value, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT });
+        }
+
+        if (per_frame) {
+            const auto record_start = bench_clock::now();
+            record_command_buffer(frame_command_buffers[current_frame], image_index, profiler_slot, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT, config.record_threads);
+            current_timing.record_ms = elapsed_ms(record_start);
+
+            submitted.emplace_back(frame_command_buffers[current_frame]);
+        } else {
+            submitted.emplace_back(command_buffers[image_index]);
+        }
+        // Prerecorded buffers all bind the same, the last recording speaks for them
+        current_timing.binds = recorded_binds;
+
+        submit_graphics(submitted, signal_value, waits, !config.headless);
+        frame_values[current_frame] = signal_value;
+        image_values[image_index] = signal_value;
+        profiler.mark_submitted(profiler_slot);
+        if (async_simulation && geometry_ready) {
+            submit_simulation(signal_value);
+        }
+        frame_input_times[current_frame] = input_time;
+        input_latency_pending[current_frame] = true;
+
+        if (config.headless) {
+            current_frame = (current_frame + 1) % max_frames_in_flight;
+            return true;
         }
 
         VkPresentInfoKHR present_info{}; {
             present_info.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
             present_info.waitSemaphoreCount = 1;
-            present_info.pWaitSemaphores = &render_finish[current_frame];
+            present_info.pWaitSemaphores = render_finish[current_frame].address();
             present_info.pImageIndices = &image_index;
-            present_info.pSwapchains = &swapchain;
+            present_info.pSwapchains = swapchain.address();
             present_info.swapchainCount = 1;
         }
 
-        vkQueuePresentKHR(queue_handle, &present_info);
+        const auto result = vkQueuePresentKHR(queue_handle, &present_info);
         current_frame = (current_frame + 1) % max_frames_in_flight;
+
+        if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || framebuffer_resized) {
+            recreate_swapchain();
+        } else if (result != VK_SUCCESS) {
+            throw std::runtime_error("Failed to present swapchain image");
+        }
+
+        return true;
+    }
+
+    void application::init_profiler() {
+        create_graphics_profiler();
+        if (async_simulation) {
+            compute_profiler.create(device, max_frames_in_flight, 1,
+                                    device_properties.limits.timestampPeriod, queue_families[compute_family].timestampValidBits);
+        }
+    }
+
+    void application::create_graphics_profiler() {
+        const auto& graphics_family = queue_families[get_graphics_queue_index()];
+
+        // Prerecorded buffers index slots by image, recreate_swapchain() calls this again when the image count changes
+        profiler_slots = config.recording == record_mode::per_frame ? max_frames_in_flight : swapchain_info.image_count;
+        profiler.create(device, profiler_slots, max_profiler_regions,
+                        device_properties.limits.timestampPeriod, graphics_family.timestampValidBits);
     }
 
     void application::create_semaphores() {
-        image_available.resize(max_frames_in_flight, {});
-        render_finish.resize(max_frames_in_flight, {});
-        frames_in_flight.resize(max_frames_in_flight, {});
-        images_in_flight.resize(swapchain_info.image_count, {});
+        image_available.resize(max_frames_in_flight);
+        render_finish.resize(max_frames_in_flight);
+        frame_values.resize(max_frames_in_flight, 0);
+        image_values.resize(swapchain_info.image_count, 0);
+        frame_input_times.resize(max_frames_in_flight, {});
+        input_latency_pending.resize(max_frames_in_flight, false);
 
         VkSemaphoreCreateInfo semaphore_create_info{}; {
             semaphore_create_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
         }
 
-        VkFenceCreateInfo fence_create_info{}; {
-            fence_create_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-            fence_create_info.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-        }
-
-        for (int i = 0; i < max_frames_in_flight; ++i) {
-            if (vkCreateSemaphore(device, &semaphore_create_info, nullptr, &image_available[i]) != VK_SUCCESS ||
-                vkCreateSemaphore(device, &semaphore_create_info, nullptr, &render_finish[i]) != VK_SUCCESS ||
-                vkCreateFence(device, &fence_create_info, nullptr, &frames_in_flight[i]) != VK_SUCCESS ||
-                vkCreateFence(device, &fence_create_info, nullptr, &images_in_flight[i]) != VK_SUCCESS) {
-                throw std::runtime_error("Failed to create semaphores and fences");
+        for (std::uint32_t i = 0; i < max_frames_in_flight; ++i) {
+            if (vkCreateSemaphore(device, &semaphore_create_info, nullptr, image_available[i].put(device)) != VK_SUCCESS ||
+                vkCreateSemaphore(device, &semaphore_create_info, nullptr, render_finish[i].put(device)) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to create semaphores");
             }
         }
+
+        graphics_timeline.create(device, has_core_timeline_semaphore());
     }
 } // namespace vk_playground
\ No newline at end of file
@@ -0,0 +1,572 @@
+#include "benchmarks.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include <frame_stats.hpp>
+#include <memory_allocator.hpp>
+#include <object_culler.hpp>
+#include <render_queue.hpp>
+#include <scene_store.hpp>
+#include <suballocator.hpp>
+#include <uniform_ring.hpp>
+#include <vk_handle.hpp>
+
+namespace vk_playground {
+    void emit_json(const std::string& path, const std::string& json) {
+        if (path.empty()) {
+            std::cout << json << std::endl;
+            return;
+        }
+
+        std::ofstream output(path);
+        if (!output.is_open()) {
+            throw std::runtime_error("Error, can't open " + path + " for writing");
+        }
+        output << json << '\n';
+    }
+
+    std::string json_escape(std::string_view text) {
+        std::string escaped{};
+        escaped.reserve(text.size());
+        for (const char character : text) {
+            switch (character) {
+                case '"': escaped += "\\\""; break;
+                case '\\': escaped += "\\\\"; break;
+                case '\n': escaped += "\\n"; break;
+                case '\r': escaped += "\\r"; break;
+                case '\t': escaped += "\\t"; break;
+                default:
+                    // Remaining control characters have no short escape
+                    if (static_cast<unsigned char>(character) < 0x20) {
+                        escaped += fmt::format("\\u{:04x}", static_cast<unsigned char>(character));
+                    } else {
+                        escaped += character;
+                    }
+            }
+        }
+
+        return escaped;
+    }
+
+    struct churn_request {
+        VkDeviceSize size;
+        VkDeviceSize alignment;
+    };
+
+    // Same sequence for every allocator: fill, free every other allocation, refill, free everything
+    template <typename Allocate, typename Free>
+    static double churn(const std::vector<churn_request>& requests, Allocate&& allocate, Free&& free) {
+        using handle_type = decltype(allocate(requests.front()));
+        std::vector<handle_type> live{};
+        live.reserve(requests.size());
+
+        const auto start = bench_clock::now();
+
+        for (const auto& request : requests) {
+            live.emplace_back(allocate(request));
+        }
+        for (std::size_t i = 0; i < live.size(); i += 2) {
+            free(live[i]);
+        }
+        for (std::size_t i = 0; i < live.size(); i += 2) {
+            live[i] = allocate(requests[i]);
+        }
+        for (const auto& handle : live) {
+            free(handle);
+        }
+
+        // 1.5 allocations + 1.5 frees per request: every request once, the even half again. Time per operation
+        return elapsed_ms(start) * 1e6 / (requests.size() * 3);
+    }
+
+    void run_allocator_benchmark(const VkDevice& device, memory_allocator& allocator, std::uint32_t operations, const std::string& json_path) {
+        std::mt19937 generator{ 42 };
+        std::uniform_int_distribution<VkDeviceSize> sizes{ 256, 64 * 1024 };
+
+        std::vector<churn_request> requests(operations);
+        for (auto& request : requests) {
+            request = { sizes(generator), 256 };
+        }
+
+        tlsf_allocator tlsf{ VkDeviceSize(1) << 40 };
+        const auto tlsf_ns = churn(requests,
+            [&](const churn_request& request) { return tlsf.allocate(request.size, request.alignment)->handle; },
+            [&](std::uint32_t handle) { tlsf.free(handle); });
+
+        // Mid-churn statistics, half of the allocations freed in a checkerboard pattern
+        std::vector<allocation> live{};
+        for (const auto& request : requests) {
+            live.emplace_back(allocator.allocate({ request.size, request.alignment, ~0u }, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0, resource_kind::linear));
+        }
+        for (std::size_t i = 0; i < live.size(); i += 2) {
+            allocator.free(live[i]);
+        }
+        const auto fragmented = allocator.statistics();
+        for (std::size_t i = 1; i < live.size(); i += 2) {
+            allocator.free(live[i]);
+        }
+
+        const auto device_ns = churn(requests,
+            [&](const churn_request& request) {
+                return allocator.allocate({ request.size, request.alignment, ~0u }, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0, resource_kind::linear);
+            },
+            [&](const allocation& memory) { allocator.free(memory); });
+
+        // Plain vkAllocateMemory per resource, capped well below maxMemoryAllocationCount
+        std::vector<churn_request> naive_requests(requests.begin(), requests.begin() + std::min<std::size_t>(requests.size(), 1024));
+        const auto memory_type = allocator.find_memory_type(~0u, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        const auto naive_ns = churn(naive_requests,
+            [&](const churn_request& request) {
+                VkMemoryAllocateInfo allocate_info{}; {
+                    allocate_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+                    allocate_info.allocationSize = request.size;
+                    allocate_info.memoryTypeIndex = memory_type;
+                }
+
+                VkDeviceMemory memory{};
+                if (vkAllocateMemory(device, &allocate_info, nullptr, &memory) != VK_SUCCESS) {
+                    throw std::runtime_error("Failed to allocate device memory");
+                }
+                return memory;
+            },
+            [&](VkDeviceMemory memory) { vkFreeMemory(device, memory, nullptr); });
+
+        std::cout << fmt::format("Allocator benchmark, {} requests of 256 B - 64 KiB:\n", operations);
+        std::cout << fmt::format("{:<24}{:>12.1f} ns/op\n", "tlsf (metadata only)", tlsf_ns);
+        std::cout << fmt::format("{:<24}{:>12.1f} ns/op\n", "memory_allocator", device_ns);
+        std::cout << fmt::format("{:<24}{:>12.1f} ns/op ({} requests)\n", "vkAllocateMemory", naive_ns, naive_requests.size());
+        std::cout << fmt::format("after freeing every other allocation: {} blocks, {:.1f} MiB reserved, {:.1f} MiB used, "
+                                 "{} free regions, largest {:.1f} KiB, fragmentation {:.3f}\n",
+                                 fragmented.device_allocations,
+                                 fragmented.reserved_bytes / (1024.0 * 1024.0),
+                                 fragmented.used_bytes / (1024.0 * 1024.0),
+                                 fragmented.free_regions,
+                                 fragmented.largest_free_region / 1024.0,
+                                 fragmented.fragmentation);
+
+        emit_json(json_path, fmt::format(
+            R"({{ "requests": {}, "tlsf_ns": {:.3f}, "memory_allocator_ns": {:.3f}, "vk_allocate_memory_ns": {:.3f}, )"
+            R"("fragmented": {{ "device_allocations": {}, "reserved_bytes": {}, "used_bytes": {}, "free_regions": {}, )"
+            R"("largest_free_region": {}, "fragmentation": {:.6f} }} }})",
+            operations, tlsf_ns, device_ns, naive_ns,
+            fragmented.device_allocations, fragmented.reserved_bytes, fragmented.used_bytes,
+            fragmented.free_regions, fragmented.largest_free_region, fragmented.fragmentation));
+    }
+
+    // Typical per draw block, a transform and material parameters
+    struct object_uniforms {
+        float transform[4];
+        float tint[4];
+    };
+
+    static unique_pipeline_layout uniform_pipeline_layout(const VkDevice& device, VkDescriptorSetLayout set_layout) {
+        VkPipelineLayoutCreateInfo layout_info{}; {
+            layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+            layout_info.setLayoutCount = 1;
+            layout_info.pSetLayouts = &set_layout;
+        }
+
+        unique_pipeline_layout layout{};
+        if (vkCreatePipelineLayout(device, &layout_info, nullptr, layout.put(device)) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create benchmark pipeline layout");
+        }
+        return layout;
+    }
+
+    void run_uniform_benchmark(const VkDevice& device, memory_allocator& allocator, const VkPhysicalDeviceLimits& limits, std::uint32_t queue_family,
+                               std::uint32_t objects, const std::string& json_path) {
+        constexpr std::uint32_t warmup_frames = 5;
+        constexpr std::uint32_t measured_frames = 50;
+
+        // Recorded but never submitted, only the cpu side is measured
+        VkCommandPoolCreateInfo pool_info{}; {
+            pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+            pool_info.queueFamilyIndex = queue_family;
+        }
+
+        unique_command_pool command_pool{};
+        if (vkCreateCommandPool(device, &pool_info, nullptr, command_pool.put(device)) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create benchmark command pool");
+        }
+
+        VkCommandBufferAllocateInfo command_buffer_info{}; {
+            command_buffer_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+            command_buffer_info.commandPool = command_pool;
+            command_buffer_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+            command_buffer_info.commandBufferCount = 1;
+        }
+
+        VkCommandBuffer command_buffer{};
+        if (vkAllocateCommandBuffers(device, &command_buffer_info, &command_buffer) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to allocate benchmark command buffer");
+        }
+
+        VkCommandBufferBeginInfo begin_info{}; {
+            begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+            begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        }
+
+        const auto object_value = [](std::uint32_t object, std::uint32_t frame) {
+            const auto angle = static_cast<float>(frame) * 0.01f;
+            return object_uniforms{ { static_cast<float>(object), 0.0f, 1.0f, angle }, { 1.0f, 1.0f, 1.0f, 1.0f } };
+        };
+
+        // Same frame loop for both paths, update returns the dynamic offset for the object's bind
+        const auto measure = [&](auto&& begin_frame, auto&& update, auto&& bind) {
+            double allocate_ms = 0.0;
+            double record_ms = 0.0;
+            for (std::uint32_t frame = 0; frame < warmup_frames + measured_frames; ++frame) {
+                // Updates alone, then updates with the binds they feed
+                auto start = bench_clock::now();
+                begin_frame();
+                for (std::uint32_t object = 0; object < objects; ++object) {
+                    update(object, frame);
+                }
+                const auto frame_allocate_ms = elapsed_ms(start);
+
+                vkResetCommandPool(device, command_pool, 0);
+                start = bench_clock::now();
+                begin_frame();
+                vkBeginCommandBuffer(command_buffer, &begin_info);
+                for (std::uint32_t object = 0; object < objects; ++object) {
+                    bind(object, update(object, frame));
+                }
+                vkEndCommandBuffer(command_buffer);
+                const auto frame_record_ms = elapsed_ms(start);
+
+                if (frame >= warmup_frames) {
+                    allocate_ms += frame_allocate_ms;
+                    record_ms += frame_record_ms;
+                }
+            }
+
+            const auto updates = double(objects) * measured_frames;
+            return std::pair{ updates / (allocate_ms * 1e-3), record_ms * 1e6 / updates };
+        };
+
+        // One ring region is enough, nothing is submitted
+        auto start = bench_clock::now();
+        uniform_ring ring{};
+        ring.create(device, allocator, limits, 1, VkDeviceSize(objects) * std::max<VkDeviceSize>(sizeof(object_uniforms), limits.minUniformBufferOffsetAlignment),
+                    sizeof(object_uniforms));
+        const auto ring_layout = uniform_pipeline_layout(device, ring.descriptor_set_layout());
+        const auto ring_setup_ms = elapsed_ms(start);
+
+        const auto [ring_allocations, ring_draw_ns] = measure(
+            [&]() { ring.begin_frame(0); },
+            [&](std::uint32_t object, std::uint32_t frame) { return ring.push(object_value(object, frame)); },
+            [&](std::uint32_t, std::uint32_t offset) { ring.bind(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, ring_layout, 0, offset); });
+        ring.destroy();
+
+        // A buffer, descriptor set and descriptor write per object, allocated up front and rewritten in place
+        start = bench_clock::now();
+        VkDescriptorSetLayoutBinding binding{}; {
+            binding.binding = 0;
+            binding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+            binding.descriptorCount = 1;
+            binding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+        }
+
+        VkDescriptorSetLayoutCreateInfo set_layout_info{}; {
+            set_layout_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+            set_layout_info.bindingCount = 1;
+            set_layout_info.pBindings = &binding;
+        }
+
+        unique_descriptor_set_layout set_layout{};
+        if (vkCreateDescriptorSetLayout(device, &set_layout_info, nullptr, set_layout.put(device)) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create benchmark descriptor set layout");
+        }
+        const auto object_layout = uniform_pipeline_layout(device, set_layout);
+
+        VkDescriptorPoolSize pool_size{}; {
+            pool_size.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+            pool_size.descriptorCount = objects;
+        }
+
+        VkDescriptorPoolCreateInfo descriptor_pool_info{}; {
+            descriptor_pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+            descriptor_pool_info.maxSets = objects;
+            descriptor_pool_info.poolSizeCount = 1;
+            descriptor_pool_info.pPoolSizes = &pool_size;
+        }
+
+        unique_descriptor_pool descriptor_pool{};
+        if (vkCreateDescriptorPool(device, &descriptor_pool_info, nullptr, descriptor_pool.put(device)) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create benchmark descriptor pool");
+        }
+
+        VkBufferCreateInfo buffer_info{}; {
+            buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+            buffer_info.size = sizeof(object_uniforms);
+            buffer_info.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+            buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        }
+
+        VkDescriptorSetAllocateInfo set_info{}; {
+            set_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+            set_info.descriptorPool = descriptor_pool;
+            set_info.descriptorSetCount = 1;
+            set_info.pSetLayouts = set_layout.address();
+        }
+
+        std::vector<buffer_allocation> buffers(objects);
+        std::vector<VkDescriptorSet> sets(objects);
+        for (std::uint32_t object = 0; object < objects; ++object) {
+            buffers[object] = allocator.create_buffer(buffer_info, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+            if (vkAllocateDescriptorSets(device, &set_info, &sets[object]) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to allocate benchmark descriptor set");
+            }
+
+            VkDescriptorBufferInfo descriptor_buffer{}; {
+                descriptor_buffer.buffer = buffers[object].buffer;
+                descriptor_buffer.offset = 0;
+                descriptor_buffer.range = sizeof(object_uniforms);
+            }
+
+            VkWriteDescriptorSet write{}; {
+                write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                write.dstSet = sets[object];
+                write.dstBinding = 0;
+                write.descriptorCount = 1;
+                write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+                write.pBufferInfo = &descriptor_buffer;
+            }
+
+            vkUpdateDescriptorSets(device, 1, &write, 0, nullptr);
+        }
+        const auto object_setup_ms = elapsed_ms(start);
+        const auto object_allocations = objects / (object_setup_ms * 1e-3);
+
+        // Rewriting in place only works because nothing is in flight, a real frame would need a copy per frame in flight
+        const auto [object_updates, object_draw_ns] = measure(
+            []() {},
+            [&](std::uint32_t object, std::uint32_t frame) {
+                const auto value = object_value(object, frame);
+                std::memcpy(buffers[object].memory.mapped, &value, sizeof(value));
+                return 0u;
+            },
+            [&](std::uint32_t object, std::uint32_t) {
+                vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, object_layout, 0, 1, &sets[object], 0, nullptr);
+            });
+
+        for (const auto& buffer : buffers) {
+            allocator.destroy_buffer(buffer);
+        }
+
+        std::cout << fmt::format("Per object uniforms, {} objects of {} B ({} frames, {} B offset alignment):\n",
+                                 objects, sizeof(object_uniforms), measured_frames, limits.minUniformBufferOffsetAlignment);
+        std::cout << fmt::format("{:<16}{:>12}{:>16}{:>16}{:>12}\n", "path", "setup ms", "allocations/s", "updates/s", "ns/draw");
+        std::cout << fmt::format("{:<16}{:>12.3f}{:>16.3g}{:>16.3g}{:>12.1f}\n", "uniform ring", ring_setup_ms, ring_allocations, ring_allocations, ring_draw_ns);
+        std::cout << fmt::format("{:<16}{:>12.3f}{:>16.3g}{:>16.3g}{:>12.1f}\n", "buffer/object", object_setup_ms, object_allocations, object_updates, object_draw_ns);
+
+        emit_json(json_path, fmt::format(
+            R"({{ "objects": {}, "uniform_bytes": {}, "offset_alignment": {}, )"
+            R"("uniform_ring": {{ "setup_ms": {:.6f}, "allocations_per_s": {:.1f}, "draw_ns": {:.3f} }}, )"
+            R"("buffer_per_object": {{ "setup_ms": {:.6f}, "allocations_per_s": {:.1f}, "updates_per_s": {:.1f}, "draw_ns": {:.3f} }} }})",
+            objects, sizeof(object_uniforms), limits.minUniformBufferOffsetAlignment,
+            ring_setup_ms, ring_allocations, ring_draw_ns,
+            object_setup_ms, object_allocations, object_updates, object_draw_ns));
+    }
+
+    void run_sort_benchmark(std::uint32_t draws, const std::string& json_path) {
+        constexpr std::uint32_t warmup_iterations = 3;
+        constexpr std::uint32_t measured_iterations = 20;
+        constexpr std::uint32_t pipelines = 16;
+        constexpr std::uint32_t materials = 1024;
+
+        struct key_set {
+            const char* name;
+            // Bits of depth in use, the rest of the field stays zero
+            std::uint32_t depth_bits;
+        };
+        constexpr key_set key_sets[] = { { "state only", 0 }, { "16 bit depth", 16 }, { "32 bit depth", 32 } };
+
+        std::mt19937 generator{ 42 };
+        std::uniform_int_distribution<std::uint32_t> pipeline_values{ 0, pipelines - 1 };
+        std::uniform_int_distribution<std::uint32_t> material_values{ 0, materials - 1 };
+        std::uniform_int_distribution<std::uint32_t> depth_values{};
+
+        std::cout << fmt::format("Sorting {} draw keys, {} pipelines, {} materials (ms, {} iterations):\n", draws, pipelines, materials, measured_iterations);
+        std::cout << fmt::format("{:<16}{:>12}{:>12}{:>14}\n", "keys", "radix", "std::sort", "Mdraws/s");
+
+        std::string json_rows{};
+        render_queue queue{};
+        queue.reserve(draws);
+        for (const auto& [name, depth_bits] : key_sets) {
+            std::vector<std::uint64_t> keys(draws);
+            for (auto& key : keys) {
+                const auto depth = depth_bits == 0 ? 0 : depth_values(generator) >> (32 - depth_bits);
+                key = sort_key::make(0, pipeline_values(generator), material_values(generator), depth);
+            }
+
+            // Same keys through both, the queue's arrays are rebuilt every iteration like a frame would
+            double radix_ms = 0.0;
+            double reference_ms = 0.0;
+            std::vector<std::pair<std::uint64_t, std::uint32_t>> pairs(draws);
+            for (std::uint32_t i = 0; i < warmup_iterations + measured_iterations; ++i) {
+                queue.clear();
+                for (std::uint32_t draw = 0; draw < draws; ++draw) {
+                    queue.push(keys[draw], 0, 0, 0, 0);
+                }
+                auto start = bench_clock::now();
+                queue.sort();
+                const auto iteration_radix_ms = elapsed_ms(start);
+
+                for (std::uint32_t draw = 0; draw < draws; ++draw) {
+                    pairs[draw] = { keys[draw], draw };
+                }
+                start = bench_clock::now();
+                std::sort(pairs.begin(), pairs.end());
+                const auto iteration_reference_ms = elapsed_ms(start);
+
+                if (i >= warmup_iterations) {
+                    radix_ms += iteration_radix_ms;
+                    reference_ms += iteration_reference_ms;
+                }
+            }
+            radix_ms /= measured_iterations;
+            reference_ms /= measured_iterations;
+
+            for (std::uint32_t draw = 0; draw < draws; ++draw) {
+                if (queue.key(draw) != pairs[draw].first) {
+                    throw std::runtime_error("Error, render queue sort disagrees with std::sort");
+                }
+            }
+
+            std::cout << fmt::format("{:<16}{:>12.3f}{:>12.3f}{:>14.1f}\n", name, radix_ms, reference_ms, draws / (radix_ms * 1e3));
+            json_rows += fmt::format(R"({}{{ "keys": "{}", "radix_ms": {:.6f}, "std_sort_ms": {:.6f} }})",
+                                     json_rows.empty() ? "" : ", ", name, radix_ms, reference_ms);
+        }
+
+        // The application's queue: copies of a model, each with its own uniform offset and a material per submesh.
+        // Material first was the original key order, it rebinds the uniforms on every draw
+        constexpr std::uint32_t submeshes = 8;
+        const auto copies = std::max(draws / submeshes, 1u);
+        struct key_order {
+            const char* name;
+            bool material_first;
+        };
+        constexpr key_order key_orders[] = { { "material first", true }, { "copy first", false } };
+
+        std::cout << fmt::format("\nBinds recording {} copies of {} submeshes:\n", copies, submeshes);
+        std::cout << fmt::format("{:<16}{:>12}{:>12}{:>12}{:>12}\n", "order", "draws", "pipeline", "material", "uniform");
+
+        std::string json_binds{};
+        for (const auto& [name, material_first] : key_orders) {
+            queue.clear();
+            for (std::uint32_t i = 0; i < copies; ++i) {
+                for (std::uint32_t j = 0; j < submeshes; ++j) {
+                    // Depth ranks above the material, putting the submesh there sorts by material first
+                    queue.push(sort_key::make(0, 0, j, material_first ? j : i), 0, 0, 0, i);
+                }
+            }
+            queue.sort();
+
+            const auto binds = queue.count_binds(0, queue.size());
+            std::cout << fmt::format("{:<16}{:>12}{:>12}{:>12}{:>12}\n", name, binds.draws, binds.pipelines, binds.materials, binds.uniforms);
+            json_binds += fmt::format(R"({}{{ "order": "{}", "draws": {}, "pipelines": {}, "materials": {}, "uniforms": {} }})",
+                                      json_binds.empty() ? "" : ", ", name, binds.draws, binds.pipelines, binds.materials, binds.uniforms);
+        }
+
+        emit_json(json_path, fmt::format(R"({{ "draws": {}, "pipelines": {}, "materials": {}, "sort": [ {} ], "binds": [ {} ] }})",
+                                         draws, pipelines, materials, json_rows, json_binds));
+    }
+
+    // Three levels: a quarter of the objects are roots, a quarter their children and the rest grandchildren,
+    // spread over the same field object_culler uses
+    static void fill_scene(scene_store& scene, std::uint32_t count) {
+        std::mt19937 generator{ 42 };
+        std::uniform_real_distribution<float> position{ -3.0f, 3.0f };
+        std::uniform_real_distribution<float> offset{ -2.0f, 2.0f };
+        std::uniform_real_distribution<float> scale{ 0.5f, 1.0f };
+
+        scene.clear();
+        scene.reserve(count);
+        const std::uint32_t level_ends[] = { count / 4, count / 2, count };
+        std::uint32_t parents_first = 0;
+        for (std::uint32_t level = 0; level < std::size(level_ends); ++level) {
+            const auto first = scene.size();
+            std::uniform_int_distribution<std::uint32_t> parent{ parents_first, std::max(first, 1u) - 1 };
+            for (auto i = first; i < level_ends[level]; ++i) {
+                if (level == 0) {
+                    scene.add(scene_store::no_parent, { { position(generator), position(generator), 0.0f }, 0.02f * scale(generator) }, 1.0f);
+                } else {
+                    scene.add(parent(generator), { { offset(generator), offset(generator), 0.0f }, scale(generator) }, 1.0f);
+                }
+            }
+            parents_first = first;
+        }
+    }
+
+    void run_scene_benchmark(thread_pool& workers, const std::string& json_path) {
+        constexpr std::uint32_t object_counts[] = { 10'000, 100'000, 1'000'000, 10'000'000 };
+        constexpr cull_kernel kernels[] = { cull_kernel::scalar, cull_kernel::sse, cull_kernel::avx2 };
+
+        std::cout << fmt::format("Scene store, {} threads, best kernel {} (transform update in ms, culling in objects per ms):\n",
+                                 workers.size() + 1, cull_kernel_name(best_cull_kernel()));
+        std::cout << fmt::format("{:>10}{:>12}", "objects", "update");
+        for (const auto kernel : kernels) {
+            std::cout << fmt::format("{:>14}", cull_kernel_name(kernel));
+        }
+        std::cout << '\n';
+
+        std::string json_rows{};
+        scene_store scene{};
+        scene.create(workers);
+        for (const auto count : object_counts) {
+            // About the same total work for every size
+            const auto iterations = std::clamp<std::uint32_t>(100'000'000 / count, 3, 500);
+            fill_scene(scene, count);
+
+            scene.update_transforms();
+            auto start = bench_clock::now();
+            for (std::uint32_t i = 0; i < iterations; ++i) {
+                scene.update_transforms();
+            }
+            const auto update_ms = elapsed_ms(start) / iterations;
+
+            std::cout << fmt::format("{:>10}{:>12.3f}", count, update_ms);
+            std::string kernel_json{};
+            std::uint32_t reference_visible = 0;
+            for (const auto kernel : kernels) {
+                if (!cull_kernel_supported(kernel)) {
+                    std::cout << fmt::format("{:>14}", "-");
+                    continue;
+                }
+                scene.set_kernel(kernel);
+
+                // Every kernel sees the same views and has to agree with the scalar one
+                std::uint32_t visible = 0;
+                start = bench_clock::now();
+                for (std::uint32_t i = 0; i < iterations; ++i) {
+                    visible += scene.cull(view_frustum(orbiting_view(i)));
+                }
+                const auto cull_ms = elapsed_ms(start) / iterations;
+                if (kernel == cull_kernel::scalar) {
+                    reference_visible = visible;
+                } else if (visible != reference_visible) {
+                    throw std::runtime_error(std::string("Error, ") + cull_kernel_name(kernel) + " cull kernel disagrees with the scalar one");
+                }
+
+                const auto objects_per_ms = count / cull_ms;
+                std::cout << fmt::format("{:>14.0f}", objects_per_ms);
+                kernel_json += fmt::format(R"(, "{}_objects_per_ms": {:.1f})", cull_kernel_name(kernel), objects_per_ms);
+            }
+            std::cout << '\n';
+
+            json_rows += fmt::format(R"({}{{ "objects": {}, "update_ms": {:.6f}{} }})", json_rows.empty() ? "" : ", ", count, update_ms, kernel_json);
+        }
+
+        emit_json(json_path, fmt::format(R"({{ "threads": {}, "best_kernel": "{}", "scene": [ {} ] }})",
+                                         workers.size() + 1, cull_kernel_name(best_cull_kernel()), json_rows));
+    }
+} // namespace vk_playground
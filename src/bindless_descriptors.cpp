@@ -0,0 +1,264 @@
+#include "bindless_descriptors.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+
+namespace vk_playground {
+    void descriptor_slot_allocator::create(std::uint32_t capacity) {
+        free_slots.clear();
+        next = 0;
+        slot_count = capacity;
+    }
+
+    std::uint32_t descriptor_slot_allocator::allocate() {
+        if (!free_slots.empty()) {
+            const auto slot = free_slots.back();
+            free_slots.pop_back();
+            return slot;
+        }
+        if (next == slot_count) {
+            throw std::runtime_error("Error, bindless descriptor array is full");
+        }
+        return next++;
+    }
+
+    void descriptor_slot_allocator::release(std::uint32_t slot) {
+        // A foreign or twice released slot would later be handed to two owners. The search is linear, debug builds only
+        assert(slot < next && "slot was never allocated");
+        assert(std::find(free_slots.begin(), free_slots.end(), slot) == free_slots.end() && "slot released twice");
+        free_slots.push_back(slot);
+    }
+
+    std::uint32_t descriptor_slot_allocator::size() const {
+        return next - static_cast<std::uint32_t>(free_slots.size());
+    }
+
+    std::uint32_t descriptor_slot_allocator::capacity() const {
+        return slot_count;
+    }
+
+    bool bindless_descriptors::supported(const VkPhysicalDeviceDescriptorIndexingFeatures& features) {
+        return features.runtimeDescriptorArray &&
+               features.descriptorBindingPartiallyBound &&
+               features.descriptorBindingUpdateUnusedWhilePending &&
+               features.descriptorBindingSampledImageUpdateAfterBind &&
+               features.descriptorBindingStorageBufferUpdateAfterBind &&
+               features.shaderSampledImageArrayNonUniformIndexing &&
+               features.shaderStorageBufferArrayNonUniformIndexing;
+    }
+
+    VkPhysicalDeviceDescriptorIndexingFeatures bindless_descriptors::required_features() {
+        VkPhysicalDeviceDescriptorIndexingFeatures features{}; {
+            features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+            features.runtimeDescriptorArray = true;
+            features.descriptorBindingPartiallyBound = true;
+            features.descriptorBindingUpdateUnusedWhilePending = true;
+            features.descriptorBindingSampledImageUpdateAfterBind = true;
+            features.descriptorBindingStorageBufferUpdateAfterBind = true;
+            features.shaderSampledImageArrayNonUniformIndexing = true;
+            features.shaderStorageBufferArrayNonUniformIndexing = true;
+        }
+
+        return features;
+    }
+
+    void bindless_descriptors::create(const VkDevice& device, const VkPhysicalDeviceDescriptorIndexingProperties& properties,
+                                      std::span<const VkDescriptorSetLayout> extra_sets, bindless_limits requested) {
+        this->device = device;
+
+        clamped.images = std::min({ requested.images, properties.maxPerStageDescriptorUpdateAfterBindSampledImages,
+                                    properties.maxDescriptorSetUpdateAfterBindSampledImages });
+        clamped.samplers = std::min({ requested.samplers, properties.maxPerStageDescriptorUpdateAfterBindSamplers,
+                                      properties.maxDescriptorSetUpdateAfterBindSamplers });
+        clamped.buffers = std::min({ requested.buffers, properties.maxPerStageDescriptorUpdateAfterBindStorageBuffers,
+                                     properties.maxDescriptorSetUpdateAfterBindStorageBuffers });
+        images.create(clamped.images);
+        samplers.create(clamped.samplers);
+        buffers.create(clamped.buffers);
+
+        const VkDescriptorType types[] = { VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, VK_DESCRIPTOR_TYPE_SAMPLER, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER };
+        const std::uint32_t counts[] = { clamped.images, clamped.samplers, clamped.buffers };
+
+        VkDescriptorSetLayoutBinding bindings[3]{};
+        VkDescriptorBindingFlags binding_flags[3]{};
+        VkDescriptorPoolSize pool_sizes[3]{};
+        for (std::uint32_t i = 0; i < 3; ++i) {
+            bindings[i].binding = i;
+            bindings[i].descriptorType = types[i];
+            bindings[i].descriptorCount = counts[i];
+            bindings[i].stageFlags = stages;
+
+            // Unwritten slots are fine as long as nothing reads them
+            binding_flags[i] = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT |
+                               VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+
+            pool_sizes[i].type = types[i];
+            pool_sizes[i].descriptorCount = counts[i];
+        }
+
+        VkDescriptorSetLayoutBindingFlagsCreateInfo binding_flags_info{}; {
+            binding_flags_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+            binding_flags_info.bindingCount = 3;
+            binding_flags_info.pBindingFlags = binding_flags;
+        }
+
+        VkDescriptorSetLayoutCreateInfo set_layout_info{}; {
+            set_layout_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+            set_layout_info.pNext = &binding_flags_info;
+            set_layout_info.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+            set_layout_info.bindingCount = 3;
+            set_layout_info.pBindings = bindings;
+        }
+
+        if (vkCreateDescriptorSetLayout(device, &set_layout_info, nullptr, set_layout.put(device)) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create bindless descriptor set layout");
+        }
+
+        VkDescriptorPoolCreateInfo pool_info{}; {
+            pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+            pool_info.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+            pool_info.maxSets = 1;
+            pool_info.poolSizeCount = 3;
+            pool_info.pPoolSizes = pool_sizes;
+        }
+
+        if (vkCreateDescriptorPool(device, &pool_info, nullptr, descriptor_pool.put(device)) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create bindless descriptor pool");
+        }
+
+        VkDescriptorSetAllocateInfo set_info{}; {
+            set_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+            set_info.descriptorPool = descriptor_pool;
+            set_info.descriptorSetCount = 1;
+            set_info.pSetLayouts = set_layout.address();
+        }
+
+        if (vkAllocateDescriptorSets(device, &set_info, &descriptor_set) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to allocate bindless descriptor set");
+        }
+
+        VkPushConstantRange push_constants{}; {
+            push_constants.stageFlags = stages;
+            push_constants.offset = 0;
+            push_constants.size = sizeof(bindless_indices);
+        }
+
+        std::vector<VkDescriptorSetLayout> set_layouts = { set_layout };
+        set_layouts.insert(set_layouts.end(), extra_sets.begin(), extra_sets.end());
+
+        VkPipelineLayoutCreateInfo layout_info{}; {
+            layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+            layout_info.setLayoutCount = static_cast<std::uint32_t>(set_layouts.size());
+            layout_info.pSetLayouts = set_layouts.data();
+            layout_info.pushConstantRangeCount = 1;
+            layout_info.pPushConstantRanges = &push_constants;
+        }
+
+        if (vkCreatePipelineLayout(device, &layout_info, nullptr, layout.put(device)) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create bindless pipeline layout");
+        }
+    }
+
+    void bindless_descriptors::destroy() {
+        layout.reset();
+        // The set goes with its pool
+        descriptor_pool.reset();
+        descriptor_set = VK_NULL_HANDLE;
+        set_layout.reset();
+    }
+
+    VkPipelineLayout bindless_descriptors::pipeline_layout() const {
+        return layout;
+    }
+
+    const bindless_limits& bindless_descriptors::limits() const {
+        return clamped;
+    }
+
+    std::uint32_t bindless_descriptors::add_image(VkImageView view, VkImageLayout image_layout) {
+        const auto slot = images.allocate();
+
+        VkDescriptorImageInfo image_info{}; {
+            image_info.imageView = view;
+            image_info.imageLayout = image_layout;
+        }
+
+        VkWriteDescriptorSet write{}; {
+            write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            write.dstSet = descriptor_set;
+            write.dstBinding = image_binding;
+            write.dstArrayElement = slot;
+            write.descriptorCount = 1;
+            write.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+            write.pImageInfo = &image_info;
+        }
+
+        vkUpdateDescriptorSets(device, 1, &write, 0, nullptr);
+        return slot;
+    }
+
+    std::uint32_t bindless_descriptors::add_sampler(VkSampler sampler) {
+        const auto slot = samplers.allocate();
+
+        VkDescriptorImageInfo sampler_info{}; {
+            sampler_info.sampler = sampler;
+        }
+
+        VkWriteDescriptorSet write{}; {
+            write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            write.dstSet = descriptor_set;
+            write.dstBinding = sampler_binding;
+            write.dstArrayElement = slot;
+            write.descriptorCount = 1;
+            write.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER;
+            write.pImageInfo = &sampler_info;
+        }
+
+        vkUpdateDescriptorSets(device, 1, &write, 0, nullptr);
+        return slot;
+    }
+
+    std::uint32_t bindless_descriptors::add_buffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range) {
+        const auto slot = buffers.allocate();
+
+        VkDescriptorBufferInfo buffer_info{}; {
+            buffer_info.buffer = buffer;
+            buffer_info.offset = offset;
+            buffer_info.range = range;
+        }
+
+        VkWriteDescriptorSet write{}; {
+            write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            write.dstSet = descriptor_set;
+            write.dstBinding = buffer_binding;
+            write.dstArrayElement = slot;
+            write.descriptorCount = 1;
+            write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            write.pBufferInfo = &buffer_info;
+        }
+
+        vkUpdateDescriptorSets(device, 1, &write, 0, nullptr);
+        return slot;
+    }
+
+    void bindless_descriptors::remove_image(std::uint32_t slot) {
+        images.release(slot);
+    }
+
+    void bindless_descriptors::remove_sampler(std::uint32_t slot) {
+        samplers.release(slot);
+    }
+
+    void bindless_descriptors::remove_buffer(std::uint32_t slot) {
+        buffers.release(slot);
+    }
+
+    void bindless_descriptors::bind(const VkCommandBuffer& command_buffer, VkPipelineBindPoint bind_point) const {
+        vkCmdBindDescriptorSets(command_buffer, bind_point, layout, 0, 1, &descriptor_set, 0, nullptr);
+    }
+
+    void bindless_descriptors::push(const VkCommandBuffer& command_buffer, const bindless_indices& indices) const {
+        vkCmdPushConstants(command_buffer, layout, stages, 0, sizeof(indices), &indices);
+    }
+} // namespace vk_playground
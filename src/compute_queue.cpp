@@ -0,0 +1,120 @@
+#include "compute_queue.hpp"
+
+#include <stdexcept>
+
+namespace vk_playground {
+    void compute_queue::create(const VkDevice& device, std::uint32_t family, const VkQueue& queue, bool separate, bool core_timeline, std::uint32_t frame_count) {
+        this->device = device;
+        this->family = family;
+        this->queue = queue;
+        this->separate = separate;
+
+        timeline.create(device, core_timeline);
+
+        pools.resize(frame_count);
+        command_buffers.resize(frame_count);
+        slot_values.assign(frame_count, 0);
+        for (std::uint32_t i = 0; i < frame_count; ++i) {
+            VkCommandPoolCreateInfo command_pool_info{}; {
+                command_pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+                command_pool_info.queueFamilyIndex = family;
+                command_pool_info.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+            }
+
+            if (vkCreateCommandPool(device, &command_pool_info, nullptr, pools[i].put(device)) != VK_SUCCESS) {
+                throw std::runtime_error("Failed creating compute command pool");
+            }
+
+            VkCommandBufferAllocateInfo command_buf_info{}; {
+                command_buf_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+                command_buf_info.commandPool = pools[i];
+                command_buf_info.commandBufferCount = 1;
+                command_buf_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+            }
+
+            if (vkAllocateCommandBuffers(device, &command_buf_info, &command_buffers[i]) != VK_SUCCESS) {
+                throw std::runtime_error("Failed allocating compute command buffer");
+            }
+        }
+    }
+
+    void compute_queue::destroy() {
+        command_buffers.clear();
+        pools.clear();
+        slot_values.clear();
+        timeline.destroy();
+    }
+
+    bool compute_queue::async() const {
+        return separate;
+    }
+
+    std::uint32_t compute_queue::family_index() const {
+        return family;
+    }
+
+    const timeline_semaphore& compute_queue::semaphore() const {
+        return timeline;
+    }
+
+    VkCommandBuffer compute_queue::begin(std::uint32_t frame) {
+        timeline.wait(slot_values[frame]);
+        vkResetCommandPool(device, pools[frame], 0);
+
+        VkCommandBufferBeginInfo cmd_buf_begin_info{}; {
+            cmd_buf_begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+            cmd_buf_begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        }
+
+        if (vkBeginCommandBuffer(command_buffers[frame], &cmd_buf_begin_info) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to begin compute command buffer");
+        }
+
+        return command_buffers[frame];
+    }
+
+    std::uint64_t compute_queue::submit(std::uint32_t frame, std::span<const semaphore_wait> waits) {
+        if (vkEndCommandBuffer(command_buffers[frame]) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to end compute command buffer");
+        }
+
+        std::vector<VkSemaphore> wait_semaphores{};
+        std::vector<std::uint64_t> wait_values{};
+        std::vector<VkPipelineStageFlags> wait_stages{};
+        for (const auto& wait : waits) {
+            wait_semaphores.emplace_back(wait.semaphore);
+            wait_values.emplace_back(wait.value);
+            wait_stages.emplace_back(wait.stages);
+        }
+
+        const auto signal_value = timeline.next();
+        const auto signal_semaphore = timeline.handle();
+
+        VkTimelineSemaphoreSubmitInfo timeline_submit_info{}; {
+            timeline_submit_info.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+            timeline_submit_info.waitSemaphoreValueCount = wait_values.size();
+            timeline_submit_info.pWaitSemaphoreValues = wait_values.data();
+            timeline_submit_info.signalSemaphoreValueCount = 1;
+            timeline_submit_info.pSignalSemaphoreValues = &signal_value;
+        }
+
+        VkSubmitInfo submit_info{}; {
+            submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+            submit_info.pNext = &timeline_submit_info;
+            submit_info.commandBufferCount = 1;
+            submit_info.pCommandBuffers = &command_buffers[frame];
+            submit_info.waitSemaphoreCount = wait_semaphores.size();
+            submit_info.pWaitSemaphores = wait_semaphores.data();
+            submit_info.pWaitDstStageMask = wait_stages.data();
+            submit_info.signalSemaphoreCount = 1;
+            submit_info.pSignalSemaphores = &signal_semaphore;
+        }
+
+        if (vkQueueSubmit(queue, 1, &submit_info, nullptr) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to submit compute command buffer");
+        }
+        slot_values[frame] = signal_value;
+
+        return signal_value;
+    }
+} // namespace vk_playground
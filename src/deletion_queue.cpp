@@ -0,0 +1,24 @@
+#include "deletion_queue.hpp"
+
+namespace vk_playground {
+    void deletion_queue::defer(std::uint64_t timeline_value, std::function<void()> call) {
+        entries.push_back({ timeline_value, std::make_unique<deferred_call>(std::move(call)) });
+    }
+
+    void deletion_queue::collect(std::uint64_t completed_value) {
+        while (!entries.empty() && entries.front().timeline_value <= completed_value) {
+            entries.pop_front();
+        }
+    }
+
+    void deletion_queue::flush() {
+        // Same order as they would have retired in
+        while (!entries.empty()) {
+            entries.pop_front();
+        }
+    }
+
+    std::size_t deletion_queue::size() const {
+        return entries.size();
+    }
+} // namespace vk_playground
@@ -0,0 +1,38 @@
+#include "frame_pacer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+namespace vk_playground {
+    void frame_pacer::create(bool enabled, double slack_ms) {
+        this->enabled = enabled;
+        this->slack_ms = slack_ms;
+        predicted_block_ms = 0.0;
+        last_delay_ms = 0.0;
+    }
+
+    double frame_pacer::pace() {
+        if (!enabled) {
+            return 0.0;
+        }
+
+        last_delay_ms = std::clamp(predicted_block_ms - slack_ms, 0.0, max_delay_ms);
+        if (last_delay_ms > 0.0) {
+            std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(last_delay_ms));
+        }
+
+        return last_delay_ms;
+    }
+
+    void frame_pacer::update(double blocked_ms) {
+        if (!enabled) {
+            return;
+        }
+
+        // Without pacing the frame would have blocked for what we slept plus what's left.
+        // Oversleeping leaves nothing to block on and pulls the estimate down by the slack each frame
+        constexpr double smoothing = 0.1;
+        predicted_block_ms += smoothing * ((last_delay_ms + blocked_ms) - predicted_block_ms);
+    }
+} // namespace vk_playground
@@ -0,0 +1,178 @@
+#include "frame_stats.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numeric>
+
+#include <fmt/format.h>
+
+namespace vk_playground {
+    bind_counts& bind_counts::operator +=(const bind_counts& other) {
+        draws += other.draws;
+        pipelines += other.pipelines;
+        materials += other.materials;
+        uniforms += other.uniforms;
+        return *this;
+    }
+
+    distribution distribution::from_samples(std::vector<double> values) {
+        distribution result{};
+
+        if (values.empty()) {
+            return result;
+        }
+
+        std::sort(values.begin(), values.end());
+
+        // Nearest-rank percentile
+        auto percentile = [&values](double p) {
+            auto rank = static_cast<std::size_t>(std::ceil(p / 100.0 * values.size()));
+            return values[std::clamp<std::size_t>(rank, 1, values.size()) - 1];
+        };
+
+        result.mean = std::accumulate(values.begin(), values.end(), 0.0) / values.size();
+        result.p50 = percentile(50.0);
+        result.p95 = percentile(95.0);
+        result.p99 = percentile(99.0);
+        result.max = values.back();
+
+        return result;
+    }
+
+    void frame_statistics::reserve(std::size_t count) {
+        samples.reserve(count);
+    }
+
+    void frame_statistics::add(const frame_timing& timing) {
+        auto& sample = samples.emplace_back(timing);
+        for (auto& region : sample.gpu_regions) {
+            gpu_samples[region.name].emplace_back(region.ms);
+        }
+        sample.gpu_regions.clear();
+        latency_samples.insert(latency_samples.end(), sample.input_latency_ms.begin(), sample.input_latency_ms.end());
+        sample.input_latency_ms.clear();
+    }
+
+    std::size_t frame_statistics::size() const {
+        return samples.size();
+    }
+
+    template <typename Fn>
+    static distribution collect(const std::vector<frame_timing>& samples, Fn&& field) {
+        std::vector<double> values(samples.size());
+        std::transform(samples.begin(), samples.end(), values.begin(), field);
+        return distribution::from_samples(std::move(values));
+    }
+
+    distribution frame_statistics::cpu() const {
+        return collect(samples, [](const frame_timing& timing) { return timing.cpu_ms; });
+    }
+
+    distribution frame_statistics::fence_wait() const {
+        return collect(samples, [](const frame_timing& timing) { return timing.fence_wait_ms; });
+    }
+
+    distribution frame_statistics::acquire_wait() const {
+        return collect(samples, [](const frame_timing& timing) { return timing.acquire_wait_ms; });
+    }
+
+    distribution frame_statistics::record() const {
+        return collect(samples, [](const frame_timing& timing) { return timing.record_ms; });
+    }
+
+    distribution frame_statistics::update() const {
+        return collect(samples, [](const frame_timing& timing) { return timing.update_ms; });
+    }
+
+    distribution frame_statistics::sort() const {
+        return collect(samples, [](const frame_timing& timing) { return timing.sort_ms; });
+    }
+
+    distribution frame_statistics::pacing() const {
+        return collect(samples, [](const frame_timing& timing) { return timing.pacing_ms; });
+    }
+
+    distribution frame_statistics::queue_depth() const {
+        return collect(samples, [](const frame_timing& timing) { return timing.queue_depth; });
+    }
+
+    distribution frame_statistics::input_latency() const {
+        return distribution::from_samples(latency_samples);
+    }
+
+    std::map<std::string, distribution> frame_statistics::gpu() const {
+        std::map<std::string, distribution> result{};
+        for (const auto& [name, values] : gpu_samples) {
+            result.emplace(name, distribution::from_samples(values));
+        }
+        return result;
+    }
+
+    // Draws, pipeline, material and uniform binds
+    static std::array<double, 4> mean_binds(const std::vector<frame_timing>& samples) {
+        std::array<double, 4> result{};
+        for (const auto& timing : samples) {
+            result[0] += timing.binds.draws;
+            result[1] += timing.binds.pipelines;
+            result[2] += timing.binds.materials;
+            result[3] += timing.binds.uniforms;
+        }
+        for (auto& value : result) {
+            value /= std::max<std::size_t>(samples.size(), 1);
+        }
+        return result;
+    }
+
+    static std::string format_row(const std::string& name, const distribution& dist) {
+        return fmt::format("{:<16}{:>10.3f}{:>10.3f}{:>10.3f}{:>10.3f}{:>10.3f}\n",
+                           name, dist.mean, dist.p50, dist.p95, dist.p99, dist.max);
+    }
+
+    static std::string format_json(const distribution& dist) {
+        return fmt::format(R"({{ "mean": {:.6f}, "p50": {:.6f}, "p95": {:.6f}, "p99": {:.6f}, "max": {:.6f} }})",
+                           dist.mean, dist.p50, dist.p95, dist.p99, dist.max);
+    }
+
+    std::string frame_statistics::summary() const {
+        auto cpu_dist = cpu();
+
+        std::string result = fmt::format("{} frames, {:.1f} fps (mean)\n", samples.size(), cpu_dist.mean > 0.0 ? 1000.0 / cpu_dist.mean : 0.0);
+        result += fmt::format("{:<16}{:>10}{:>10}{:>10}{:>10}{:>10}\n", "[ms]", "mean", "p50", "p95", "p99", "max");
+        result += format_row("cpu frame", cpu_dist);
+        result += format_row("fence wait", fence_wait());
+        result += format_row("acquire wait", acquire_wait());
+        result += format_row("record", record());
+        result += format_row("update", update());
+        result += format_row("sort", sort());
+        result += format_row("pacing", pacing());
+        result += format_row("input latency", input_latency());
+        for (const auto& [name, dist] : gpu()) {
+            result += format_row("gpu " + name, dist);
+        }
+
+        auto depth = queue_depth();
+        result += fmt::format("queue depth {:.2f} frames mean, {:.0f} max\n", depth.mean, depth.max);
+        const auto binds = mean_binds(samples);
+        result += fmt::format("binds per frame {:.0f} pipeline, {:.0f} material, {:.0f} uniform over {:.0f} draws (mean)\n",
+                              binds[1], binds[2], binds[3], binds[0]);
+
+        return result;
+    }
+
+    std::string frame_statistics::json() const {
+        std::string gpu_json{};
+        for (const auto& [name, dist] : gpu()) {
+            gpu_json += fmt::format(R"({}"{}": {})", gpu_json.empty() ? "" : ", ", name, format_json(dist));
+        }
+
+        const auto binds = mean_binds(samples);
+        const auto binds_json = fmt::format(R"({{ "draws": {:.1f}, "pipelines": {:.1f}, "materials": {:.1f}, "uniforms": {:.1f} }})",
+                                            binds[0], binds[1], binds[2], binds[3]);
+
+        return fmt::format(R"({{ "frames": {}, "cpu_ms": {}, "fence_wait_ms": {}, "acquire_wait_ms": {}, "record_ms": {}, "update_ms": {}, "sort_ms": {}, "pacing_ms": {}, "input_latency_ms": {}, "queue_depth": {}, "binds": {}, "gpu_ms": {{ {} }} }})",
+                           samples.size(), format_json(cpu()), format_json(fence_wait()), format_json(acquire_wait()),
+                           format_json(record()), format_json(update()), format_json(sort()), format_json(pacing()), format_json(input_latency()),
+                           format_json(queue_depth()), binds_json, gpu_json);
+    }
+} // namespace vk_playground
@@ -0,0 +1,123 @@
+#include "gpu_profiler.hpp"
+
+#include <stdexcept>
+
+namespace vk_playground {
+    void gpu_profiler::create(const VkDevice& logical_device, std::uint32_t frame_count, std::uint32_t region_count, float period, std::uint32_t valid_bits) {
+        // Queue family without timestamp support, profiling stays disabled
+        if (valid_bits == 0) {
+            return;
+        }
+
+        device = logical_device;
+        max_regions = region_count;
+        timestamp_period = period;
+        timestamp_mask = valid_bits >= 64 ? UINT64_MAX : (std::uint64_t(1) << valid_bits) - 1;
+
+        // Two timestamps + two availability words per region
+        query_data.resize(max_regions * 4);
+
+        VkQueryPoolCreateInfo query_pool_info{}; {
+            query_pool_info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+            query_pool_info.queryType = VK_QUERY_TYPE_TIMESTAMP;
+            query_pool_info.queryCount = max_regions * 2;
+        }
+
+        frames.resize(frame_count);
+        for (auto& frame : frames) {
+            if (vkCreateQueryPool(device, &query_pool_info, nullptr, &frame.pool) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to create timestamp query pool");
+            }
+            frame.names.reserve(max_regions);
+        }
+    }
+
+    void gpu_profiler::destroy() {
+        for (const auto& frame : frames) {
+            vkDestroyQueryPool(device, frame.pool, nullptr);
+        }
+        frames.clear();
+    }
+
+    bool gpu_profiler::enabled() const {
+        return !frames.empty();
+    }
+
+    void gpu_profiler::begin_frame(const VkCommandBuffer& command_buffer, std::uint32_t frame) {
+        if (!enabled()) {
+            return;
+        }
+
+        vkCmdResetQueryPool(command_buffer, frames[frame].pool, 0, max_regions * 2);
+        frames[frame].names.clear();
+    }
+
+    std::uint32_t gpu_profiler::begin_region(const VkCommandBuffer& command_buffer, std::uint32_t frame, std::string name) {
+        if (!enabled() || frames[frame].names.size() == max_regions) {
+            return UINT32_MAX;
+        }
+
+        auto& queries = frames[frame];
+        auto region = static_cast<std::uint32_t>(queries.names.size());
+        queries.names.emplace_back(std::move(name));
+
+        vkCmdWriteTimestamp(command_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, queries.pool, region * 2);
+
+        return region;
+    }
+
+    void gpu_profiler::end_region(const VkCommandBuffer& command_buffer, std::uint32_t frame, std::uint32_t region) {
+        if (region == UINT32_MAX) {
+            return;
+        }
+
+        vkCmdWriteTimestamp(command_buffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, frames[frame].pool, region * 2 + 1);
+    }
+
+    void gpu_profiler::mark_submitted(std::uint32_t frame) {
+        if (enabled()) {
+            frames[frame].submitted = true;
+        }
+    }
+
+    bool gpu_profiler::collect(std::uint32_t frame) {
+        // Queries of a frame that never reached the queue have not been reset yet
+        if (!enabled() || !frames[frame].submitted || frames[frame].names.empty()) {
+            return false;
+        }
+
+        const auto& queries = frames[frame];
+        const auto query_count = static_cast<std::uint32_t>(queries.names.size() * 2);
+
+        // No WAIT_BIT, if the frame has not retired yet the availability words stay zero
+        auto result = vkGetQueryPoolResults(
+            device, queries.pool, 0, query_count,
+            query_count * 2 * sizeof(std::uint64_t), query_data.data(), 2 * sizeof(std::uint64_t),
+            VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+
+        if (result != VK_SUCCESS && result != VK_NOT_READY) {
+            return false;
+        }
+
+        for (std::uint32_t i = 0; i < query_count; ++i) {
+            if (query_data[i * 2 + 1] == 0) {
+                return false;
+            }
+        }
+
+        latest.clear();
+        for (std::uint32_t i = 0; i < queries.names.size(); ++i) {
+            const auto begin = query_data[i * 4 + 0];
+            const auto end = query_data[i * 4 + 2];
+            const auto ticks = ((end & timestamp_mask) - (begin & timestamp_mask)) & timestamp_mask;
+            latest.push_back({ queries.names[i], static_cast<double>(ticks) * timestamp_period / 1e6,
+                               static_cast<double>(begin & timestamp_mask) * timestamp_period / 1e6 });
+        }
+
+        return true;
+    }
+
+    const std::vector<gpu_region_timing>& gpu_profiler::results() const {
+        return latest;
+    }
+} // namespace vk_playground
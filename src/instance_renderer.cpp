@@ -0,0 +1,197 @@
+#include "instance_renderer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+#include <utility>
+
+#include <shader_watcher.hpp>
+
+namespace vk_playground {
+    void instance_renderer::create(const VkDevice& device, memory_allocator& allocator, thread_pool& workers, shader_module_cache& shaders, pipeline_compiler& compiler,
+                                   const std::filesystem::path& shader_directory, const VkRenderPass& render_pass, const mesh& model,
+                                   std::uint32_t count, std::uint32_t frame_count) {
+        this->device = device;
+        this->allocator = &allocator;
+        this->workers = &workers;
+        this->shader_directory = shader_directory;
+        this->render_pass = render_pass;
+        this->frame_count = frame_count;
+        geometry = &model;
+
+        // Fixed seed, every run draws the same instances. Sized so they roughly tile the screen at any count
+        const auto base_scale = 1.5f / std::sqrt(static_cast<float>(count));
+        std::mt19937 generator(7);
+        std::uniform_real_distribution<float> position(-1.0f, 1.0f);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        std::uniform_int_distribution<std::uint32_t> channel(64, 255);
+        seeds.resize(count);
+        for (auto& seed : seeds) {
+            seed.position[0] = position(generator);
+            seed.position[1] = position(generator);
+            seed.scale = base_scale * (0.5f + unit(generator));
+            seed.angle = unit(generator) * 6.2831853f;
+            seed.spin = (unit(generator) - 0.5f) * 4.0f;
+            seed.color = channel(generator) | channel(generator) << 8 | channel(generator) << 16 | 0xff000000u;
+        }
+
+        VkBufferCreateInfo buffer_info{}; {
+            buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+            buffer_info.size = frame_bytes() * frame_count;
+            buffer_info.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+            buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        }
+        // Coherent so the writes need no flush. Device local too when it's there (resizable bar, integrated gpus),
+        // the vertex fetch then doesn't cross the bus
+        instances = allocator.create_buffer(buffer_info, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        if (instances.memory.mapped == nullptr) {
+            throw std::runtime_error("Error, instance buffer is not host visible");
+        }
+
+        VkPipelineLayoutCreateInfo layout_info{}; {
+            layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        }
+
+        if (vkCreatePipelineLayout(device, &layout_info, nullptr, layout.put(device)) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create instancing pipeline layout");
+        }
+
+        compile_pipelines(shaders, compiler);
+    }
+
+    std::vector<std::filesystem::path> instance_renderer::shader_sources() const {
+        return { shader_directory / "instanced.vert", shader_directory / "triangle.frag" };
+    }
+
+    void instance_renderer::compile_pipelines(shader_module_cache& shaders, pipeline_compiler& compiler) {
+        shader draw_shader{};
+        draw_shader
+            .add_stage(VK_SHADER_STAGE_VERTEX_BIT, compiled_shader_path(shader_directory / "instanced.vert"), shaders)
+            .add_stage(VK_SHADER_STAGE_FRAGMENT_BIT, compiled_shader_path(shader_directory / "triangle.frag"), shaders);
+
+        graphics_pipeline_description draw_description{}; {
+            draw_description.stages = draw_shader.stages();
+
+            VkVertexInputBindingDescription per_vertex{}; {
+                per_vertex.binding = 0;
+                per_vertex.stride = sizeof(vertex);
+                per_vertex.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+            }
+            VkVertexInputBindingDescription per_instance{}; {
+                per_instance.binding = 1;
+                per_instance.stride = sizeof(instance_data);
+                per_instance.inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+            }
+            draw_description.vertex_bindings = { per_vertex, per_instance };
+
+            VkVertexInputAttributeDescription position{}; {
+                position.binding = 0;
+                position.location = 0;
+                position.format = VK_FORMAT_R32G32B32_SFLOAT;
+                position.offset = offsetof(vertex, position);
+            }
+            VkVertexInputAttributeDescription color{}; {
+                color.binding = 0;
+                color.location = 1;
+                color.format = VK_FORMAT_R32G32B32_SFLOAT;
+                color.offset = offsetof(vertex, color);
+            }
+            VkVertexInputAttributeDescription transform{}; {
+                transform.binding = 1;
+                transform.location = 2;
+                transform.format = VK_FORMAT_R32G32B32A32_SFLOAT;
+                transform.offset = offsetof(instance_data, transform);
+            }
+            VkVertexInputAttributeDescription tint{}; {
+                tint.binding = 1;
+                tint.location = 3;
+                tint.format = VK_FORMAT_R8G8B8A8_UNORM;
+                tint.offset = offsetof(instance_data, color);
+            }
+            draw_description.vertex_attributes = { position, color, transform, tint };
+
+            draw_description.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+            draw_description.dynamic_states = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+            draw_description.layout = layout;
+            draw_description.render_pass = render_pass;
+            draw_description.subpass = 0;
+        }
+        pending_pipeline = compiler.compile(std::move(draw_description));
+    }
+
+    void instance_renderer::wait_pipelines() {
+        if (pending_pipeline.valid()) {
+            pipeline = unique_pipeline(device, pending_pipeline.get());
+        }
+    }
+
+    bool instance_renderer::reload_ready() const {
+        return pipeline_ready(pending_pipeline);
+    }
+
+    void instance_renderer::swap_pipelines(deletion_queue& deletions, std::uint64_t retire_value) {
+        if (pending_pipeline.valid()) {
+            deletions.retire(retire_value, std::exchange(pipeline, unique_pipeline(device, pending_pipeline.get())));
+        }
+    }
+
+    void instance_renderer::destroy() {
+        // Pipelines of a shader reload that was never swapped in
+        try {
+            wait_pipelines();
+        } catch (const std::exception&) {}
+        pipeline.reset();
+        layout.reset();
+        if (instances.buffer) {
+            allocator->destroy_buffer(instances);
+            instances = {};
+        }
+        seeds.clear();
+    }
+
+    bool instance_renderer::enabled() const {
+        return !seeds.empty();
+    }
+
+    std::uint32_t instance_renderer::size() const {
+        return static_cast<std::uint32_t>(seeds.size());
+    }
+
+    VkDeviceSize instance_renderer::frame_bytes() const {
+        return VkDeviceSize(seeds.size()) * sizeof(instance_data);
+    }
+
+    VkDeviceSize instance_renderer::region_offset(std::uint32_t frame) const {
+        return frame_bytes() * frame;
+    }
+
+    void instance_renderer::update(std::uint32_t frame, double time_s) {
+        auto* region = reinterpret_cast<instance_data*>(static_cast<std::byte*>(instances.memory.mapped) + region_offset(frame));
+        const auto count = size();
+        const auto time = static_cast<float>(time_s);
+
+        // Whole structs written front to back, write combined memory is never read here
+        const auto tasks = std::clamp<std::uint32_t>(count / min_update_chunk, 1, static_cast<std::uint32_t>(workers->size()) + 1);
+        workers->parallel_for(tasks, [this, region, count, time, tasks](std::uint32_t task) {
+            const auto first = static_cast<std::uint32_t>(std::uint64_t(count) * task / tasks);
+            const auto last = static_cast<std::uint32_t>(std::uint64_t(count) * (task + 1) / tasks);
+            for (std::uint32_t i = first; i < last; ++i) {
+                const auto& seed = seeds[i];
+                region[i] = { { seed.position[0], seed.position[1], seed.scale, seed.angle + seed.spin * time }, seed.color };
+            }
+        });
+    }
+
+    void instance_renderer::record_draw(const VkCommandBuffer& command_buffer, std::uint32_t frame) const {
+        const VkBuffer buffers[] = { geometry->buffers.vertices.buffer, instances.buffer };
+        const VkDeviceSize offsets[] = { 0, region_offset(frame) };
+        vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+        vkCmdBindVertexBuffers(command_buffer, 0, 2, buffers, offsets);
+        vkCmdBindIndexBuffer(command_buffer, geometry->buffers.indices.buffer, 0, vk_index_type);
+        for (const auto& submesh : geometry->submeshes) {
+            vkCmdDrawIndexed(command_buffer, submesh.index_count, size(), submesh.first_index, submesh.vertex_offset, 0);
+        }
+    }
+} // namespace vk_playground
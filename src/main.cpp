@@ -1,8 +1,8 @@
 #include <iostream>
 #include "application.hpp"
 
-int main() {
-    vk_playground::application app{};
+int main(int argc, char** argv) {
+    vk_playground::application app{ vk_playground::settings::from_args(argc, argv) };
     app.glfw_init();
     app.vk_init();
     app.run();
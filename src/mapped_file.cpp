@@ -0,0 +1,125 @@
+#include "mapped_file.hpp"
+
+#include <stdexcept>
+#include <utility>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace vk_playground {
+    mapped_file::mapped_file(const std::filesystem::path& path) {
+#if defined(_WIN32)
+        file_handle = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file_handle == INVALID_HANDLE_VALUE) {
+            file_handle = nullptr;
+            throw std::runtime_error("Error, " + path.generic_string() + " not found");
+        }
+
+        LARGE_INTEGER file_size{};
+        GetFileSizeEx(file_handle, &file_size);
+        length = static_cast<std::size_t>(file_size.QuadPart);
+        if (length == 0) {
+            return;
+        }
+
+        mapping_handle = CreateFileMappingW(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping_handle != nullptr) {
+            mapping = static_cast<const std::byte*>(MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0));
+        }
+        if (mapping == nullptr) {
+            unmap();
+            throw std::runtime_error("Error, failed to map " + path.generic_string());
+        }
+#else
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            throw std::runtime_error("Error, " + path.generic_string() + " not found");
+        }
+
+        struct stat file_stat{};
+        if (::fstat(fd, &file_stat) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Error, failed to stat " + path.generic_string());
+        }
+
+        length = static_cast<std::size_t>(file_stat.st_size);
+        if (length == 0) {
+            ::close(fd);
+            return;
+        }
+
+        // The mapping keeps its own reference to the file, the descriptor isn't needed past this
+        void* address = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (address == MAP_FAILED) {
+            length = 0;
+            throw std::runtime_error("Error, failed to map " + path.generic_string());
+        }
+
+        // Assets are read front to back exactly once, let the kernel read ahead aggressively
+        ::madvise(address, length, MADV_SEQUENTIAL);
+        ::madvise(address, length, MADV_WILLNEED);
+        mapping = static_cast<const std::byte*>(address);
+#endif
+    }
+
+    mapped_file::~mapped_file() {
+        unmap();
+    }
+
+    mapped_file::mapped_file(mapped_file&& other) noexcept {
+        *this = std::move(other);
+    }
+
+    mapped_file& mapped_file::operator =(mapped_file&& other) noexcept {
+        if (this != &other) {
+            unmap();
+            mapping = std::exchange(other.mapping, nullptr);
+            length = std::exchange(other.length, 0);
+#if defined(_WIN32)
+            file_handle = std::exchange(other.file_handle, nullptr);
+            mapping_handle = std::exchange(other.mapping_handle, nullptr);
+#endif
+        }
+
+        return *this;
+    }
+
+    void mapped_file::unmap() {
+#if defined(_WIN32)
+        if (mapping != nullptr) {
+            UnmapViewOfFile(mapping);
+        }
+        if (mapping_handle != nullptr) {
+            CloseHandle(mapping_handle);
+        }
+        if (file_handle != nullptr) {
+            CloseHandle(file_handle);
+        }
+        file_handle = nullptr;
+        mapping_handle = nullptr;
+#else
+        if (mapping != nullptr) {
+            ::munmap(const_cast<std::byte*>(mapping), length);
+        }
+#endif
+        mapping = nullptr;
+        length = 0;
+    }
+
+    std::span<const std::byte> mapped_file::data() const {
+        return { mapping, length };
+    }
+
+    std::size_t mapped_file::size() const {
+        return length;
+    }
+} // namespace vk_playground
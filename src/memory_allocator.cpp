@@ -0,0 +1,274 @@
+#include "memory_allocator.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace vk_playground {
+    void memory_allocator::create(const VkDevice& logical_device, const VkPhysicalDevice& physical_device, VkDeviceSize size) {
+        device = logical_device;
+        block_size = size;
+
+        VkPhysicalDeviceProperties properties{};
+        vkGetPhysicalDeviceProperties(physical_device, &properties);
+        vkGetPhysicalDeviceMemoryProperties(physical_device, &memory_properties);
+
+        granularity = properties.limits.bufferImageGranularity;
+        max_allocations = properties.limits.maxMemoryAllocationCount;
+
+        for (std::uint32_t i = 0; i < pools.size(); ++i) {
+            pools[i].memory_type = i % VK_MAX_MEMORY_TYPES;
+        }
+    }
+
+    void memory_allocator::destroy() {
+        std::lock_guard lock(mutex);
+
+        for (auto& pool : pools) {
+            for (auto& block : pool.blocks) {
+                if (block.memory != nullptr) {
+                    vkFreeMemory(device, block.memory, nullptr);
+                }
+            }
+            pool.blocks.clear();
+        }
+        device_allocation_count = 0;
+    }
+
+    std::uint32_t memory_allocator::pool_index(std::uint32_t memory_type, resource_kind kind) const {
+        // With a granularity of 1 linear and optimal resources can freely share blocks
+        if (granularity <= 1 || kind == resource_kind::linear) {
+            return memory_type;
+        }
+
+        return VK_MAX_MEMORY_TYPES + memory_type;
+    }
+
+    std::uint32_t memory_allocator::find_memory_type(std::uint32_t type_bits, VkMemoryPropertyFlags required, VkMemoryPropertyFlags preferred) const {
+        std::uint32_t fallback = UINT32_MAX;
+
+        for (std::uint32_t i = 0; i < memory_properties.memoryTypeCount; ++i) {
+            const auto flags = memory_properties.memoryTypes[i].propertyFlags;
+            if (!(type_bits & (1u << i)) || (flags & required) != required) {
+                continue;
+            }
+
+            if ((flags & preferred) == preferred) {
+                return i;
+            }
+
+            if (fallback == UINT32_MAX) {
+                fallback = i;
+            }
+        }
+
+        if (fallback == UINT32_MAX) {
+            throw std::runtime_error("Error, can't find a suitable memory type");
+        }
+
+        return fallback;
+    }
+
+    bool memory_allocator::is_host_coherent(const allocation& memory) const {
+        const auto memory_type = memory.pool == dedicated ? memory.block : pools[memory.pool].memory_type;
+
+        return memory_properties.memoryTypes[memory_type].propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    }
+
+    VkDeviceMemory memory_allocator::allocate_device_memory(VkDeviceSize size, std::uint32_t memory_type, void** mapped) {
+        if (device_allocation_count >= max_allocations) {
+            throw std::runtime_error("Error, maxMemoryAllocationCount exceeded");
+        }
+
+        VkMemoryAllocateInfo allocate_info{}; {
+            allocate_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+            allocate_info.allocationSize = size;
+            allocate_info.memoryTypeIndex = memory_type;
+        }
+
+        VkDeviceMemory memory{};
+        if (vkAllocateMemory(device, &allocate_info, nullptr, &memory) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to allocate device memory");
+        }
+        ++device_allocation_count;
+
+        *mapped = nullptr;
+        if (memory_properties.memoryTypes[memory_type].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+            if (vkMapMemory(device, memory, 0, VK_WHOLE_SIZE, 0, mapped) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to map device memory");
+            }
+        }
+
+        return memory;
+    }
+
+    allocation memory_allocator::allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags required, VkMemoryPropertyFlags preferred, resource_kind kind) {
+        const auto memory_type = find_memory_type(requirements.memoryTypeBits, required, preferred);
+
+        std::lock_guard lock(mutex);
+
+        allocation result{};
+        result.size = requirements.size;
+
+        if (requirements.size > block_size / 2) {
+            void* mapped{};
+            result.memory = allocate_device_memory(requirements.size, memory_type, &mapped);
+            result.mapped = mapped;
+            result.pool = dedicated;
+            result.block = memory_type;
+            dedicated_bytes += requirements.size;
+            ++dedicated_count;
+            return result;
+        }
+
+        // Optimal images sharing a block with buffers would need granularity padding on both ends,
+        // pool_index() keeps them apart instead so the alignment below is enough
+        const auto pool = pool_index(memory_type, kind);
+        auto& blocks = pools[pool].blocks;
+
+        auto try_block = [&](std::uint32_t index) {
+            auto& block = blocks[index];
+            if (block.memory == nullptr) {
+                return false;
+            }
+
+            auto suballocation = block.allocator.allocate(requirements.size, requirements.alignment);
+            if (!suballocation) {
+                return false;
+            }
+
+            result.memory = block.memory;
+            result.offset = suballocation->offset;
+            result.mapped = block.mapped ? static_cast<char*>(block.mapped) + suballocation->offset : nullptr;
+            result.pool = pool;
+            result.block = index;
+            result.handle = suballocation->handle;
+            return true;
+        };
+
+        for (std::uint32_t i = 0; i < blocks.size(); ++i) {
+            if (try_block(i)) {
+                return result;
+            }
+        }
+
+        // Reuse a released slot so block indices held by live allocations stay valid
+        std::uint32_t index = 0;
+        while (index < blocks.size() && blocks[index].memory != nullptr) {
+            ++index;
+        }
+        if (index == blocks.size()) {
+            blocks.emplace_back();
+        }
+
+        auto& block = blocks[index];
+        block.memory = allocate_device_memory(block_size, memory_type, &block.mapped);
+        block.size = block_size;
+        block.allocator = tlsf_allocator(block_size);
+
+        if (!try_block(index)) {
+            throw std::runtime_error("Error, allocation does not fit in an empty memory block");
+        }
+
+        return result;
+    }
+
+    void memory_allocator::free(const allocation& memory) {
+        if (memory.memory == nullptr) {
+            return;
+        }
+
+        std::lock_guard lock(mutex);
+
+        if (memory.pool == dedicated) {
+            vkFreeMemory(device, memory.memory, nullptr);
+            --device_allocation_count;
+            dedicated_bytes -= memory.size;
+            --dedicated_count;
+            return;
+        }
+
+        auto& blocks = pools[memory.pool].blocks;
+        auto& block = blocks[memory.block];
+        block.allocator.free(memory.handle);
+
+        // Keep the first block of a pool around, freeing and reallocating it on every churn is what we avoid here
+        if (block.allocator.empty() && memory.block != 0) {
+            vkFreeMemory(device, block.memory, nullptr);
+            --device_allocation_count;
+            block = {};
+        }
+    }
+
+    buffer_allocation memory_allocator::create_buffer(const VkBufferCreateInfo& info, VkMemoryPropertyFlags required, VkMemoryPropertyFlags preferred) {
+        buffer_allocation result{};
+
+        if (vkCreateBuffer(device, &info, nullptr, &result.buffer) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create buffer");
+        }
+
+        VkMemoryRequirements requirements{};
+        vkGetBufferMemoryRequirements(device, result.buffer, &requirements);
+
+        result.memory = allocate(requirements, required, preferred, resource_kind::linear);
+        vkBindBufferMemory(device, result.buffer, result.memory.memory, result.memory.offset);
+
+        return result;
+    }
+
+    image_allocation memory_allocator::create_image(const VkImageCreateInfo& info, VkMemoryPropertyFlags required, VkMemoryPropertyFlags preferred) {
+        image_allocation result{};
+
+        if (vkCreateImage(device, &info, nullptr, &result.image) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create image");
+        }
+
+        VkMemoryRequirements requirements{};
+        vkGetImageMemoryRequirements(device, result.image, &requirements);
+
+        const auto kind = info.tiling == VK_IMAGE_TILING_OPTIMAL ? resource_kind::optimal : resource_kind::linear;
+        result.memory = allocate(requirements, required, preferred, kind);
+        vkBindImageMemory(device, result.image, result.memory.memory, result.memory.offset);
+
+        return result;
+    }
+
+    void memory_allocator::destroy_buffer(const buffer_allocation& buffer) {
+        vkDestroyBuffer(device, buffer.buffer, nullptr);
+        free(buffer.memory);
+    }
+
+    void memory_allocator::destroy_image(const image_allocation& image) {
+        vkDestroyImage(device, image.image, nullptr);
+        free(image.memory);
+    }
+
+    memory_statistics memory_allocator::statistics() const {
+        std::lock_guard lock(mutex);
+
+        memory_statistics result{};
+        result.device_allocations = device_allocation_count;
+        result.sub_allocations = dedicated_count;
+        result.reserved_bytes = dedicated_bytes;
+        result.used_bytes = dedicated_bytes;
+
+        VkDeviceSize free_bytes = 0;
+        for (const auto& pool : pools) {
+            for (const auto& block : pool.blocks) {
+                if (block.memory == nullptr) {
+                    continue;
+                }
+
+                result.sub_allocations += block.allocator.allocations();
+                result.reserved_bytes += block.size;
+                result.used_bytes += block.allocator.used_bytes();
+                result.free_regions += block.allocator.free_regions();
+                result.largest_free_region = std::max(result.largest_free_region, block.allocator.largest_free_region());
+                free_bytes += block.size - block.allocator.used_bytes();
+            }
+        }
+
+        result.fragmentation = free_bytes > 0 ? 1.0 - static_cast<double>(result.largest_free_region) / free_bytes : 0.0;
+
+        return result;
+    }
+} // namespace vk_playground
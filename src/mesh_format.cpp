@@ -0,0 +1,60 @@
+#include "mesh_format.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace vk_playground {
+    static std::span<const std::byte> mesh_section(std::span<const std::byte> file, std::uint64_t offset, std::uint64_t size, const char* name) {
+        if (offset % mesh_stream_alignment != 0 || offset > file.size() || size > file.size() - offset) {
+            throw std::runtime_error(std::string("Error, mesh ") + name + " section is out of bounds or misaligned");
+        }
+
+        return file.subspan(offset, size);
+    }
+
+    mesh_view parse_mesh(std::span<const std::byte> file) {
+        if (file.size() < sizeof(mesh_header)) {
+            throw std::runtime_error("Error, mesh file is smaller than its header");
+        }
+
+        // Mappings are page aligned, the header sits at offset 0 and every section after it is aligned
+        const auto* header = reinterpret_cast<const mesh_header*>(file.data());
+        if (header->magic != mesh_magic) {
+            throw std::runtime_error("Error, not a mesh file");
+        }
+        if (header->version != mesh_version) {
+            throw std::runtime_error("Error, unsupported mesh version " + std::to_string(header->version));
+        }
+        if (header->vertex_stride != sizeof(mesh_vertex) || header->index_size != sizeof(std::uint32_t)) {
+            throw std::runtime_error("Error, unsupported mesh vertex or index layout");
+        }
+
+        mesh_view view{}; {
+            view.header = header;
+            const auto submeshes = mesh_section(file, header->submesh_offset, std::uint64_t(header->submesh_count) * sizeof(mesh_submesh), "submesh");
+            view.submeshes = { reinterpret_cast<const mesh_submesh*>(submeshes.data()), header->submesh_count };
+            view.vertices = mesh_section(file, header->vertex_offset, std::uint64_t(header->vertex_count) * header->vertex_stride, "vertex");
+            view.indices = mesh_section(file, header->index_offset, std::uint64_t(header->index_count) * header->index_size, "index");
+        }
+
+        // Every index plus its submesh's vertex offset has to land in the vertex stream. That's one
+        // read of the indices the upload copies anyway
+        const auto* indices = reinterpret_cast<const std::uint32_t*>(view.indices.data());
+        for (const auto& submesh : view.submeshes) {
+            if (submesh.first_index > header->index_count || submesh.index_count > header->index_count - submesh.first_index) {
+                throw std::runtime_error("Error, mesh submesh exceeds the index stream");
+            }
+            if (submesh.index_count == 0) {
+                continue;
+            }
+
+            const auto [lowest, highest] = std::minmax_element(indices + submesh.first_index, indices + submesh.first_index + submesh.index_count);
+            if (std::int64_t(submesh.vertex_offset) + *lowest < 0 || std::int64_t(submesh.vertex_offset) + *highest >= header->vertex_count) {
+                throw std::runtime_error("Error, mesh submesh indexes outside the vertex stream");
+            }
+        }
+
+        return view;
+    }
+} // namespace vk_playground
@@ -0,0 +1,58 @@
+#include "mesh_loader.hpp"
+
+#include <frame_stats.hpp>
+#include <mapped_file.hpp>
+
+namespace vk_playground {
+    mesh upload_mesh(memory_allocator& allocator, upload_manager& uploads, const mesh_view& view, std::shared_ptr<const void> owner) {
+        mesh result{};
+        result.submeshes.assign(view.submeshes.begin(), view.submeshes.end());
+        result.bounds = view.header->bounds;
+        result.buffers.vertex_count = view.header->vertex_count;
+        result.buffers.index_count = view.header->index_count;
+
+        VkBufferCreateInfo buffer_info{}; {
+            buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+            buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        }
+
+        buffer_info.size = view.vertices.size();
+        buffer_info.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+        result.buffers.vertices = allocator.create_buffer(buffer_info, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+        buffer_info.size = view.indices.size();
+        buffer_info.usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+        result.buffers.indices = allocator.create_buffer(buffer_info, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+        uploads.upload(result.buffers.vertices.buffer, 0, view.vertices, owner);
+        uploads.upload(result.buffers.indices.buffer, 0, view.indices, std::move(owner));
+
+        return result;
+    }
+
+    mesh load_mesh(const std::filesystem::path& path, memory_allocator& allocator, upload_manager& uploads, mesh_load_statistics* statistics) {
+        const auto map_start = bench_clock::now();
+
+        auto file = std::make_shared<mapped_file>(path);
+        const auto view = parse_mesh(file->data());
+
+        if (statistics != nullptr) {
+            statistics->file_bytes = file->size();
+            statistics->map_ms = elapsed_ms(map_start);
+        }
+
+        // The upload manager copies from the mapping into staging and drops its references
+        // once the last chunk is staged, which unmaps the file
+        return upload_mesh(allocator, uploads, view, std::move(file));
+    }
+
+    void destroy_mesh(memory_allocator& allocator, mesh& target) {
+        if (target.buffers.vertices.buffer) {
+            allocator.destroy_buffer(target.buffers.vertices);
+        }
+        if (target.buffers.indices.buffer) {
+            allocator.destroy_buffer(target.buffers.indices);
+        }
+        target = {};
+    }
+} // namespace vk_playground
@@ -0,0 +1,365 @@
+#include "object_culler.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <utility>
+
+#include <shader_watcher.hpp>
+
+namespace vk_playground {
+    void object_culler::create(const VkDevice& device, memory_allocator& allocator, upload_manager& uploads, thread_pool& workers, shader_module_cache& shaders, pipeline_compiler& compiler,
+                               const std::filesystem::path& shader_directory, const VkRenderPass& render_pass, const mesh& model,
+                               std::uint32_t count, PFN_vkCmdDrawIndexedIndirectCount draw_indirect_count) {
+        this->device = device;
+        this->allocator = &allocator;
+        this->shader_directory = shader_directory;
+        this->render_pass = render_pass;
+        this->draw_indirect_count = draw_indirect_count;
+        geometry = &model;
+
+        // The model's bounding circle in the xy plane, objects are scaled and moved copies of it
+        const float center[2] = {
+            (model.bounds.min[0] + model.bounds.max[0]) * 0.5f,
+            (model.bounds.min[1] + model.bounds.max[1]) * 0.5f
+        };
+        const auto radius = std::hypot(model.bounds.max[0] - center[0], model.bounds.max[1] - center[1]);
+
+        // Fixed seed, every run culls the same field. It's three screens wide, the orbiting view
+        // sees about a ninth of it at a time
+        objects.resize(count);
+        std::mt19937 generator(4242);
+        std::uniform_real_distribution<float> position(-3.0f, 3.0f);
+        std::uniform_real_distribution<float> scale(0.01f, 0.03f);
+        for (auto& object : objects) {
+            const float translation[2] = { position(generator), position(generator) };
+            const auto size = scale(generator);
+            object = {
+                { translation[0] + center[0] * size, translation[1] + center[1] * size, 0.0f, radius * size },
+                { translation[0], translation[1], 0.0f, size }
+            };
+        }
+        // Placed at the bounding circle's center, the scene's spheres are around the object's origin
+        scene.create(workers);
+        scene.reserve(count);
+        for (const auto& object : objects) {
+            scene.add(scene_store::no_parent, { { object.bounds[0], object.bounds[1], 0.0f }, object.transform[3] }, radius);
+        }
+
+        active_count = count;
+        max_draws = count * static_cast<std::uint32_t>(model.submeshes.size());
+
+        create_buffers(uploads);
+        create_descriptors();
+        create_pipeline_layout();
+        compile_pipelines(shaders, compiler);
+    }
+
+    void object_culler::create_buffers(upload_manager& uploads) {
+        VkBufferCreateInfo buffer_info{}; {
+            buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+            buffer_info.size = VkDeviceSize(objects.size()) * sizeof(scene_object);
+            buffer_info.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+            buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        }
+        object_buffer = allocator->create_buffer(buffer_info, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+        buffer_info.size = VkDeviceSize(geometry->submeshes.size()) * sizeof(submesh_draw);
+        submesh_buffer = allocator->create_buffer(buffer_info, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+        // Cleared every frame before the cull pass fills them
+        buffer_info.size = VkDeviceSize(max_draws) * sizeof(VkDrawIndexedIndirectCommand);
+        buffer_info.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+        draw_buffer = allocator->create_buffer(buffer_info, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+        buffer_info.size = sizeof(std::uint32_t);
+        count_buffer = allocator->create_buffer(buffer_info, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+        // objects stays around for the cpu path and outlives the upload, no owner needed
+        uploads.upload(object_buffer.buffer, 0, std::as_bytes(std::span(objects)), nullptr);
+
+        auto submeshes = std::make_shared<std::vector<submesh_draw>>();
+        for (const auto& submesh : geometry->submeshes) {
+            submeshes->push_back({ submesh.index_count, submesh.first_index, submesh.vertex_offset, 0 });
+        }
+        uploads.upload(submesh_buffer.buffer, 0, std::as_bytes(std::span(*submeshes)), submeshes);
+    }
+
+    void object_culler::create_descriptors() {
+        // 0 objects, 1 submeshes, 2 draw commands, 3 draw count. The vertex shader only reads the objects
+        VkDescriptorSetLayoutBinding bindings[4]{};
+        for (std::uint32_t i = 0; i < 4; ++i) {
+            bindings[i].binding = i;
+            bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            bindings[i].descriptorCount = 1;
+            bindings[i].stageFlags = i == 0 ? VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_VERTEX_BIT : VK_SHADER_STAGE_COMPUTE_BIT;
+        }
+
+        VkDescriptorSetLayoutCreateInfo set_layout_info{}; {
+            set_layout_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+            set_layout_info.bindingCount = 4;
+            set_layout_info.pBindings = bindings;
+        }
+
+        if (vkCreateDescriptorSetLayout(device, &set_layout_info, nullptr, set_layout.put(device)) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create culling descriptor set layout");
+        }
+
+        VkDescriptorPoolSize pool_size{}; {
+            pool_size.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            pool_size.descriptorCount = 4;
+        }
+
+        VkDescriptorPoolCreateInfo pool_info{}; {
+            pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+            pool_info.maxSets = 1;
+            pool_info.poolSizeCount = 1;
+            pool_info.pPoolSizes = &pool_size;
+        }
+
+        if (vkCreateDescriptorPool(device, &pool_info, nullptr, descriptor_pool.put(device)) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create culling descriptor pool");
+        }
+
+        VkDescriptorSetAllocateInfo set_info{}; {
+            set_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+            set_info.descriptorPool = descriptor_pool;
+            set_info.descriptorSetCount = 1;
+            set_info.pSetLayouts = set_layout.address();
+        }
+
+        if (vkAllocateDescriptorSets(device, &set_info, &descriptor_set) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to allocate culling descriptor set");
+        }
+
+        const VkBuffer buffers[] = { object_buffer.buffer, submesh_buffer.buffer, draw_buffer.buffer, count_buffer.buffer };
+        VkDescriptorBufferInfo buffer_infos[4]{};
+        VkWriteDescriptorSet writes[4]{};
+        for (std::uint32_t i = 0; i < 4; ++i) {
+            auto& buffer_info = buffer_infos[i]; {
+                buffer_info.buffer = buffers[i];
+                buffer_info.offset = 0;
+                buffer_info.range = VK_WHOLE_SIZE;
+            }
+
+            auto& write = writes[i]; {
+                write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                write.dstSet = descriptor_set;
+                write.dstBinding = i;
+                write.descriptorCount = 1;
+                write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+                write.pBufferInfo = &buffer_info;
+            }
+        }
+
+        vkUpdateDescriptorSets(device, 4, writes, 0, nullptr);
+    }
+
+    void object_culler::create_pipeline_layout() {
+        VkPushConstantRange push_constants{}; {
+            push_constants.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_VERTEX_BIT;
+            push_constants.offset = 0;
+            push_constants.size = sizeof(cull_constants);
+        }
+
+        VkPipelineLayoutCreateInfo layout_info{}; {
+            layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+            layout_info.setLayoutCount = 1;
+            layout_info.pSetLayouts = set_layout.address();
+            layout_info.pushConstantRangeCount = 1;
+            layout_info.pPushConstantRanges = &push_constants;
+        }
+
+        if (vkCreatePipelineLayout(device, &layout_info, nullptr, layout.put(device)) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create culling pipeline layout");
+        }
+    }
+
+    std::vector<std::filesystem::path> object_culler::shader_sources() const {
+        return { shader_directory / "cull.comp", shader_directory / "objects.vert", shader_directory / "triangle.frag" };
+    }
+
+    void object_culler::compile_pipelines(shader_module_cache& shaders, pipeline_compiler& compiler) {
+        shader cull_shader{};
+        cull_shader.add_stage(VK_SHADER_STAGE_COMPUTE_BIT, compiled_shader_path(shader_directory / "cull.comp"), shaders);
+
+        compute_pipeline_description cull_description{}; {
+            cull_description.stage = cull_shader.stages().front();
+            cull_description.layout = layout;
+        }
+        pending_cull = compiler.compile(cull_description);
+
+        shader draw_shader{};
+        draw_shader
+            .add_stage(VK_SHADER_STAGE_VERTEX_BIT, compiled_shader_path(shader_directory / "objects.vert"), shaders)
+            .add_stage(VK_SHADER_STAGE_FRAGMENT_BIT, compiled_shader_path(shader_directory / "triangle.frag"), shaders);
+
+        graphics_pipeline_description draw_description{}; {
+            draw_description.stages = draw_shader.stages();
+
+            VkVertexInputBindingDescription binding{}; {
+                binding.binding = 0;
+                binding.stride = sizeof(vertex);
+                binding.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+            }
+            draw_description.vertex_bindings = { binding };
+
+            VkVertexInputAttributeDescription position{}; {
+                position.binding = 0;
+                position.location = 0;
+                position.format = VK_FORMAT_R32G32B32_SFLOAT;
+                position.offset = offsetof(vertex, position);
+            }
+            VkVertexInputAttributeDescription color{}; {
+                color.binding = 0;
+                color.location = 1;
+                color.format = VK_FORMAT_R32G32B32_SFLOAT;
+                color.offset = offsetof(vertex, color);
+            }
+            draw_description.vertex_attributes = { position, color };
+
+            draw_description.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+            draw_description.dynamic_states = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+            draw_description.layout = layout;
+            draw_description.render_pass = render_pass;
+            draw_description.subpass = 0;
+        }
+        pending_draw = compiler.compile(std::move(draw_description));
+    }
+
+    void object_culler::wait_pipelines() {
+        if (pending_cull.valid()) {
+            cull_pipeline = unique_pipeline(device, pending_cull.get());
+        }
+        if (pending_draw.valid()) {
+            draw_pipeline = unique_pipeline(device, pending_draw.get());
+        }
+    }
+
+    bool object_culler::reload_ready() const {
+        return pipeline_ready(pending_cull) && pipeline_ready(pending_draw);
+    }
+
+    void object_culler::swap_pipelines(deletion_queue& deletions, std::uint64_t retire_value) {
+        if (pending_cull.valid()) {
+            deletions.retire(retire_value, std::exchange(cull_pipeline, unique_pipeline(device, pending_cull.get())));
+        }
+        if (pending_draw.valid()) {
+            deletions.retire(retire_value, std::exchange(draw_pipeline, unique_pipeline(device, pending_draw.get())));
+        }
+    }
+
+    void object_culler::destroy() {
+        // Pipelines of a shader reload that was never swapped in
+        try {
+            wait_pipelines();
+        } catch (const std::exception&) {}
+        cull_pipeline.reset();
+        draw_pipeline.reset();
+        layout.reset();
+        descriptor_pool.reset();
+        set_layout.reset();
+        for (auto* buffer : { &object_buffer, &submesh_buffer, &draw_buffer, &count_buffer }) {
+            if (buffer->buffer) {
+                allocator->destroy_buffer(*buffer);
+                *buffer = {};
+            }
+        }
+        objects.clear();
+        active_count = 0;
+    }
+
+    bool object_culler::enabled() const {
+        return !objects.empty();
+    }
+
+    std::uint32_t object_culler::size() const {
+        return active_count;
+    }
+
+    std::uint32_t object_culler::capacity() const {
+        return static_cast<std::uint32_t>(objects.size());
+    }
+
+    void object_culler::resize(std::uint32_t count) {
+        active_count = std::min(count, capacity());
+    }
+
+    void object_culler::record_culling(const VkCommandBuffer& command_buffer, const cull_view& view) const {
+        // Ordering against the previous frame's draws and this frame's is up to the caller's render graph,
+        // draw_commands() and draw_count() are written at transfer and compute and read as indirect commands
+        vkCmdFillBuffer(command_buffer, count_buffer.buffer, 0, sizeof(std::uint32_t), 0);
+        // Without a count the whole buffer is drawn, the slots past the visible ones need zero instances
+        if (!draw_indirect_count) {
+            vkCmdFillBuffer(command_buffer, draw_buffer.buffer, 0, VK_WHOLE_SIZE, 0);
+        }
+
+        VkMemoryBarrier before_cull{}; {
+            before_cull.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+            before_cull.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            before_cull.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        }
+
+        vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             0, 1, &before_cull, 0, nullptr, 0, nullptr);
+
+        const cull_constants constants{ view, active_count, static_cast<std::uint32_t>(geometry->submeshes.size()) };
+        vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, cull_pipeline);
+        vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, layout, 0, 1, &descriptor_set, 0, nullptr);
+        vkCmdPushConstants(command_buffer, layout, VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(constants), &constants);
+        vkCmdDispatch(command_buffer, (active_count + workgroup_size - 1) / workgroup_size, 1, 1);
+    }
+
+    VkBuffer object_culler::draw_commands() const {
+        return draw_buffer.buffer;
+    }
+
+    VkBuffer object_culler::draw_count() const {
+        return count_buffer.buffer;
+    }
+
+    void object_culler::bind_draw_state(const VkCommandBuffer& command_buffer, const cull_view& view) const {
+        constexpr VkDeviceSize vertex_offset = 0;
+        const cull_constants constants{ view, active_count, static_cast<std::uint32_t>(geometry->submeshes.size()) };
+        vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, draw_pipeline);
+        vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, layout, 0, 1, &descriptor_set, 0, nullptr);
+        vkCmdPushConstants(command_buffer, layout, VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(constants), &constants);
+        vkCmdBindVertexBuffers(command_buffer, 0, 1, &geometry->buffers.vertices.buffer, &vertex_offset);
+        vkCmdBindIndexBuffer(command_buffer, geometry->buffers.indices.buffer, 0, vk_index_type);
+    }
+
+    void object_culler::record_indirect_draw(const VkCommandBuffer& command_buffer, const cull_view& view) const {
+        bind_draw_state(command_buffer, view);
+
+        const auto draws = active_count * static_cast<std::uint32_t>(geometry->submeshes.size());
+        if (draw_indirect_count) {
+            draw_indirect_count(command_buffer, draw_buffer.buffer, 0, count_buffer.buffer, 0, draws, sizeof(VkDrawIndexedIndirectCommand));
+        } else {
+            vkCmdDrawIndexedIndirect(command_buffer, draw_buffer.buffer, 0, draws, sizeof(VkDrawIndexedIndirectCommand));
+        }
+    }
+
+    std::uint32_t object_culler::cull_cpu(const cull_view& view) {
+        return scene.cull(view_frustum(view), active_count);
+    }
+
+    std::uint32_t object_culler::record_cpu_draws(const VkCommandBuffer& command_buffer, const cull_view& view, std::uint32_t first, std::uint32_t count) const {
+        bind_draw_state(command_buffer, view);
+
+        std::uint32_t drawn = 0;
+        const auto last = std::min(first + count, active_count);
+        for (std::uint32_t i = first; i < last; ++i) {
+            if (!scene.visible(i)) {
+                continue;
+            }
+
+            for (const auto& submesh : geometry->submeshes) {
+                vkCmdDrawIndexed(command_buffer, submesh.index_count, 1, submesh.first_index, submesh.vertex_offset, i);
+            }
+            ++drawn;
+        }
+
+        return drawn;
+    }
+} // namespace vk_playground
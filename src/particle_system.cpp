@@ -0,0 +1,304 @@
+#include "particle_system.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <shader_watcher.hpp>
+
+namespace vk_playground {
+    void particle_system::create(const VkDevice& device, memory_allocator& allocator, upload_manager& uploads, shader_module_cache& shaders, pipeline_compiler& compiler,
+                                 const std::filesystem::path& shader_directory, const VkRenderPass& render_pass, std::uint32_t count,
+                                 bool async, std::vector<std::uint32_t> queue_families) {
+        this->device = device;
+        this->allocator = &allocator;
+        this->shader_directory = shader_directory;
+        this->render_pass = render_pass;
+        this->async = async;
+        particle_count = count;
+
+        std::sort(queue_families.begin(), queue_families.end());
+        queue_families.erase(std::unique(queue_families.begin(), queue_families.end()), queue_families.end());
+
+        // Ownership transfers every frame in both directions would cost more barriers than the
+        // overlap saves, shared buffers are concurrent instead
+        VkBufferCreateInfo buffer_info{}; {
+            buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+            buffer_info.size = VkDeviceSize(count) * sizeof(particle);
+            buffer_info.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+            if (queue_families.size() > 1) {
+                buffer_info.sharingMode = VK_SHARING_MODE_CONCURRENT;
+                buffer_info.queueFamilyIndexCount = queue_families.size();
+                buffer_info.pQueueFamilyIndices = queue_families.data();
+            } else {
+                buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+            }
+        }
+        particles.resize(async ? 2 : 1);
+        for (auto& buffer : particles) {
+            buffer = allocator.create_buffer(buffer_info, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        }
+
+        // Fixed seed, every run simulates the same particles
+        auto initial = std::make_shared<std::vector<particle>>(count);
+        std::mt19937 generator(1337);
+        std::uniform_real_distribution<float> position(-1.0f, 1.0f);
+        std::uniform_real_distribution<float> velocity(-0.5f, 0.5f);
+        for (auto& state : *initial) {
+            state = { { position(generator), position(generator), 0.0f, 1.0f }, { velocity(generator), velocity(generator), 0.0f, 0.0f } };
+        }
+        // Step 0 reads the first buffer, the second one is written before anything reads it
+        uploads.upload(particles.front().buffer, 0, std::as_bytes(std::span(*initial)), initial);
+
+        create_descriptors();
+        create_pipeline_layouts();
+        compile_pipelines(shaders, compiler);
+    }
+
+    void particle_system::create_descriptors() {
+        // Binding 0 is read, binding 1 written. Integrating in place binds the same buffer to both
+        VkDescriptorSetLayoutBinding bindings[2]{};
+        for (std::uint32_t i = 0; i < 2; ++i) {
+            bindings[i].binding = i;
+            bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            bindings[i].descriptorCount = 1;
+            bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        }
+
+        VkDescriptorSetLayoutCreateInfo set_layout_info{}; {
+            set_layout_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+            set_layout_info.bindingCount = 2;
+            set_layout_info.pBindings = bindings;
+        }
+
+        if (vkCreateDescriptorSetLayout(device, &set_layout_info, nullptr, set_layout.put(device)) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create particle descriptor set layout");
+        }
+
+        const auto set_count = static_cast<std::uint32_t>(particles.size());
+
+        VkDescriptorPoolSize pool_size{}; {
+            pool_size.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            pool_size.descriptorCount = 2 * set_count;
+        }
+
+        VkDescriptorPoolCreateInfo pool_info{}; {
+            pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+            pool_info.maxSets = set_count;
+            pool_info.poolSizeCount = 1;
+            pool_info.pPoolSizes = &pool_size;
+        }
+
+        if (vkCreateDescriptorPool(device, &pool_info, nullptr, descriptor_pool.put(device)) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create particle descriptor pool");
+        }
+
+        const std::vector<VkDescriptorSetLayout> set_layouts(set_count, set_layout);
+        descriptor_sets.resize(set_count);
+
+        VkDescriptorSetAllocateInfo set_info{}; {
+            set_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+            set_info.descriptorPool = descriptor_pool;
+            set_info.descriptorSetCount = set_count;
+            set_info.pSetLayouts = set_layouts.data();
+        }
+
+        if (vkAllocateDescriptorSets(device, &set_info, descriptor_sets.data()) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to allocate particle descriptor sets");
+        }
+
+        // Set i reads buffer i and writes the next one
+        std::vector<VkDescriptorBufferInfo> buffer_infos(2 * set_count);
+        std::vector<VkWriteDescriptorSet> writes(2 * set_count);
+        for (std::uint32_t i = 0; i < 2 * set_count; ++i) {
+            const auto set = i / 2;
+            const auto binding = i % 2;
+
+            auto& buffer_info = buffer_infos[i]; {
+                buffer_info.buffer = particles[(set + binding) % set_count].buffer;
+                buffer_info.offset = 0;
+                buffer_info.range = VK_WHOLE_SIZE;
+            }
+
+            auto& write = writes[i]; {
+                write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                write.dstSet = descriptor_sets[set];
+                write.dstBinding = binding;
+                write.descriptorCount = 1;
+                write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+                write.pBufferInfo = &buffer_info;
+            }
+        }
+
+        vkUpdateDescriptorSets(device, writes.size(), writes.data(), 0, nullptr);
+    }
+
+    void particle_system::create_pipeline_layouts() {
+        VkPushConstantRange push_constants{}; {
+            push_constants.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+            push_constants.offset = 0;
+            push_constants.size = sizeof(simulation_constants);
+        }
+
+        VkPipelineLayoutCreateInfo simulate_layout_info{}; {
+            simulate_layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+            simulate_layout_info.setLayoutCount = 1;
+            simulate_layout_info.pSetLayouts = set_layout.address();
+            simulate_layout_info.pushConstantRangeCount = 1;
+            simulate_layout_info.pPushConstantRanges = &push_constants;
+        }
+
+        // Drawing reads the particles as vertex input, it needs no descriptors
+        VkPipelineLayoutCreateInfo draw_layout_info{}; {
+            draw_layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        }
+
+        if (vkCreatePipelineLayout(device, &simulate_layout_info, nullptr, simulate_layout.put(device)) != VK_SUCCESS ||
+            vkCreatePipelineLayout(device, &draw_layout_info, nullptr, draw_layout.put(device)) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create particle pipeline layouts");
+        }
+    }
+
+    std::vector<std::filesystem::path> particle_system::shader_sources() const {
+        return { shader_directory / "particles.comp", shader_directory / "particles.vert", shader_directory / "triangle.frag" };
+    }
+
+    void particle_system::compile_pipelines(shader_module_cache& shaders, pipeline_compiler& compiler) {
+        const auto simulate_source = shader_directory / "particles.comp";
+        const auto vertex_source = shader_directory / "particles.vert";
+        // Same color passthrough as the triangle, the module cache hands back the existing module
+        const auto fragment_source = shader_directory / "triangle.frag";
+
+        shader simulate_shader{};
+        simulate_shader.add_stage(VK_SHADER_STAGE_COMPUTE_BIT, compiled_shader_path(simulate_source), shaders);
+
+        compute_pipeline_description simulate_description{}; {
+            simulate_description.stage = simulate_shader.stages().front();
+            simulate_description.layout = simulate_layout;
+        }
+        pending_simulate = compiler.compile(simulate_description);
+
+        shader draw_shader{};
+        draw_shader
+            .add_stage(VK_SHADER_STAGE_VERTEX_BIT, compiled_shader_path(vertex_source), shaders)
+            .add_stage(VK_SHADER_STAGE_FRAGMENT_BIT, compiled_shader_path(fragment_source), shaders);
+
+        graphics_pipeline_description draw_description{}; {
+            draw_description.stages = draw_shader.stages();
+
+            VkVertexInputBindingDescription binding{}; {
+                binding.binding = 0;
+                binding.stride = sizeof(particle);
+                binding.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+            }
+            draw_description.vertex_bindings = { binding };
+
+            VkVertexInputAttributeDescription position{}; {
+                position.binding = 0;
+                position.location = 0;
+                position.format = VK_FORMAT_R32G32B32A32_SFLOAT;
+                position.offset = offsetof(particle, position);
+            }
+            VkVertexInputAttributeDescription velocity{}; {
+                velocity.binding = 0;
+                velocity.location = 1;
+                velocity.format = VK_FORMAT_R32G32B32A32_SFLOAT;
+                velocity.offset = offsetof(particle, velocity);
+            }
+            draw_description.vertex_attributes = { position, velocity };
+
+            draw_description.topology = VK_PRIMITIVE_TOPOLOGY_POINT_LIST;
+            draw_description.dynamic_states = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+            draw_description.layout = draw_layout;
+            draw_description.render_pass = render_pass;
+            draw_description.subpass = 0;
+        }
+        pending_draw = compiler.compile(std::move(draw_description));
+    }
+
+    void particle_system::wait_pipelines() {
+        if (pending_simulate.valid()) {
+            simulate_pipeline = unique_pipeline(device, pending_simulate.get());
+        }
+        if (pending_draw.valid()) {
+            draw_pipeline = unique_pipeline(device, pending_draw.get());
+        }
+    }
+
+    bool particle_system::reload_ready() const {
+        return pipeline_ready(pending_simulate) && pipeline_ready(pending_draw);
+    }
+
+    void particle_system::swap_pipelines(deletion_queue& deletions, std::uint64_t retire_value) {
+        if (pending_simulate.valid()) {
+            deletions.retire(retire_value, std::exchange(simulate_pipeline, unique_pipeline(device, pending_simulate.get())));
+        }
+        if (pending_draw.valid()) {
+            deletions.retire(retire_value, std::exchange(draw_pipeline, unique_pipeline(device, pending_draw.get())));
+        }
+    }
+
+    void particle_system::destroy() {
+        // Pipelines of a shader reload that was never swapped in
+        try {
+            wait_pipelines();
+        } catch (const std::exception&) {}
+        simulate_pipeline.reset();
+        draw_pipeline.reset();
+        simulate_layout.reset();
+        draw_layout.reset();
+        descriptor_pool.reset();
+        set_layout.reset();
+        for (const auto& buffer : particles) {
+            allocator->destroy_buffer(buffer);
+        }
+        particles.clear();
+        descriptor_sets.clear();
+        particle_count = 0;
+    }
+
+    bool particle_system::enabled() const {
+        return particle_count > 0;
+    }
+
+    std::uint32_t particle_system::size() const {
+        return particle_count;
+    }
+
+    void particle_system::record_simulation(const VkCommandBuffer& command_buffer, std::uint64_t step) const {
+        // Consecutive steps on the compute queue only have each other to wait for, the previous
+        // dispatch wrote what this one reads. The draws reading the result are covered by the semaphores
+        if (async) {
+            VkMemoryBarrier before{}; {
+                before.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+                before.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+                before.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+            }
+
+            vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                 0, 1, &before, 0, nullptr, 0, nullptr);
+        }
+
+        const simulation_constants constants{ time_step, particle_count };
+        const auto& descriptor_set = descriptor_sets[step % descriptor_sets.size()];
+        vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, simulate_pipeline);
+        vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, simulate_layout, 0, 1, &descriptor_set, 0, nullptr);
+        vkCmdPushConstants(command_buffer, simulate_layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(constants), &constants);
+        vkCmdDispatch(command_buffer, (particle_count + workgroup_size - 1) / workgroup_size, 1, 1);
+    }
+
+    VkBuffer particle_system::buffer(std::uint64_t step) const {
+        return particles[step % particles.size()].buffer;
+    }
+
+    void particle_system::record_draw(const VkCommandBuffer& command_buffer, std::uint64_t step) const {
+        constexpr VkDeviceSize offset = 0;
+        const auto drawn = buffer(step);
+        vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, draw_pipeline);
+        vkCmdBindVertexBuffers(command_buffer, 0, 1, &drawn, &offset);
+        vkCmdDraw(command_buffer, particle_count, 1, 0, 0);
+    }
+} // namespace vk_playground
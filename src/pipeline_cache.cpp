@@ -0,0 +1,106 @@
+#include "pipeline_cache.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace vk_playground {
+    bool pipeline_cache::is_compatible(const std::vector<char>& data, const VkPhysicalDeviceProperties& properties) {
+        VkPipelineCacheHeaderVersionOne header{};
+
+        if (data.size() < sizeof(header)) {
+            return false;
+        }
+
+        std::memcpy(&header, data.data(), sizeof(header));
+
+        return header.headerSize >= sizeof(header) &&
+               header.headerSize <= data.size() &&
+               header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+               header.vendorID == properties.vendorID &&
+               header.deviceID == properties.deviceID &&
+               std::memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+    }
+
+    void pipeline_cache::create(const VkDevice& logical_device, const VkPhysicalDeviceProperties& properties, const std::filesystem::path& cache_path) {
+        device = logical_device;
+        path = cache_path;
+
+        std::vector<char> data{};
+        if (!path.empty()) {
+            std::ifstream file(path, std::ios::binary | std::ios::ate);
+            if (file.is_open()) {
+                data.resize(static_cast<std::size_t>(file.tellg()));
+                file.seekg(0);
+                file.read(data.data(), data.size());
+            }
+        }
+
+        // Blobs from another driver or device are discarded, the implementation would ignore them anyway
+        warm = !data.empty() && is_compatible(data, properties);
+        if (!data.empty() && !warm) {
+            std::cout << "Discarding incompatible pipeline cache " << path.generic_string() << '\n';
+        }
+
+        VkPipelineCacheCreateInfo cache_create_info{}; {
+            cache_create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+            cache_create_info.initialDataSize = warm ? data.size() : 0;
+            cache_create_info.pInitialData = warm ? data.data() : nullptr;
+        }
+
+        if (vkCreatePipelineCache(device, &cache_create_info, nullptr, &cache) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create pipeline cache");
+        }
+    }
+
+    void pipeline_cache::save() const {
+        if (path.empty() || cache == nullptr) {
+            return;
+        }
+
+        std::size_t size{};
+        vkGetPipelineCacheData(device, cache, &size, nullptr);
+        std::vector<char> data(size);
+        if (vkGetPipelineCacheData(device, cache, &size, data.data()) != VK_SUCCESS) {
+            return;
+        }
+
+        // Write next to the target and rename over it, a crash mid-write never leaves a torn cache behind
+        auto temporary = path;
+        temporary += ".tmp";
+        {
+            std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+            if (!file.is_open()) {
+                std::cout << "Can't write pipeline cache " << temporary.generic_string() << '\n';
+                return;
+            }
+            file.write(data.data(), size);
+            if (!file.flush()) {
+                return;
+            }
+        }
+
+        std::error_code error{};
+        std::filesystem::rename(temporary, path, error);
+        if (error) {
+            std::cout << "Can't replace pipeline cache " << path.generic_string() << ": " << error.message() << '\n';
+            std::filesystem::remove(temporary, error);
+        }
+    }
+
+    void pipeline_cache::destroy() {
+        if (cache == nullptr) {
+            return;
+        }
+        vkDestroyPipelineCache(device, cache, nullptr);
+        cache = nullptr;
+    }
+
+    VkPipelineCache pipeline_cache::handle() const {
+        return cache;
+    }
+
+    bool pipeline_cache::loaded_from_disk() const {
+        return warm;
+    }
+} // namespace vk_playground
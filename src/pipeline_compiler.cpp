@@ -0,0 +1,185 @@
+#include "pipeline_compiler.hpp"
+
+#include <chrono>
+#include <stdexcept>
+
+namespace vk_playground {
+    void pipeline_compiler::create(const VkDevice& logical_device, const VkPipelineCache& pipeline_cache, thread_pool& pool) {
+        device = logical_device;
+        cache = pipeline_cache;
+        workers = &pool;
+    }
+
+    std::future<VkPipeline> pipeline_compiler::compile(graphics_pipeline_description description) {
+        return workers->submit([this, description = std::move(description)]() {
+            return build(description);
+        });
+    }
+
+    std::future<VkPipeline> pipeline_compiler::compile(compute_pipeline_description description) {
+        return workers->submit([this, description]() {
+            return build(description);
+        });
+    }
+
+    std::vector<std::future<VkPipeline>> pipeline_compiler::compile(std::vector<graphics_pipeline_description> descriptions) {
+        std::vector<std::future<VkPipeline>> result{};
+        result.reserve(descriptions.size());
+
+        for (auto& description : descriptions) {
+            result.emplace_back(compile(std::move(description)));
+        }
+
+        return result;
+    }
+
+    double pipeline_compiler::compile_ms() const {
+        return compile_ns.load() / 1e6;
+    }
+
+    bool pipeline_ready(const std::future<VkPipeline>& pending) {
+        return !pending.valid() || pending.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    }
+
+    VkPipeline pipeline_compiler::build(const graphics_pipeline_description& description) {
+        const auto start = std::chrono::steady_clock::now();
+
+        VkPipelineVertexInputStateCreateInfo vertex_input_info{}; {
+            vertex_input_info.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+            vertex_input_info.vertexBindingDescriptionCount = description.vertex_bindings.size();
+            vertex_input_info.pVertexBindingDescriptions = description.vertex_bindings.data();
+            vertex_input_info.vertexAttributeDescriptionCount = description.vertex_attributes.size();
+            vertex_input_info.pVertexAttributeDescriptions = description.vertex_attributes.data();
+        }
+
+        VkPipelineInputAssemblyStateCreateInfo input_assembly{}; {
+            input_assembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+            input_assembly.topology = description.topology;
+            input_assembly.primitiveRestartEnable = false;
+        }
+
+        VkViewport viewport{}; {
+            viewport.x = 0.0f;
+            viewport.y = 0.0f;
+            viewport.width = static_cast<float>(description.extent.width);
+            viewport.height = static_cast<float>(description.extent.height);
+            viewport.minDepth = 0.0f;
+            viewport.maxDepth = 1.0f;
+        }
+
+        VkRect2D scissor{}; {
+            scissor.extent = description.extent;
+            scissor.offset = { 0, 0 };
+        }
+
+        VkPipelineViewportStateCreateInfo viewport_state_info{}; {
+            viewport_state_info.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+            viewport_state_info.viewportCount = 1;
+            viewport_state_info.pViewports = &viewport;
+            viewport_state_info.scissorCount = 1;
+            viewport_state_info.pScissors = &scissor;
+        }
+
+        VkPipelineRasterizationStateCreateInfo rasterizer_state_info{}; {
+            rasterizer_state_info.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+            rasterizer_state_info.depthClampEnable = false;
+            rasterizer_state_info.rasterizerDiscardEnable = false;
+            rasterizer_state_info.polygonMode = description.polygon_mode;
+            rasterizer_state_info.lineWidth = 1.0f;
+            rasterizer_state_info.cullMode = description.cull_mode;
+            rasterizer_state_info.frontFace = description.front_face;
+            rasterizer_state_info.depthBiasEnable = false;
+        }
+
+        VkPipelineMultisampleStateCreateInfo multisampling_state_info{}; {
+            multisampling_state_info.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+            multisampling_state_info.sampleShadingEnable = false;
+            multisampling_state_info.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+            multisampling_state_info.minSampleShading = 1.0f;
+            multisampling_state_info.pSampleMask = nullptr;
+            multisampling_state_info.alphaToCoverageEnable = false;
+            multisampling_state_info.alphaToOneEnable = false;
+        }
+
+        VkPipelineColorBlendAttachmentState color_blend_attachment{}; {
+            color_blend_attachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT |
+                                                    VK_COLOR_COMPONENT_G_BIT |
+                                                    VK_COLOR_COMPONENT_B_BIT |
+                                                    VK_COLOR_COMPONENT_A_BIT;
+            color_blend_attachment.blendEnable = false;
+            color_blend_attachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+            color_blend_attachment.dstColorBlendFactor = VK_BLEND_FACTOR_ZERO;
+            color_blend_attachment.colorBlendOp = VK_BLEND_OP_ADD;
+            color_blend_attachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+            color_blend_attachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+            color_blend_attachment.alphaBlendOp = VK_BLEND_OP_ADD;
+        }
+
+        VkPipelineColorBlendStateCreateInfo color_blend_info{}; {
+            color_blend_info.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+            color_blend_info.logicOpEnable = false;
+            color_blend_info.logicOp = VK_LOGIC_OP_COPY;
+            color_blend_info.attachmentCount = 1;
+            color_blend_info.pAttachments = &color_blend_attachment;
+            color_blend_info.blendConstants[0] = 0.0f;
+            color_blend_info.blendConstants[1] = 0.0f;
+            color_blend_info.blendConstants[2] = 0.0f;
+            color_blend_info.blendConstants[3] = 0.0f;
+        }
+
+        VkPipelineDynamicStateCreateInfo dynamic_state_info{}; {
+            dynamic_state_info.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+            dynamic_state_info.dynamicStateCount = description.dynamic_states.size();
+            dynamic_state_info.pDynamicStates = description.dynamic_states.data();
+        }
+
+        VkGraphicsPipelineCreateInfo pipeline_info{}; {
+            pipeline_info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+            pipeline_info.stageCount = description.stages.size();
+            pipeline_info.pStages = description.stages.data();
+            pipeline_info.pVertexInputState = &vertex_input_info;
+            pipeline_info.pInputAssemblyState = &input_assembly;
+            pipeline_info.pViewportState = &viewport_state_info;
+            pipeline_info.pRasterizationState = &rasterizer_state_info;
+            pipeline_info.pMultisampleState = &multisampling_state_info;
+            pipeline_info.pDepthStencilState = nullptr;
+            pipeline_info.pColorBlendState = &color_blend_info;
+            pipeline_info.pDynamicState = description.dynamic_states.empty() ? nullptr : &dynamic_state_info;
+            pipeline_info.layout = description.layout;
+            pipeline_info.renderPass = description.render_pass;
+            pipeline_info.subpass = description.subpass;
+            pipeline_info.basePipelineHandle = nullptr;
+            pipeline_info.basePipelineIndex = -1;
+        }
+
+        VkPipeline pipeline{};
+        if (vkCreateGraphicsPipelines(device, cache, 1, &pipeline_info, nullptr, &pipeline) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create graphics pipeline");
+        }
+
+        compile_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+        return pipeline;
+    }
+
+    VkPipeline pipeline_compiler::build(const compute_pipeline_description& description) {
+        const auto start = std::chrono::steady_clock::now();
+
+        VkComputePipelineCreateInfo pipeline_info{}; {
+            pipeline_info.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+            pipeline_info.stage = description.stage;
+            pipeline_info.layout = description.layout;
+            pipeline_info.basePipelineHandle = nullptr;
+            pipeline_info.basePipelineIndex = -1;
+        }
+
+        VkPipeline pipeline{};
+        if (vkCreateComputePipelines(device, cache, 1, &pipeline_info, nullptr, &pipeline) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create compute pipeline");
+        }
+
+        compile_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+        return pipeline;
+    }
+} // namespace vk_playground
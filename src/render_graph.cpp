@@ -0,0 +1,484 @@
+#include "render_graph.hpp"
+
+#include <algorithm>
+#include <optional>
+#include <stdexcept>
+
+#include <fmt/format.h>
+
+namespace vk_playground {
+    constexpr VkAccessFlags write_access_mask =
+        VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
+        VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_HOST_WRITE_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+
+    // Synchronization state of one resource while walking the passes: the last write, and the
+    // stages that already read it after a barrier made it visible to them
+    struct tracked_state {
+        VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+        VkPipelineStageFlags write_stages{};
+        VkAccessFlags write_access{};
+        VkPipelineStageFlags read_stages{};
+    };
+
+    // Moves state to the next use, returns the barrier needed before it if any
+    static std::optional<std::pair<resource_state, resource_state>> advance(tracked_state& state, const resource_state& use, bool image) {
+        const auto writes = use.access & write_access_mask;
+        const auto layout_change = image && use.layout != state.layout;
+
+        if (!writes && !layout_change) {
+            // Reads after reads need nothing, a read from a new stage only waits for the last write
+            const auto new_stages = use.stages & ~state.read_stages;
+            state.read_stages |= use.stages;
+            if (new_stages == 0 || state.write_stages == 0) {
+                return std::nullopt;
+            }
+            return std::pair{ resource_state{ state.write_stages, state.write_access, state.layout }, use };
+        }
+
+        // Writes and layout transitions wait for everything since the last write, reads included
+        const resource_state before{ state.write_stages | state.read_stages, state.write_access, state.layout };
+        state.layout = image ? use.layout : state.layout;
+        state.write_stages = use.stages;
+        state.write_access = writes;
+        // A transition for a read is a write the later reads must be ordered after
+        state.read_stages = writes ? 0 : use.stages;
+        return std::pair{ before, use };
+    }
+
+    static VkImageAspectFlags format_aspect(VkFormat format) {
+        switch (format) {
+            case VK_FORMAT_D16_UNORM:
+            case VK_FORMAT_X8_D24_UNORM_PACK32:
+            case VK_FORMAT_D32_SFLOAT:
+                return VK_IMAGE_ASPECT_DEPTH_BIT;
+            case VK_FORMAT_D16_UNORM_S8_UINT:
+            case VK_FORMAT_D24_UNORM_S8_UINT:
+            case VK_FORMAT_D32_SFLOAT_S8_UINT:
+                return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+            case VK_FORMAT_S8_UINT:
+                return VK_IMAGE_ASPECT_STENCIL_BIT;
+            default:
+                return VK_IMAGE_ASPECT_COLOR_BIT;
+        }
+    }
+
+    std::string compiled_graph_info::summary() const {
+        std::string result = fmt::format("render graph: {} passes ({} culled), {} barriers, transients {} KiB in {} KiB over {} allocations\n",
+                                         passes.size(), culled_passes.size(), barriers.size(),
+                                         transient_bytes / 1024, allocated_bytes / 1024, memory_slots);
+        for (const auto& barrier : barriers) {
+            result += fmt::format("  {:<16}{:<20}stages {:#x} -> {:#x}, access {:#x} -> {:#x}, layout {} -> {}{}\n",
+                                  barrier.pass.empty() ? "(end)" : barrier.pass, barrier.resource,
+                                  barrier.before.stages, barrier.after.stages, barrier.before.access, barrier.after.access,
+                                  static_cast<std::int32_t>(barrier.before.layout), static_cast<std::int32_t>(barrier.after.layout),
+                                  barrier.aliasing ? ", aliasing" : "");
+        }
+        for (const auto& name : culled_passes) {
+            result += fmt::format("  {:<16}culled\n", name);
+        }
+        return result;
+    }
+
+    render_graph::pass_builder::pass_builder(render_graph* graph, std::uint32_t pass)
+        : graph(graph), pass(pass) {}
+
+    render_graph::pass_builder& render_graph::pass_builder::use(graph_resource resource, const resource_state& state) {
+        if (resource.index >= graph->resources.size()) {
+            throw std::runtime_error("Error, render graph pass uses an unknown resource");
+        }
+        graph->passes[pass].uses.push_back({ resource.index, state });
+        return *this;
+    }
+
+    render_graph::pass_builder& render_graph::pass_builder::side_effects() {
+        graph->passes[pass].side_effects = true;
+        return *this;
+    }
+
+    render_graph::~render_graph() {
+        destroy();
+    }
+
+    graph_resource render_graph::import_image(std::string name, VkImageAspectFlags aspect, const resource_state& initial, const resource_state& final) {
+        auto& imported = resources.emplace_back();
+        imported.name = std::move(name);
+        imported.image = true;
+        imported.imported = true;
+        imported.aspect = aspect;
+        imported.initial = initial;
+        imported.final = final;
+        return { static_cast<std::uint32_t>(resources.size() - 1) };
+    }
+
+    graph_resource render_graph::import_buffer(std::string name, VkBuffer buffer) {
+        auto& imported = resources.emplace_back();
+        imported.name = std::move(name);
+        imported.imported = true;
+        imported.buffer_handle = buffer;
+        return { static_cast<std::uint32_t>(resources.size() - 1) };
+    }
+
+    graph_resource render_graph::create_image(std::string name, const transient_image_description& description) {
+        auto& transient = resources.emplace_back();
+        transient.name = std::move(name);
+        transient.image = true;
+        transient.aspect = format_aspect(description.format);
+        transient.description = description;
+        return { static_cast<std::uint32_t>(resources.size() - 1) };
+    }
+
+    render_graph::pass_builder render_graph::add_pass(std::string name, pass_callback callback) {
+        auto& added = passes.emplace_back();
+        added.name = std::move(name);
+        added.callback = std::move(callback);
+        return { this, static_cast<std::uint32_t>(passes.size() - 1) };
+    }
+
+    std::vector<std::uint32_t> render_graph::cull_passes() const {
+        // Backwards from what's observable after the frame: imported resources and side effects.
+        // A pass stays if it writes something a later kept pass or the frame's output needs
+        std::vector<bool> needed(resources.size());
+        for (std::uint32_t i = 0; i < resources.size(); ++i) {
+            needed[i] = resources[i].imported;
+        }
+
+        std::vector<std::uint32_t> live{};
+        for (auto i = static_cast<std::int64_t>(passes.size()) - 1; i >= 0; --i) {
+            const auto& current = passes[i];
+            auto keep = current.side_effects;
+            for (const auto& use : current.uses) {
+                keep = keep || ((use.state.access & write_access_mask) != 0 && needed[use.resource]);
+            }
+            if (!keep) {
+                continue;
+            }
+            for (const auto& use : current.uses) {
+                needed[use.resource] = true;
+            }
+            live.push_back(static_cast<std::uint32_t>(i));
+        }
+
+        std::reverse(live.begin(), live.end());
+        return live;
+    }
+
+    void render_graph::allocate_transients() {
+        for (auto& current : resources) {
+            current.first_use = UINT32_MAX;
+            current.last_use = 0;
+        }
+        for (std::uint32_t position = 0; position < plan.size(); ++position) {
+            for (const auto& use : passes[plan[position].pass].uses) {
+                auto& used = resources[use.resource];
+                used.first_use = std::min(used.first_use, position);
+                used.last_use = std::max(used.last_use, position);
+            }
+        }
+
+        std::vector<std::uint32_t> transients{};
+        for (std::uint32_t i = 0; i < resources.size(); ++i) {
+            auto& transient = resources[i];
+            if (transient.imported || transient.first_use == UINT32_MAX) {
+                continue;
+            }
+
+            VkImageCreateInfo image_info{}; {
+                image_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+                image_info.imageType = VK_IMAGE_TYPE_2D;
+                image_info.format = transient.description.format;
+                image_info.extent = { transient.description.extent.width, transient.description.extent.height, 1 };
+                image_info.mipLevels = 1;
+                image_info.arrayLayers = 1;
+                image_info.samples = VK_SAMPLE_COUNT_1_BIT;
+                image_info.tiling = VK_IMAGE_TILING_OPTIMAL;
+                image_info.usage = transient.description.usage;
+                image_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+                image_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            }
+
+            if (vkCreateImage(device, &image_info, nullptr, transient.owned_image.put(device)) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to create render graph image " + transient.name);
+            }
+            vkGetImageMemoryRequirements(device, transient.owned_image, &transient.requirements);
+            transient.image_handle = transient.owned_image;
+            compiled.transient_bytes += transient.requirements.size;
+            transients.push_back(i);
+        }
+
+        // Largest first, each into the first slot whose memory types fit and whose occupants are all dead by then
+        std::stable_sort(transients.begin(), transients.end(), [this](std::uint32_t left, std::uint32_t right) {
+            return resources[left].requirements.size > resources[right].requirements.size;
+        });
+
+        std::vector<VkMemoryRequirements> slots{};
+        std::vector<std::vector<std::uint32_t>> occupants{};
+        for (const auto index : transients) {
+            auto& transient = resources[index];
+            for (std::uint32_t slot = 0; slot < slots.size() && transient.slot == UINT32_MAX; ++slot) {
+                if ((slots[slot].memoryTypeBits & transient.requirements.memoryTypeBits) == 0) {
+                    continue;
+                }
+                const auto overlaps = std::any_of(occupants[slot].begin(), occupants[slot].end(), [&](std::uint32_t other) {
+                    return resources[other].first_use <= transient.last_use && transient.first_use <= resources[other].last_use;
+                });
+                if (!overlaps) {
+                    transient.slot = slot;
+                }
+            }
+            if (transient.slot == UINT32_MAX) {
+                transient.slot = static_cast<std::uint32_t>(slots.size());
+                slots.push_back(transient.requirements);
+                occupants.emplace_back();
+            }
+
+            auto& slot = slots[transient.slot];
+            slot.size = std::max(slot.size, transient.requirements.size);
+            slot.alignment = std::max(slot.alignment, transient.requirements.alignment);
+            slot.memoryTypeBits &= transient.requirements.memoryTypeBits;
+            occupants[transient.slot].push_back(index);
+        }
+
+        for (const auto& slot : slots) {
+            memory_slots.push_back(allocator->allocate(slot, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0, resource_kind::optimal));
+            compiled.allocated_bytes += slot.size;
+        }
+        compiled.memory_slots = static_cast<std::uint32_t>(slots.size());
+
+        for (const auto index : transients) {
+            auto& transient = resources[index];
+            const auto& memory = memory_slots[transient.slot];
+            vkBindImageMemory(device, transient.owned_image, memory.memory, memory.offset);
+
+            VkImageViewCreateInfo view_info{}; {
+                view_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+                view_info.image = transient.owned_image;
+                view_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
+                view_info.format = transient.description.format;
+                view_info.subresourceRange.aspectMask = transient.aspect;
+                view_info.subresourceRange.baseMipLevel = 0;
+                view_info.subresourceRange.levelCount = 1;
+                view_info.subresourceRange.baseArrayLayer = 0;
+                view_info.subresourceRange.layerCount = 1;
+            }
+
+            if (vkCreateImageView(device, &view_info, nullptr, transient.view.put(device)) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to create render graph image view " + transient.name);
+            }
+        }
+    }
+
+    void render_graph::plan_barriers() {
+        std::vector<tracked_state> states(resources.size());
+        std::vector<std::optional<tracked_state>> slot_states(memory_slots.size());
+        std::vector<std::uint32_t> slot_owner(memory_slots.size(), UINT32_MAX);
+        std::vector<bool> started(resources.size());
+
+        const auto reset = [&]() {
+            for (std::uint32_t i = 0; i < resources.size(); ++i) {
+                const auto& current = resources[i];
+                if (current.imported && current.image) {
+                    states[i] = { current.initial.layout, current.initial.stages, current.initial.access & write_access_mask, 0 };
+                } else if (!current.imported) {
+                    states[i] = {};
+                }
+                started[i] = false;
+            }
+        };
+
+        // Walked twice, the first walk only finds where buffers and transient memory are left at the end
+        // of a frame, which is where the next frame picks them up
+        for (const auto emit : { false, true }) {
+            reset();
+            for (std::uint32_t position = 0; position < plan.size(); ++position) {
+                auto& planned = plan[position];
+                const auto& current = passes[planned.pass];
+                for (const auto& use : current.uses) {
+                    const auto& used = resources[use.resource];
+                    auto aliasing = false;
+
+                    if (!used.imported && !started[use.resource]) {
+                        // Whatever the memory held last, the contents start undefined
+                        if (slot_states[used.slot]) {
+                            states[use.resource] = *slot_states[used.slot];
+                            states[use.resource].layout = VK_IMAGE_LAYOUT_UNDEFINED;
+                            aliasing = slot_owner[used.slot] != use.resource;
+                        }
+                        const auto reads = (use.state.access & ~write_access_mask) != 0 && (use.state.access & write_access_mask) == 0;
+                        if (reads && emit) {
+                            throw std::runtime_error("Error, render graph pass " + current.name + " reads " + used.name + " before it's written");
+                        }
+                    }
+
+                    started[use.resource] = true;
+                    const auto barrier = advance(states[use.resource], use.state, used.image);
+                    if (!used.imported) {
+                        slot_states[used.slot] = states[use.resource];
+                        slot_owner[used.slot] = use.resource;
+                    }
+                    if (!emit || !barrier) {
+                        continue;
+                    }
+
+                    // A second use in the same pass joins its barrier with the first
+                    auto merged = std::find_if(planned.barriers.begin(), planned.barriers.end(), [&](const planned_barrier& existing) {
+                        return existing.resource == use.resource;
+                    });
+                    if (merged != planned.barriers.end()) {
+                        merged->before.stages |= barrier->first.stages;
+                        merged->before.access |= barrier->first.access;
+                        merged->after.stages |= barrier->second.stages;
+                        merged->after.access |= barrier->second.access;
+                        merged->after.layout = barrier->second.layout;
+                        continue;
+                    }
+                    planned.barriers.push_back({ use.resource, barrier->first, barrier->second, aliasing });
+                }
+
+                if (emit) {
+                    for (const auto& barrier : planned.barriers) {
+                        compiled.barriers.push_back({ current.name, resources[barrier.resource].name, barrier.before, barrier.after, barrier.aliasing });
+                    }
+                }
+            }
+        }
+
+        for (std::uint32_t i = 0; i < resources.size(); ++i) {
+            const auto& current = resources[i];
+            if (!current.imported || !current.image) {
+                continue;
+            }
+            auto& state = states[i];
+            if (state.layout == current.final.layout && (state.write_access == 0 || current.final.access == 0)) {
+                continue;
+            }
+            const resource_state before{ state.write_stages | state.read_stages, state.write_access, state.layout };
+            final_barriers.push_back({ i, before, current.final, false });
+            compiled.barriers.push_back({ {}, current.name, before, current.final, false });
+        }
+    }
+
+    void render_graph::compile(const VkDevice& device, memory_allocator& allocator) {
+        this->device = device;
+        this->allocator = &allocator;
+
+        plan.clear();
+        final_barriers.clear();
+        compiled = {};
+
+        const auto live = cull_passes();
+        for (std::uint32_t i = 0, next = 0; i < passes.size(); ++i) {
+            if (next < live.size() && live[next] == i) {
+                plan.push_back({ i, {} });
+                compiled.passes.push_back(passes[i].name);
+                ++next;
+            } else {
+                compiled.culled_passes.push_back(passes[i].name);
+            }
+        }
+
+        allocate_transients();
+        plan_barriers();
+    }
+
+    void render_graph::destroy() {
+        for (auto& current : resources) {
+            current.view.reset();
+            current.owned_image.reset();
+        }
+        for (const auto& memory : memory_slots) {
+            allocator->free(memory);
+        }
+        memory_slots.clear();
+        resources.clear();
+        passes.clear();
+        plan.clear();
+        final_barriers.clear();
+    }
+
+    void render_graph::bind_image(graph_resource resource, VkImage image) {
+        auto& imported = resources.at(resource.index);
+        if (!imported.imported || !imported.image) {
+            throw std::runtime_error("Error, only imported images can be bound");
+        }
+        imported.image_handle = image;
+    }
+
+    VkImage render_graph::image(graph_resource resource) const {
+        return resources.at(resource.index).image_handle;
+    }
+
+    VkImageView render_graph::image_view(graph_resource resource) const {
+        return resources.at(resource.index).view;
+    }
+
+    const compiled_graph_info& render_graph::info() const {
+        return compiled;
+    }
+
+    void render_graph::record_barriers(const VkCommandBuffer& command_buffer, const std::vector<planned_barrier>& barriers) const {
+        if (barriers.empty()) {
+            return;
+        }
+
+        VkPipelineStageFlags source_stages{};
+        VkPipelineStageFlags destination_stages{};
+        std::vector<VkBufferMemoryBarrier> buffer_barriers{};
+        std::vector<VkImageMemoryBarrier> image_barriers{};
+        for (const auto& barrier : barriers) {
+            const auto& target = resources[barrier.resource];
+            source_stages |= barrier.before.stages;
+            destination_stages |= barrier.after.stages;
+
+            if (!target.image) {
+                VkBufferMemoryBarrier buffer_barrier{}; {
+                    buffer_barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+                    buffer_barrier.srcAccessMask = barrier.before.access;
+                    buffer_barrier.dstAccessMask = barrier.after.access;
+                    buffer_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                    buffer_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                    buffer_barrier.buffer = target.buffer_handle;
+                    buffer_barrier.offset = 0;
+                    buffer_barrier.size = VK_WHOLE_SIZE;
+                }
+                buffer_barriers.push_back(buffer_barrier);
+                continue;
+            }
+
+            if (target.image_handle == VK_NULL_HANDLE) {
+                throw std::runtime_error("Error, render graph image " + target.name + " is not bound");
+            }
+
+            VkImageMemoryBarrier image_barrier{}; {
+                image_barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+                image_barrier.srcAccessMask = barrier.before.access;
+                image_barrier.dstAccessMask = barrier.after.access;
+                image_barrier.oldLayout = barrier.before.layout;
+                image_barrier.newLayout = barrier.after.layout;
+                image_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                image_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                image_barrier.image = target.image_handle;
+                image_barrier.subresourceRange.aspectMask = target.aspect;
+                image_barrier.subresourceRange.baseMipLevel = 0;
+                image_barrier.subresourceRange.levelCount = VK_REMAINING_MIP_LEVELS;
+                image_barrier.subresourceRange.baseArrayLayer = 0;
+                image_barrier.subresourceRange.layerCount = VK_REMAINING_ARRAY_LAYERS;
+            }
+            image_barriers.push_back(image_barrier);
+        }
+
+        vkCmdPipelineBarrier(command_buffer,
+                             source_stages ? source_stages : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                             destination_stages ? destination_stages : VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                             0, 0, nullptr,
+                             static_cast<std::uint32_t>(buffer_barriers.size()), buffer_barriers.data(),
+                             static_cast<std::uint32_t>(image_barriers.size()), image_barriers.data());
+    }
+
+    void render_graph::execute(const VkCommandBuffer& command_buffer) const {
+        for (const auto& planned : plan) {
+            record_barriers(command_buffer, planned.barriers);
+            passes[planned.pass].callback(command_buffer);
+        }
+        record_barriers(command_buffer, final_barriers);
+    }
+} // namespace vk_playground
@@ -0,0 +1,188 @@
+#include "render_queue.hpp"
+
+#include <array>
+#include <numeric>
+
+namespace vk_playground {
+    std::uint64_t sort_key::make(std::uint32_t pass, std::uint32_t pipeline, std::uint32_t material, std::uint32_t depth) {
+        return std::uint64_t(pass & ((1u << pass_bits) - 1)) << pass_shift |
+               std::uint64_t(pipeline & ((1u << pipeline_bits) - 1)) << pipeline_shift |
+               std::uint64_t(material & ((1u << material_bits) - 1)) << material_shift |
+               std::uint64_t(depth) << depth_shift;
+    }
+
+    std::uint32_t sort_key::pass(std::uint64_t key) {
+        return static_cast<std::uint32_t>(key >> pass_shift) & ((1u << pass_bits) - 1);
+    }
+
+    std::uint32_t sort_key::pipeline(std::uint64_t key) {
+        return static_cast<std::uint32_t>(key >> pipeline_shift) & ((1u << pipeline_bits) - 1);
+    }
+
+    std::uint32_t sort_key::material(std::uint64_t key) {
+        return static_cast<std::uint32_t>(key >> material_shift) & ((1u << material_bits) - 1);
+    }
+
+    void render_queue::clear() {
+        keys.clear();
+        order.clear();
+        index_counts.clear();
+        first_indices.clear();
+        vertex_offsets.clear();
+        uniform_offsets.clear();
+    }
+
+    void render_queue::reserve(std::size_t draws) {
+        keys.reserve(draws);
+        order.reserve(draws);
+        key_scratch.reserve(draws);
+        order_scratch.reserve(draws);
+        index_counts.reserve(draws);
+        first_indices.reserve(draws);
+        vertex_offsets.reserve(draws);
+        uniform_offsets.reserve(draws);
+    }
+
+    std::uint32_t render_queue::size() const {
+        return static_cast<std::uint32_t>(keys.size());
+    }
+
+    void render_queue::push(std::uint64_t key, std::uint32_t index_count, std::uint32_t first_index, std::int32_t vertex_offset, std::uint32_t uniform_offset) {
+        order.emplace_back(static_cast<std::uint32_t>(keys.size()));
+        keys.emplace_back(key);
+        index_counts.emplace_back(index_count);
+        first_indices.emplace_back(first_index);
+        vertex_offsets.emplace_back(vertex_offset);
+        uniform_offsets.emplace_back(uniform_offset);
+    }
+
+    void render_queue::sort() {
+        const auto count = keys.size();
+        if (count < 2) {
+            return;
+        }
+
+        // Every digit's histogram in a single read of the keys
+        std::array<std::array<std::uint32_t, bucket_count>, digit_count> histograms{};
+        for (const auto key : keys) {
+            for (std::uint32_t digit = 0; digit < digit_count; ++digit) {
+                ++histograms[digit][(key >> (digit * digit_bits)) & (bucket_count - 1)];
+            }
+        }
+
+        key_scratch.resize(count);
+        order_scratch.resize(count);
+        auto* source_keys = keys.data();
+        auto* source_order = order.data();
+        auto* target_keys = key_scratch.data();
+        auto* target_order = order_scratch.data();
+        for (std::uint32_t digit = 0; digit < digit_count; ++digit) {
+            const auto shift = digit * digit_bits;
+            auto& offsets = histograms[digit];
+            // Every key has the same digit here, the pass wouldn't move anything
+            if (offsets[(source_keys[0] >> shift) & (bucket_count - 1)] == count) {
+                continue;
+            }
+
+            std::exclusive_scan(offsets.begin(), offsets.end(), offsets.begin(), 0u);
+            for (std::size_t i = 0; i < count; ++i) {
+                const auto key = source_keys[i];
+                const auto slot = offsets[(key >> shift) & (bucket_count - 1)]++;
+                target_keys[slot] = key;
+                target_order[slot] = source_order[i];
+            }
+            std::swap(source_keys, target_keys);
+            std::swap(source_order, target_order);
+        }
+
+        // An odd number of passes leaves the result in the scratch arrays
+        if (source_keys != keys.data()) {
+            keys.swap(key_scratch);
+            order.swap(order_scratch);
+        }
+    }
+
+    std::uint64_t render_queue::key(std::uint32_t index) const {
+        return keys[index];
+    }
+
+    template <typename Binder>
+    bind_counts render_queue::walk(std::uint32_t first, std::uint32_t last, Binder& binder) const {
+        // Nothing is bound at the start of the range, the first draw binds everything
+        bind_counts counts{};
+        bool bound = false;
+        std::uint32_t pipeline = 0;
+        std::uint32_t material = 0;
+        std::uint32_t uniform_offset = 0;
+        for (std::uint32_t i = first; i < last; ++i) {
+            const auto key = keys[i];
+            const auto draw = order[i];
+
+            if (!bound || sort_key::pipeline(key) != pipeline) {
+                pipeline = sort_key::pipeline(key);
+                binder.pipeline(pipeline);
+                ++counts.pipelines;
+            }
+            if (!bound || sort_key::material(key) != material) {
+                material = sort_key::material(key);
+                binder.material(material);
+                ++counts.materials;
+            }
+            if (!bound || uniform_offsets[draw] != uniform_offset) {
+                uniform_offset = uniform_offsets[draw];
+                binder.uniforms(uniform_offset);
+                ++counts.uniforms;
+            }
+            bound = true;
+
+            binder.draw(index_counts[draw], first_indices[draw], vertex_offsets[draw]);
+        }
+        counts.draws = last - first;
+
+        return counts;
+    }
+
+    bind_counts render_queue::record(const VkCommandBuffer& command_buffer, const render_queue_bindings& bindings, std::uint32_t first, std::uint32_t last) const {
+        if (first == last) {
+            return {};
+        }
+
+        const auto layout = bindings.bindless->pipeline_layout();
+        bindings.bindless->bind(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS);
+
+        struct command_binder {
+            const VkCommandBuffer& command_buffer;
+            const render_queue_bindings& bindings;
+            VkPipelineLayout layout;
+
+            void pipeline(std::uint32_t index) {
+                vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, bindings.pipelines[index]);
+            }
+
+            void material(std::uint32_t element) {
+                bindings.bindless->push(command_buffer, { 0, 0, bindings.material_buffer, element });
+            }
+
+            void uniforms(std::uint32_t offset) {
+                bindings.uniforms->bind(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, layout, bindings.uniform_set, offset);
+            }
+
+            void draw(std::uint32_t index_count, std::uint32_t first_index, std::int32_t vertex_offset) {
+                vkCmdDrawIndexed(command_buffer, index_count, 1, first_index, vertex_offset, 0);
+            }
+        } binder{ command_buffer, bindings, layout };
+
+        return walk(first, last, binder);
+    }
+
+    bind_counts render_queue::count_binds(std::uint32_t first, std::uint32_t last) const {
+        struct counting_binder {
+            void pipeline(std::uint32_t) {}
+            void material(std::uint32_t) {}
+            void uniforms(std::uint32_t) {}
+            void draw(std::uint32_t, std::uint32_t, std::int32_t) {}
+        } binder{};
+
+        return walk(first, last, binder);
+    }
+} // namespace vk_playground
@@ -0,0 +1,343 @@
+#include "scene_store.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <stdexcept>
+
+// SSE2 is part of x86-64, AVX2 is compiled per function and only called after checking the cpu
+#if defined(__x86_64__) || defined(_M_X64)
+    #define VKPLAYGROUND_X86_SIMD
+    #include <immintrin.h>
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+        #define VKPLAYGROUND_TARGET_AVX2
+    #else
+        #define VKPLAYGROUND_TARGET_AVX2 __attribute__((target("avx2")))
+    #endif
+#endif
+
+namespace vk_playground {
+    // World space arrays a cull kernel reads, the sphere's world radius is radius * scale
+    struct cull_arrays {
+        const float* x;
+        const float* y;
+        const float* z;
+        const float* scale;
+        const float* radius;
+    };
+
+    // Culls objects [first, last) into one bit each, first is a multiple of 32. Returns how many are visible
+    using cull_function = std::uint32_t (*)(const cull_arrays&, const frustum&, std::uint32_t first, std::uint32_t last, std::uint32_t* bits);
+
+    // Same operations in the same order as the SIMD kernels, so every kernel agrees bit for bit
+    static bool sphere_visible(const cull_arrays& objects, const frustum& view, std::uint32_t i) {
+        const auto limit = 0.0f - objects.radius[i] * objects.scale[i];
+        for (const auto& plane : view.planes) {
+            if (!(plane[0] * objects.x[i] + plane[1] * objects.y[i] + plane[2] * objects.z[i] + plane[3] >= limit)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static std::uint32_t scalar_mask(const cull_arrays& objects, const frustum& view, std::uint32_t base, std::uint32_t last) {
+        std::uint32_t mask = 0;
+        for (auto i = base; i < std::min(base + 32, last); ++i) {
+            mask |= static_cast<std::uint32_t>(sphere_visible(objects, view, i)) << (i - base);
+        }
+        return mask;
+    }
+
+    static std::uint32_t cull_scalar(const cull_arrays& objects, const frustum& view, std::uint32_t first, std::uint32_t last, std::uint32_t* bits) {
+        std::uint32_t visible = 0;
+        for (auto base = first; base < last; base += 32) {
+            const auto mask = scalar_mask(objects, view, base, last);
+            bits[base / 32] = mask;
+            visible += std::popcount(mask);
+        }
+        return visible;
+    }
+
+#if defined(VKPLAYGROUND_X86_SIMD)
+    static std::uint32_t cull_sse(const cull_arrays& objects, const frustum& view, std::uint32_t first, std::uint32_t last, std::uint32_t* bits) {
+        __m128 planes[6][4];
+        for (std::uint32_t plane = 0; plane < 6; ++plane) {
+            for (std::uint32_t component = 0; component < 4; ++component) {
+                planes[plane][component] = _mm_set1_ps(view.planes[plane][component]);
+            }
+        }
+
+        std::uint32_t visible = 0;
+        for (auto base = first; base < last; base += 32) {
+            // The last word may be partial, reading past last isn't allowed
+            if (base + 32 > last) {
+                const auto mask = scalar_mask(objects, view, base, last);
+                bits[base / 32] = mask;
+                visible += std::popcount(mask);
+                continue;
+            }
+
+            std::uint32_t mask = 0;
+            for (std::uint32_t lane = 0; lane < 32; lane += 4) {
+                const auto i = base + lane;
+                const auto x = _mm_loadu_ps(objects.x + i);
+                const auto y = _mm_loadu_ps(objects.y + i);
+                const auto z = _mm_loadu_ps(objects.z + i);
+                const auto limit = _mm_sub_ps(_mm_setzero_ps(), _mm_mul_ps(_mm_loadu_ps(objects.radius + i), _mm_loadu_ps(objects.scale + i)));
+
+                auto inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+                for (const auto& plane : planes) {
+                    const auto distance = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(plane[0], x), _mm_mul_ps(plane[1], y)), _mm_mul_ps(plane[2], z)), plane[3]);
+                    inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, limit));
+                }
+                mask |= static_cast<std::uint32_t>(_mm_movemask_ps(inside)) << lane;
+            }
+            bits[base / 32] = mask;
+            visible += std::popcount(mask);
+        }
+        return visible;
+    }
+
+    VKPLAYGROUND_TARGET_AVX2
+    static std::uint32_t cull_avx2(const cull_arrays& objects, const frustum& view, std::uint32_t first, std::uint32_t last, std::uint32_t* bits) {
+        __m256 planes[6][4];
+        for (std::uint32_t plane = 0; plane < 6; ++plane) {
+            for (std::uint32_t component = 0; component < 4; ++component) {
+                planes[plane][component] = _mm256_set1_ps(view.planes[plane][component]);
+            }
+        }
+
+        std::uint32_t visible = 0;
+        for (auto base = first; base < last; base += 32) {
+            if (base + 32 > last) {
+                const auto mask = scalar_mask(objects, view, base, last);
+                bits[base / 32] = mask;
+                visible += std::popcount(mask);
+                continue;
+            }
+
+            std::uint32_t mask = 0;
+            for (std::uint32_t lane = 0; lane < 32; lane += 8) {
+                const auto i = base + lane;
+                const auto x = _mm256_loadu_ps(objects.x + i);
+                const auto y = _mm256_loadu_ps(objects.y + i);
+                const auto z = _mm256_loadu_ps(objects.z + i);
+                const auto limit = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_mul_ps(_mm256_loadu_ps(objects.radius + i), _mm256_loadu_ps(objects.scale + i)));
+
+                auto inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+                for (const auto& plane : planes) {
+                    const auto distance = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(plane[0], x), _mm256_mul_ps(plane[1], y)), _mm256_mul_ps(plane[2], z)), plane[3]);
+                    inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, limit, _CMP_GE_OQ));
+                }
+                mask |= static_cast<std::uint32_t>(_mm256_movemask_ps(inside)) << lane;
+            }
+            bits[base / 32] = mask;
+            visible += std::popcount(mask);
+        }
+        return visible;
+    }
+
+    static bool cpu_has_avx2() {
+    #if defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7) {
+            return false;
+        }
+        // The os has to save the ymm registers too: OSXSAVE, AVX and XCR0's SSE and AVX state bits
+        __cpuid(info, 1);
+        const bool ymm_saved = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 6) == 6;
+        __cpuidex(info, 7, 0);
+        return ymm_saved && (info[1] & (1 << 5));
+    #else
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+    #endif
+    }
+#endif
+
+    static cull_function kernel_function(cull_kernel kernel) {
+        switch (kernel) {
+#if defined(VKPLAYGROUND_X86_SIMD)
+            case cull_kernel::sse: return cull_sse;
+            case cull_kernel::avx2: return cull_avx2;
+#endif
+            default: return cull_scalar;
+        }
+    }
+
+    const char* cull_kernel_name(cull_kernel kernel) {
+        switch (kernel) {
+            case cull_kernel::scalar: return "scalar";
+            case cull_kernel::sse: return "sse";
+            case cull_kernel::avx2: return "avx2";
+            default: return "unknown";
+        }
+    }
+
+    bool cull_kernel_supported(cull_kernel kernel) {
+#if defined(VKPLAYGROUND_X86_SIMD)
+        static const bool avx2 = cpu_has_avx2();
+        return kernel != cull_kernel::avx2 || avx2;
+#else
+        return kernel == cull_kernel::scalar;
+#endif
+    }
+
+    cull_kernel best_cull_kernel() {
+        for (const auto kernel : { cull_kernel::avx2, cull_kernel::sse }) {
+            if (cull_kernel_supported(kernel)) {
+                return kernel;
+            }
+        }
+        return cull_kernel::scalar;
+    }
+
+    // Splits [first, last) over the pool, split points are multiples of granularity so no two tasks write the same word
+    template <typename Fn>
+    void scene_store::parallel_range(std::uint32_t first, std::uint32_t last, std::uint32_t granularity, Fn&& fn) {
+        const auto count = last - first;
+        const auto tasks = std::clamp<std::uint32_t>(count / min_task_objects, 1, static_cast<std::uint32_t>(workers->size()) + 1);
+        const auto split = [=](std::uint32_t task) {
+            return task == tasks ? last : first + static_cast<std::uint32_t>(std::uint64_t(count) * task / tasks) / granularity * granularity;
+        };
+
+        workers->parallel_for(tasks, [&fn, &split](std::uint32_t task) {
+            fn(split(task), split(task + 1));
+        });
+    }
+
+    void scene_store::create(thread_pool& workers, cull_kernel kernel) {
+        this->workers = &workers;
+        clear();
+        set_kernel(kernel);
+    }
+
+    void scene_store::clear() {
+        for (auto* values : { &local_x, &local_y, &local_z, &local_scale, &radius, &world_x, &world_y, &world_z, &world_scale }) {
+            values->clear();
+        }
+        parents.clear();
+        level_offsets.assign(1, 0);
+        visibility.clear();
+        culled_count = 0;
+    }
+
+    void scene_store::reserve(std::uint32_t objects) {
+        for (auto* values : { &local_x, &local_y, &local_z, &local_scale, &radius, &world_x, &world_y, &world_z, &world_scale }) {
+            values->reserve(objects);
+        }
+        parents.reserve(objects);
+        visibility.reserve((objects + 31) / 32);
+    }
+
+    std::uint32_t scene_store::size() const {
+        return static_cast<std::uint32_t>(parents.size());
+    }
+
+    std::uint32_t scene_store::levels() const {
+        return static_cast<std::uint32_t>(level_offsets.size()) - 1;
+    }
+
+    std::uint32_t scene_store::add(std::uint32_t parent, const scene_transform& local, float radius) {
+        const auto index = size();
+
+        std::uint32_t level = 0;
+        if (parent != no_parent) {
+            if (parent >= index) {
+                throw std::runtime_error("Error, scene object parent has to be added first");
+            }
+            level = static_cast<std::uint32_t>(std::upper_bound(level_offsets.begin(), level_offsets.end(), parent) - level_offsets.begin());
+        }
+        if (level + 1 < levels()) {
+            throw std::runtime_error("Error, scene objects have to be added in increasing depth");
+        }
+        if (level == levels()) {
+            level_offsets.emplace_back(index);
+        }
+        ++level_offsets.back();
+
+        local_x.emplace_back(local.position[0]);
+        local_y.emplace_back(local.position[1]);
+        local_z.emplace_back(local.position[2]);
+        local_scale.emplace_back(local.scale);
+        parents.emplace_back(parent);
+        this->radius.emplace_back(radius);
+        // Roots are valid right away, children once update_transforms() ran
+        world_x.emplace_back(local.position[0]);
+        world_y.emplace_back(local.position[1]);
+        world_z.emplace_back(local.position[2]);
+        world_scale.emplace_back(local.scale);
+
+        return index;
+    }
+
+    void scene_store::set_transform(std::uint32_t index, const scene_transform& local) {
+        local_x[index] = local.position[0];
+        local_y[index] = local.position[1];
+        local_z[index] = local.position[2];
+        local_scale[index] = local.scale;
+    }
+
+    scene_transform scene_store::world_transform(std::uint32_t index) const {
+        return { { world_x[index], world_y[index], world_z[index] }, world_scale[index] };
+    }
+
+    void scene_store::update_transforms() {
+        for (std::uint32_t level = 0; level < levels(); ++level) {
+            parallel_range(level_offsets[level], level_offsets[level + 1], 1, [this, level](std::uint32_t first, std::uint32_t last) {
+                if (level == 0) {
+                    std::copy(local_x.begin() + first, local_x.begin() + last, world_x.begin() + first);
+                    std::copy(local_y.begin() + first, local_y.begin() + last, world_y.begin() + first);
+                    std::copy(local_z.begin() + first, local_z.begin() + last, world_z.begin() + first);
+                    std::copy(local_scale.begin() + first, local_scale.begin() + last, world_scale.begin() + first);
+                    return;
+                }
+
+                // Parents are on the previous level, finished before this one started
+                for (auto i = first; i < last; ++i) {
+                    const auto parent = parents[i];
+                    const auto scale = world_scale[parent];
+                    world_x[i] = world_x[parent] + local_x[i] * scale;
+                    world_y[i] = world_y[parent] + local_y[i] * scale;
+                    world_z[i] = world_z[parent] + local_z[i] * scale;
+                    world_scale[i] = scale * local_scale[i];
+                }
+            });
+        }
+    }
+
+    cull_kernel scene_store::active_kernel() const {
+        return kernel;
+    }
+
+    void scene_store::set_kernel(cull_kernel kernel) {
+        if (!cull_kernel_supported(kernel)) {
+            throw std::runtime_error(std::string("Error, cpu doesn't support the ") + cull_kernel_name(kernel) + " cull kernel");
+        }
+        this->kernel = kernel;
+    }
+
+    std::uint32_t scene_store::cull(const frustum& view, std::uint32_t count) {
+        culled_count = std::min(count, size());
+        visibility.resize((size() + 31) / 32);
+
+        const cull_arrays objects{ world_x.data(), world_y.data(), world_z.data(), world_scale.data(), radius.data() };
+        const auto function = kernel_function(kernel);
+
+        std::atomic<std::uint32_t> visible = 0;
+        parallel_range(0, culled_count, 32, [&](std::uint32_t first, std::uint32_t last) {
+            visible += function(objects, view, first, last, visibility.data());
+        });
+        return visible;
+    }
+
+    std::uint32_t scene_store::cull(const frustum& view) {
+        return cull(view, size());
+    }
+
+    bool scene_store::visible(std::uint32_t index) const {
+        return index < culled_count && (visibility[index / 32] >> (index % 32) & 1);
+    }
+} // namespace vk_playground
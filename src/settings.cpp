@@ -0,0 +1,173 @@
+#include "settings.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace vk_playground {
+    constexpr static std::uint32_t default_benchmark_frames = 1000;
+    constexpr static std::uint32_t default_cull_benchmark_objects = 1'000'000;
+
+    static std::uint32_t parse_uint(std::string_view option, const char* value) {
+        if (value == nullptr) {
+            throw std::runtime_error("Error, missing value for " + std::string(option));
+        }
+
+        try {
+            return static_cast<std::uint32_t>(std::stoul(value));
+        } catch (const std::exception&) {
+            throw std::runtime_error("Error, invalid value for " + std::string(option) + ": " + value);
+        }
+    }
+
+    settings settings::from_args(int argc, char** argv) {
+        settings result{};
+
+        for (int i = 1; i < argc; ++i) {
+            std::string_view arg = argv[i];
+            const char* next = i + 1 < argc ? argv[i + 1] : nullptr;
+
+            if (arg == "--headless") {
+                result.headless = true;
+            } else if (arg == "--frames") {
+                result.frame_count = parse_uint(arg, next);
+                ++i;
+            } else if (arg == "--bench") {
+                result.benchmark = true;
+            } else if (arg == "--warmup") {
+                result.warmup_frames = parse_uint(arg, next);
+                ++i;
+            } else if (arg == "--pipeline-cache") {
+                if (next == nullptr) {
+                    throw std::runtime_error("Error, missing value for --pipeline-cache");
+                }
+                result.pipeline_cache_path = next;
+                ++i;
+            } else if (arg == "--no-pipeline-cache") {
+                result.pipeline_cache_path.clear();
+            } else if (arg == "--record") {
+                std::string_view mode = next ? next : "";
+                if (mode == "per-frame") {
+                    result.recording = record_mode::per_frame;
+                } else if (mode == "static") {
+                    result.recording = record_mode::prerecorded;
+                } else {
+                    throw std::runtime_error("Error, --record expects per-frame or static");
+                }
+                ++i;
+            } else if (arg == "--record-threads") {
+                result.record_threads = std::max(1u, parse_uint(arg, next));
+                ++i;
+            } else if (arg == "--draws") {
+                result.draw_count = parse_uint(arg, next);
+                ++i;
+            } else if (arg == "--bench-record") {
+                result.record_benchmark = true;
+            } else if (arg == "--present-mode") {
+                std::string_view mode = next ? next : "";
+                if (mode == "immediate") {
+                    result.presentation = present_mode::immediate;
+                } else if (mode == "mailbox") {
+                    result.presentation = present_mode::mailbox;
+                } else if (mode == "fifo") {
+                    result.presentation = present_mode::fifo;
+                } else if (mode == "fifo-relaxed") {
+                    result.presentation = present_mode::fifo_relaxed;
+                } else {
+                    throw std::runtime_error("Error, --present-mode expects immediate, mailbox, fifo or fifo-relaxed");
+                }
+                ++i;
+            } else if (arg == "--frames-in-flight") {
+                result.frames_in_flight = std::max(1u, parse_uint(arg, next));
+                ++i;
+            } else if (arg == "--pace") {
+                result.frame_pacing = true;
+            } else if (arg == "--mesh") {
+                if (next == nullptr) {
+                    throw std::runtime_error("Error, missing value for --mesh");
+                }
+                result.mesh_path = next;
+                ++i;
+            } else if (arg == "--particles") {
+                result.particle_count = parse_uint(arg, next);
+                ++i;
+            } else if (arg == "--async-compute") {
+                result.async_compute = true;
+            } else if (arg == "--objects") {
+                result.object_count = parse_uint(arg, next);
+                ++i;
+            } else if (arg == "--gpu-culling") {
+                result.gpu_culling = true;
+            } else if (arg == "--bench-culling") {
+                result.cull_benchmark = true;
+            } else if (arg == "--instances") {
+                result.instance_count = parse_uint(arg, next);
+                ++i;
+            } else if (arg == "--dump-graph") {
+                result.dump_graph = true;
+            } else if (arg == "--shader-dir") {
+                if (next == nullptr) {
+                    throw std::runtime_error("Error, missing value for --shader-dir");
+                }
+                result.shader_directory = next;
+                ++i;
+            } else if (arg == "--hot-reload") {
+                result.hot_reload = true;
+            } else if (arg == "--glslc") {
+                if (next == nullptr) {
+                    throw std::runtime_error("Error, missing value for --glslc");
+                }
+                result.glslc = next;
+                ++i;
+            } else if (arg == "--threads") {
+                result.worker_threads = parse_uint(arg, next);
+                ++i;
+            } else if (arg == "--bench-alloc") {
+                result.allocator_benchmark = parse_uint(arg, next);
+                ++i;
+            } else if (arg == "--bench-uniforms") {
+                result.uniform_benchmark = parse_uint(arg, next);
+                ++i;
+            } else if (arg == "--bench-sort") {
+                result.sort_benchmark = parse_uint(arg, next);
+                ++i;
+            } else if (arg == "--bench-scene") {
+                result.scene_benchmark = true;
+            } else if (arg == "--json") {
+                if (next == nullptr) {
+                    throw std::runtime_error("Error, missing value for --json");
+                }
+                result.json_path = next;
+                ++i;
+            } else {
+                throw std::runtime_error("Error, unknown option " + std::string(arg));
+            }
+        }
+
+        // The sweep needs per frame recording and enough secondary pools for every core
+        if (result.record_benchmark) {
+            result.recording = record_mode::per_frame;
+            result.record_threads = std::max(result.record_threads, std::thread::hardware_concurrency());
+        }
+
+        // Which buffer a frame draws depends on how far the async simulation got, prerecorded buffers can't follow it
+        if (result.async_compute) {
+            result.recording = record_mode::per_frame;
+        }
+
+        // The sweep draws subsets of the largest object count, the culled view changes every frame
+        if (result.cull_benchmark) {
+            result.object_count = std::max(result.object_count, default_cull_benchmark_objects);
+        }
+        if (result.object_count > 0 || result.instance_count > 0) {
+            result.recording = record_mode::per_frame;
+        }
+
+        if (result.benchmark && result.frame_count == 0) {
+            result.frame_count = default_benchmark_frames;
+        }
+
+        return result;
+    }
+} // namespace vk_playground
@@ -1,45 +1,151 @@
 #include "shader.hpp"
 
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_set>
+
 namespace vk_playground {
-    shader::shader(const std::filesystem::path& vert, const std::filesystem::path& frag) {
-        std::ifstream fvert(vert.generic_string(), std::ios::binary);
-        std::ifstream ffrag(frag.generic_string(), std::ios::binary);
+    constexpr static std::uint32_t spirv_magic = 0x07230203;
+    // Magic, version, generator, bound and schema
+    constexpr static std::size_t spirv_header_words = 5;
+
+    static std::uint64_t hash_words(std::span<const std::uint32_t> words) {
+        // FNV-1a over whole words, a shader is a few KiB so this is nowhere near the module creation cost
+        std::uint64_t hash = 0xcbf29ce484222325ull;
+        for (auto word : words) {
+            hash = (hash ^ word) * 0x100000001b3ull;
+        }
+
+        return hash;
+    }
+
+    spirv_file::spirv_file(const std::filesystem::path& path) : file(path) {
+        const auto bytes = file.data();
+        if (bytes.size() % sizeof(std::uint32_t) != 0 || bytes.size() < spirv_header_words * sizeof(std::uint32_t) ||
+            code()[0] != spirv_magic) {
+            throw std::runtime_error("Error, " + path.generic_string() + " is not a SPIR-V module");
+        }
+    }
+
+    std::span<const std::uint32_t> spirv_file::code() const {
+        const auto bytes = file.data();
+        return { reinterpret_cast<const std::uint32_t*>(bytes.data()), bytes.size() / sizeof(std::uint32_t) };
+    }
+
+    void shader_module_cache::create(const VkDevice& device) {
+        this->device = device;
+    }
+
+    void shader_module_cache::destroy() {
+        std::lock_guard guard(lock);
+        loaded.clear();
+        modules.clear();
+    }
+
+    VkShaderModule shader_module_cache::get(std::span<const std::uint32_t> code) {
+        const key module_key{ hash_words(code), code.size() };
+
+        auto& candidates = modules[module_key];
+        for (const auto& candidate : candidates) {
+            if (std::equal(candidate.code.begin(), candidate.code.end(), code.begin(), code.end())) {
+                ++hit_count;
+                return candidate.module;
+            }
+        }
 
-        if (!fvert.is_open()) {
-            throw std::runtime_error("Error, " + vert.generic_string() + " not found");
+        VkShaderModuleCreateInfo module_info{}; {
+            module_info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+            module_info.codeSize = code.size_bytes();
+            module_info.pCode = code.data();
         }
 
-        if (!ffrag.is_open()) {
-            throw std::runtime_error("Error, " + frag.generic_string() + " not found");
+        unique_shader_module module{};
+        if (vkCreateShaderModule(device, &module_info, nullptr, module.put(device)) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create shader module!");
         }
 
-        vertex_spv = std::string{ std::istreambuf_iterator{ fvert }, {} };
-        fragment_spv = std::string{ std::istreambuf_iterator{ ffrag }, {} };
+        ++miss_count;
+        return candidates.emplace_back(entry{ { code.begin(), code.end() }, std::move(module) }).module;
     }
 
-    void shader::create_module(const VkDevice& device) {
-        VkShaderModuleCreateInfo vertex_module_info{}; {
-            vertex_module_info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-            vertex_module_info.codeSize = vertex_spv.size();
-            vertex_module_info.pCode = reinterpret_cast<const uint32_t*>(vertex_spv.data());
+    VkShaderModule shader_module_cache::load(const std::filesystem::path& path) {
+        // The mapping is only needed until the module exists
+        const spirv_file binary(path);
+
+        std::lock_guard guard(lock);
+        const auto module = get(binary.code());
+        loaded[path] = module;
+
+        return module;
+    }
+
+    std::vector<unique_shader_module> shader_module_cache::take_superseded() {
+        std::lock_guard guard(lock);
+        std::unordered_set<VkShaderModule> live{};
+        for (const auto& [path, module] : loaded) {
+            live.insert(module);
         }
 
-        if (vkCreateShaderModule(device, &vertex_module_info, nullptr, &shader_module[0]) != VK_SUCCESS) {
-            throw std::runtime_error("Failed to create vertex shader module!");
+        std::vector<unique_shader_module> superseded{};
+        for (auto candidates = modules.begin(); candidates != modules.end();) {
+            auto& entries = candidates->second;
+            for (auto candidate = entries.begin(); candidate != entries.end();) {
+                if (live.contains(candidate->module.get())) {
+                    ++candidate;
+                    continue;
+                }
+                superseded.emplace_back(std::move(candidate->module));
+                candidate = entries.erase(candidate);
+            }
+            candidates = entries.empty() ? modules.erase(candidates) : std::next(candidates);
         }
 
-        VkShaderModuleCreateInfo fragment_module_info{}; {
-            fragment_module_info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-            fragment_module_info.codeSize = fragment_spv.size();
-            fragment_module_info.pCode = reinterpret_cast<const uint32_t*>(fragment_spv.data());
+        return superseded;
+    }
+
+    std::uint32_t shader_module_cache::size() const {
+        std::lock_guard guard(lock);
+        std::size_t count = 0;
+        for (const auto& [module_key, candidates] : modules) {
+            count += candidates.size();
         }
 
-        if (vkCreateShaderModule(device, &fragment_module_info, nullptr, &shader_module[1]) != VK_SUCCESS) {
-            throw std::runtime_error("Failed to create fragment shader module!");
+        return static_cast<std::uint32_t>(count);
+    }
+
+    std::uint32_t shader_module_cache::hits() const {
+        std::lock_guard guard(lock);
+        return hit_count;
+    }
+
+    std::uint32_t shader_module_cache::misses() const {
+        std::lock_guard guard(lock);
+        return miss_count;
+    }
+
+    shader& shader::add_stage(VkShaderStageFlagBits stage, const std::filesystem::path& path, shader_module_cache& cache, const char* entry) {
+        VkPipelineShaderStageCreateInfo stage_info{}; {
+            stage_info.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+            stage_info.stage = stage;
+            stage_info.module = cache.load(path);
+            stage_info.pName = entry;
         }
+        shader_stages.emplace_back(stage_info);
+
+        return *this;
     }
 
-    std::array<VkShaderModule, 2>& shader::get_modules() {
-        return shader_module;
+    const std::vector<VkPipelineShaderStageCreateInfo>& shader::stages() const {
+        return shader_stages;
+    }
+
+    VkShaderModule shader::module(VkShaderStageFlagBits stage) const {
+        for (const auto& stage_info : shader_stages) {
+            if (stage_info.stage == stage) {
+                return stage_info.module;
+            }
+        }
+
+        return nullptr;
     }
 } // namespace vk_playground
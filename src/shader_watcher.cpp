@@ -0,0 +1,147 @@
+#include "shader_watcher.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+
+#if defined(__linux__)
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace vk_playground {
+    shader_watcher::~shader_watcher() {
+        destroy();
+    }
+
+    void shader_watcher::create(const std::filesystem::path& watched) {
+        directory = watched;
+
+#if defined(__linux__)
+        inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (inotify_fd < 0) {
+            throw std::runtime_error("Error, inotify is unavailable");
+        }
+
+        // Editors either write in place or write a temporary and rename it over the original
+        if (inotify_add_watch(inotify_fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+            destroy();
+            throw std::runtime_error("Error, failed to watch " + directory.generic_string());
+        }
+#else
+        for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+            if (entry.is_regular_file()) {
+                write_times[entry.path().generic_string()] = entry.last_write_time();
+            }
+        }
+        last_scan = bench_clock::now();
+#endif
+    }
+
+    void shader_watcher::destroy() {
+#if defined(__linux__)
+        if (inotify_fd >= 0) {
+            ::close(inotify_fd);
+            inotify_fd = -1;
+        }
+#else
+        write_times.clear();
+#endif
+    }
+
+    std::vector<std::filesystem::path> shader_watcher::poll() {
+        std::vector<std::filesystem::path> changed{};
+
+#if defined(__linux__)
+        if (inotify_fd < 0) {
+            return changed;
+        }
+
+        alignas(inotify_event) char buffer[4096];
+        for (;;) {
+            const auto length = ::read(inotify_fd, buffer, sizeof(buffer));
+            if (length <= 0) {
+                break;
+            }
+
+            for (ssize_t offset = 0; offset < length;) {
+                const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+                if (event->len > 0 && !(event->mask & IN_ISDIR)) {
+                    auto path = directory / event->name;
+                    if (std::find(changed.begin(), changed.end(), path) == changed.end()) {
+                        changed.emplace_back(std::move(path));
+                    }
+                }
+                offset += sizeof(inotify_event) + event->len;
+            }
+        }
+#else
+        constexpr double scan_interval_ms = 250.0;
+        if (elapsed_ms(last_scan) < scan_interval_ms) {
+            return changed;
+        }
+        last_scan = bench_clock::now();
+
+        std::error_code error{};
+        for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+            if (!entry.is_regular_file()) {
+                continue;
+            }
+
+            auto& known = write_times[entry.path().generic_string()];
+            const auto write_time = entry.last_write_time();
+            if (known != write_time) {
+                known = write_time;
+                changed.emplace_back(entry.path());
+            }
+        }
+#endif
+
+        return changed;
+    }
+
+    // glslc's stage inference from the file extension
+    constexpr static std::pair<const char*, VkShaderStageFlagBits> shader_extensions[] = {
+        { ".vert", VK_SHADER_STAGE_VERTEX_BIT },
+        { ".frag", VK_SHADER_STAGE_FRAGMENT_BIT },
+        { ".comp", VK_SHADER_STAGE_COMPUTE_BIT },
+        { ".geom", VK_SHADER_STAGE_GEOMETRY_BIT },
+        { ".tesc", VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT },
+        { ".tese", VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT }
+    };
+
+    VkShaderStageFlagBits shader_stage_from_path(const std::filesystem::path& source) {
+        const auto extension = source.extension();
+        for (const auto& [name, stage] : shader_extensions) {
+            if (extension == name) {
+                return stage;
+            }
+        }
+
+        throw std::runtime_error("Error, unknown shader stage for " + source.generic_string());
+    }
+
+    bool is_shader_source(const std::filesystem::path& source) {
+        const auto extension = source.extension();
+        return std::any_of(std::begin(shader_extensions), std::end(shader_extensions), [&extension](const auto& known) {
+            return extension == known.first;
+        });
+    }
+
+    std::filesystem::path compiled_shader_path(const std::filesystem::path& source) {
+        return source.parent_path() / "compiled" / (source.stem().string() + "_" + source.extension().string().substr(1) + ".spv");
+    }
+
+    bool compile_glsl(const std::filesystem::path& source, const std::filesystem::path& output, const std::string& glslc) {
+        // Same flags as compile_shaders
+        auto command = "\"" + glslc + "\" --target-env=vulkan1.1 \"" + source.string() + "\" -o \"" + output.string() + "\"";
+#if defined(_WIN32)
+        // cmd.exe strips the first and last quote of the whole line when it starts with one
+        command = "\"" + command + "\"";
+#endif
+
+        return std::system(command.c_str()) == 0;
+    }
+} // namespace vk_playground
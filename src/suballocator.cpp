@@ -0,0 +1,315 @@
+#include "suballocator.hpp"
+
+#include <algorithm>
+#include <bit>
+
+namespace vk_playground {
+    static std::uint32_t most_significant_bit(std::uint64_t value) {
+        return 63 - std::countl_zero(value);
+    }
+
+    tlsf_allocator::tlsf_allocator(std::uint64_t size)
+        : capacity(size) {
+        for (auto& heads : free_heads) {
+            for (auto& head : heads) {
+                head = null_block;
+            }
+        }
+
+        auto index = new_block();
+        blocks[index].offset = 0;
+        blocks[index].size = size;
+        insert_free(index);
+    }
+
+    void tlsf_allocator::mapping_insert(std::uint64_t size, std::uint32_t& fl, std::uint32_t& sl) {
+        if (size < sl_count) {
+            fl = 0;
+            sl = static_cast<std::uint32_t>(size);
+        } else {
+            auto msb = most_significant_bit(size);
+            fl = msb - sl_index_log2 + 1;
+            sl = static_cast<std::uint32_t>(size >> (msb - sl_index_log2)) - sl_count;
+        }
+    }
+
+    void tlsf_allocator::mapping_search(std::uint64_t size, std::uint32_t& fl, std::uint32_t& sl) {
+        // Round up to the next class so any block in the found list is large enough
+        if (size >= sl_count) {
+            size += (std::uint64_t(1) << (most_significant_bit(size) - sl_index_log2)) - 1;
+        }
+        mapping_insert(size, fl, sl);
+    }
+
+    std::uint32_t tlsf_allocator::new_block() {
+        if (!unused_blocks.empty()) {
+            auto index = unused_blocks.back();
+            unused_blocks.pop_back();
+            blocks[index] = {};
+            return index;
+        }
+
+        blocks.emplace_back();
+        return static_cast<std::uint32_t>(blocks.size() - 1);
+    }
+
+    void tlsf_allocator::insert_free(std::uint32_t index) {
+        std::uint32_t fl, sl;
+        mapping_insert(blocks[index].size, fl, sl);
+
+        auto& head = free_heads[fl][sl];
+        blocks[index].free = true;
+        blocks[index].prev_free = null_block;
+        blocks[index].next_free = head;
+        if (head != null_block) {
+            blocks[head].prev_free = index;
+        }
+        head = index;
+
+        fl_bitmap |= std::uint64_t(1) << fl;
+        sl_bitmap[fl] |= 1u << sl;
+        ++free_count;
+    }
+
+    void tlsf_allocator::remove_free(std::uint32_t index) {
+        std::uint32_t fl, sl;
+        mapping_insert(blocks[index].size, fl, sl);
+
+        auto& current = blocks[index];
+        if (current.prev_free != null_block) {
+            blocks[current.prev_free].next_free = current.next_free;
+        } else {
+            free_heads[fl][sl] = current.next_free;
+        }
+        if (current.next_free != null_block) {
+            blocks[current.next_free].prev_free = current.prev_free;
+        }
+
+        if (free_heads[fl][sl] == null_block) {
+            sl_bitmap[fl] &= ~(1u << sl);
+            if (sl_bitmap[fl] == 0) {
+                fl_bitmap &= ~(std::uint64_t(1) << fl);
+            }
+        }
+
+        current.free = false;
+        current.prev_free = current.next_free = null_block;
+        --free_count;
+    }
+
+    std::uint32_t tlsf_allocator::split(std::uint32_t index, std::uint64_t size) {
+        // Returns the physical successor holding the remaining size - bytes
+        auto remainder = new_block();
+        auto& current = blocks[index];
+        auto& rest = blocks[remainder];
+
+        rest.offset = current.offset + size;
+        rest.size = current.size - size;
+        rest.prev_physical = index;
+        rest.next_physical = current.next_physical;
+        if (current.next_physical != null_block) {
+            blocks[current.next_physical].prev_physical = remainder;
+        }
+        current.next_physical = remainder;
+        current.size = size;
+
+        return remainder;
+    }
+
+    void tlsf_allocator::merge_into_prev(std::uint32_t index) {
+        auto& current = blocks[index];
+        auto& prev = blocks[current.prev_physical];
+
+        prev.size += current.size;
+        prev.next_physical = current.next_physical;
+        if (current.next_physical != null_block) {
+            blocks[current.next_physical].prev_physical = current.prev_physical;
+        }
+        unused_blocks.push_back(index);
+    }
+
+    std::uint32_t tlsf_allocator::find_free(std::uint64_t size) {
+        std::uint32_t fl, sl;
+        mapping_search(size, fl, sl);
+        if (fl >= fl_count) {
+            return null_block;
+        }
+
+        auto sl_map = sl_bitmap[fl] & (~0u << sl);
+        if (sl_map == 0) {
+            auto fl_map = fl + 1 < 64 ? fl_bitmap & (~std::uint64_t(0) << (fl + 1)) : 0;
+            if (fl_map == 0) {
+                return null_block;
+            }
+            fl = std::countr_zero(fl_map);
+            sl_map = sl_bitmap[fl];
+        }
+        sl = std::countr_zero(sl_map);
+
+        return free_heads[fl][sl];
+    }
+
+    std::optional<suballocation> tlsf_allocator::allocate(std::uint64_t size, std::uint64_t alignment) {
+        if (size == 0 || size > capacity) {
+            return std::nullopt;
+        }
+
+        // Worst case padding is included in the search, any returned block fits after alignment
+        auto index = find_free(size + (alignment > 1 ? alignment - 1 : 0));
+        if (index == null_block) {
+            return std::nullopt;
+        }
+        remove_free(index);
+
+        auto padding = align_up(blocks[index].offset, alignment) - blocks[index].offset;
+        if (padding > 0) {
+            auto aligned = split(index, padding);
+            insert_free(index);
+            index = aligned;
+        }
+
+        if (blocks[index].size > size) {
+            insert_free(split(index, size));
+        }
+
+        used += blocks[index].size;
+        ++allocation_count;
+
+        return suballocation{ blocks[index].offset, index };
+    }
+
+    void tlsf_allocator::free(std::uint32_t handle) {
+        used -= blocks[handle].size;
+        --allocation_count;
+
+        auto index = handle;
+        auto next = blocks[index].next_physical;
+        if (next != null_block && blocks[next].free) {
+            remove_free(next);
+            merge_into_prev(next);
+        }
+
+        auto prev = blocks[index].prev_physical;
+        if (prev != null_block && blocks[prev].free) {
+            remove_free(prev);
+            merge_into_prev(index);
+            index = prev;
+        }
+
+        insert_free(index);
+    }
+
+    std::uint64_t tlsf_allocator::size() const {
+        return capacity;
+    }
+
+    std::uint64_t tlsf_allocator::used_bytes() const {
+        return used;
+    }
+
+    std::uint32_t tlsf_allocator::allocations() const {
+        return allocation_count;
+    }
+
+    std::uint32_t tlsf_allocator::free_regions() const {
+        return free_count;
+    }
+
+    std::uint64_t tlsf_allocator::largest_free_region() const {
+        if (fl_bitmap == 0) {
+            return 0;
+        }
+
+        // Only the highest non-empty list can hold the largest block
+        auto fl = most_significant_bit(fl_bitmap);
+        auto sl = 31 - std::countl_zero(sl_bitmap[fl]);
+
+        std::uint64_t largest = 0;
+        for (auto index = free_heads[fl][sl]; index != null_block; index = blocks[index].next_free) {
+            largest = std::max(largest, blocks[index].size);
+        }
+
+        return largest;
+    }
+
+    bool tlsf_allocator::empty() const {
+        return allocation_count == 0;
+    }
+
+    linear_allocator::linear_allocator(std::uint64_t base, std::uint64_t size)
+        : base(base), capacity(size) {}
+
+    std::optional<std::uint64_t> linear_allocator::allocate(std::uint64_t size, std::uint64_t alignment) {
+        auto offset = align_up(base + head, alignment) - base;
+        if (offset + size > capacity) {
+            return std::nullopt;
+        }
+
+        head = offset + size;
+
+        return base + offset;
+    }
+
+    void linear_allocator::reset() {
+        head = 0;
+    }
+
+    std::uint64_t linear_allocator::size() const {
+        return capacity;
+    }
+
+    std::uint64_t linear_allocator::used_bytes() const {
+        return head;
+    }
+
+    ring_allocator::ring_allocator(std::uint64_t size)
+        : capacity(size) {}
+
+    std::optional<std::uint64_t> ring_allocator::allocate(std::uint64_t size, std::uint64_t alignment) {
+        auto offset = align_up(head, alignment);
+        auto padding = offset - head;
+
+        // Doesn't fit before the end, skip the rest of the range and start over at 0
+        if (offset + size > capacity) {
+            padding = capacity - head;
+            offset = 0;
+        }
+
+        // Free space is the contiguous run from head up to the oldest live allocation
+        if (used + padding + size > capacity) {
+            return std::nullopt;
+        }
+
+        head = offset + size;
+        used += padding + size;
+        unmarked += padding + size;
+
+        return offset;
+    }
+
+    void ring_allocator::mark(std::uint64_t value) {
+        if (unmarked > 0) {
+            in_flight.push_back({ unmarked, value });
+            unmarked = 0;
+        }
+    }
+
+    void ring_allocator::release(std::uint64_t completed_value) {
+        while (!in_flight.empty() && in_flight.front().value <= completed_value) {
+            used -= in_flight.front().bytes;
+            in_flight.pop_front();
+        }
+
+        if (used == 0) {
+            head = 0;
+        }
+    }
+
+    std::uint64_t ring_allocator::size() const {
+        return capacity;
+    }
+
+    std::uint64_t ring_allocator::used_bytes() const {
+        return used;
+    }
+} // namespace vk_playground
@@ -0,0 +1,65 @@
+#include "thread_pool.hpp"
+
+namespace vk_playground {
+    thread_pool::~thread_pool() {
+        stop();
+    }
+
+    void thread_pool::start(std::size_t thread_count) {
+        stopping = false;
+        workers.reserve(thread_count);
+        for (std::size_t i = 0; i < thread_count; ++i) {
+            workers.emplace_back(&thread_pool::worker_loop, this);
+        }
+    }
+
+    void thread_pool::stop() {
+        {
+            std::lock_guard lock(mutex);
+            stopping = true;
+        }
+        condition.notify_all();
+
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        workers.clear();
+    }
+
+    std::size_t thread_pool::size() const {
+        return workers.size();
+    }
+
+    void thread_pool::enqueue(std::function<void()> task) {
+        // No workers, run inline so callers never deadlock on the future
+        if (workers.empty()) {
+            task();
+            return;
+        }
+
+        {
+            std::lock_guard lock(mutex);
+            tasks.emplace_back(std::move(task));
+        }
+        condition.notify_one();
+    }
+
+    void thread_pool::worker_loop() {
+        while (true) {
+            std::function<void()> task{};
+            {
+                std::unique_lock lock(mutex);
+                condition.wait(lock, [this]() { return stopping || !tasks.empty(); });
+
+                // Drain whatever is queued before shutting down, pending futures still get a value
+                if (tasks.empty()) {
+                    return;
+                }
+
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+            task();
+        }
+    }
+} // namespace vk_playground
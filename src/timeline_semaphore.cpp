@@ -0,0 +1,88 @@
+#include "timeline_semaphore.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace vk_playground {
+    void timeline_semaphore::create(const VkDevice& device, bool core) {
+        this->device = device;
+        submitted = 0;
+        completed_value = 0;
+
+        wait_semaphores = reinterpret_cast<PFN_vkWaitSemaphores>(
+            vkGetDeviceProcAddr(device, core ? "vkWaitSemaphores" : "vkWaitSemaphoresKHR"));
+        get_counter_value = reinterpret_cast<PFN_vkGetSemaphoreCounterValue>(
+            vkGetDeviceProcAddr(device, core ? "vkGetSemaphoreCounterValue" : "vkGetSemaphoreCounterValueKHR"));
+
+        if (!wait_semaphores || !get_counter_value) {
+            throw std::runtime_error("Error, timeline semaphore functions are not available");
+        }
+
+        VkSemaphoreTypeCreateInfo type_create_info{}; {
+            type_create_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+            type_create_info.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+            type_create_info.initialValue = 0;
+        }
+
+        VkSemaphoreCreateInfo semaphore_create_info{}; {
+            semaphore_create_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+            semaphore_create_info.pNext = &type_create_info;
+        }
+
+        if (vkCreateSemaphore(device, &semaphore_create_info, nullptr, &semaphore) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create timeline semaphore");
+        }
+    }
+
+    void timeline_semaphore::destroy() {
+        if (semaphore == nullptr) {
+            return;
+        }
+        vkDestroySemaphore(device, semaphore, nullptr);
+        semaphore = nullptr;
+    }
+
+    VkSemaphore timeline_semaphore::handle() const {
+        return semaphore;
+    }
+
+    std::uint64_t timeline_semaphore::next() {
+        return ++submitted;
+    }
+
+    std::uint64_t timeline_semaphore::last_submitted() const {
+        return submitted;
+    }
+
+    std::uint64_t timeline_semaphore::poll() {
+        std::uint64_t value{};
+        if (get_counter_value(device, semaphore, &value) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to query timeline semaphore");
+        }
+        completed_value = std::max(completed_value, value);
+
+        return completed_value;
+    }
+
+    std::uint64_t timeline_semaphore::completed() const {
+        return completed_value;
+    }
+
+    void timeline_semaphore::wait(std::uint64_t value) {
+        if (value <= completed_value) {
+            return;
+        }
+
+        VkSemaphoreWaitInfo wait_info{}; {
+            wait_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+            wait_info.semaphoreCount = 1;
+            wait_info.pSemaphores = &semaphore;
+            wait_info.pValues = &value;
+        }
+
+        if (wait_semaphores(device, &wait_info, UINT64_MAX) != VK_SUCCESS) {
+            throw std::runtime_error("Failed waiting on timeline semaphore");
+        }
+        completed_value = value;
+    }
+} // namespace vk_playground
@@ -0,0 +1,145 @@
+#include "uniform_ring.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+
+namespace vk_playground {
+    void uniform_ring::create(const VkDevice& device, memory_allocator& allocator, const VkPhysicalDeviceLimits& limits, std::uint32_t frame_count,
+                              VkDeviceSize bytes_per_frame, VkDeviceSize max_allocation) {
+        this->device = device;
+        this->allocator = &allocator;
+        this->frame_count = frame_count;
+
+        if (max_allocation > limits.maxUniformBufferRange) {
+            throw std::runtime_error("Error, uniform ring allocations exceed maxUniformBufferRange");
+        }
+
+        alignment = std::max<VkDeviceSize>(limits.minUniformBufferOffsetAlignment, 1);
+        range = align_up(max_allocation, alignment);
+        region_size = align_up(std::max(bytes_per_frame, range), alignment);
+        region_start = 0;
+        head = 0;
+
+        VkBufferCreateInfo buffer_info{}; {
+            buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+            // The descriptor's window starts at the dynamic offset, the last one may begin at the very end of a region
+            buffer_info.size = region_size * frame_count + range;
+            buffer_info.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+            buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        }
+        ring = allocator.create_buffer(buffer_info, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                       VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        if (ring.memory.mapped == nullptr) {
+            throw std::runtime_error("Error, uniform ring is not host visible");
+        }
+
+        VkDescriptorSetLayoutBinding binding{}; {
+            binding.binding = 0;
+            binding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+            binding.descriptorCount = 1;
+            binding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+        }
+
+        VkDescriptorSetLayoutCreateInfo set_layout_info{}; {
+            set_layout_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+            set_layout_info.bindingCount = 1;
+            set_layout_info.pBindings = &binding;
+        }
+
+        if (vkCreateDescriptorSetLayout(device, &set_layout_info, nullptr, set_layout.put(device)) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create uniform ring descriptor set layout");
+        }
+
+        VkDescriptorPoolSize pool_size{}; {
+            pool_size.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+            pool_size.descriptorCount = 1;
+        }
+
+        VkDescriptorPoolCreateInfo pool_info{}; {
+            pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+            pool_info.maxSets = 1;
+            pool_info.poolSizeCount = 1;
+            pool_info.pPoolSizes = &pool_size;
+        }
+
+        if (vkCreateDescriptorPool(device, &pool_info, nullptr, descriptor_pool.put(device)) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create uniform ring descriptor pool");
+        }
+
+        VkDescriptorSetAllocateInfo set_info{}; {
+            set_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+            set_info.descriptorPool = descriptor_pool;
+            set_info.descriptorSetCount = 1;
+            set_info.pSetLayouts = set_layout.address();
+        }
+
+        if (vkAllocateDescriptorSets(device, &set_info, &descriptor_set) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to allocate uniform ring descriptor set");
+        }
+
+        VkDescriptorBufferInfo descriptor_buffer{}; {
+            descriptor_buffer.buffer = ring.buffer;
+            descriptor_buffer.offset = 0;
+            descriptor_buffer.range = range;
+        }
+
+        VkWriteDescriptorSet write{}; {
+            write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            write.dstSet = descriptor_set;
+            write.dstBinding = 0;
+            write.descriptorCount = 1;
+            write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+            write.pBufferInfo = &descriptor_buffer;
+        }
+
+        vkUpdateDescriptorSets(device, 1, &write, 0, nullptr);
+    }
+
+    void uniform_ring::destroy() {
+        descriptor_pool.reset();
+        descriptor_set = VK_NULL_HANDLE;
+        set_layout.reset();
+        if (ring.buffer) {
+            allocator->destroy_buffer(ring);
+            ring = {};
+        }
+    }
+
+    VkDescriptorSetLayout uniform_ring::descriptor_set_layout() const {
+        return set_layout;
+    }
+
+    VkDeviceSize uniform_ring::capacity() const {
+        return region_size;
+    }
+
+    VkDeviceSize uniform_ring::used() const {
+        return std::min(head.load(std::memory_order_relaxed), region_size);
+    }
+
+    void uniform_ring::begin_frame(std::uint32_t frame) {
+        region_start = region_size * (frame % frame_count);
+        head.store(0, std::memory_order_relaxed);
+    }
+
+    uniform_allocation uniform_ring::allocate(VkDeviceSize size) {
+        if (size > range) {
+            throw std::runtime_error("Error, uniform ring allocation larger than its descriptor range");
+        }
+
+        const auto aligned = align_up(size, alignment);
+        const auto offset = head.fetch_add(aligned, std::memory_order_relaxed);
+        if (offset + aligned > region_size) {
+            throw std::runtime_error("Error, uniform ring frame region is full");
+        }
+
+        const auto absolute = region_start + offset;
+        return { static_cast<std::byte*>(ring.memory.mapped) + absolute, static_cast<std::uint32_t>(absolute) };
+    }
+
+    void uniform_ring::bind(const VkCommandBuffer& command_buffer, VkPipelineBindPoint bind_point, VkPipelineLayout layout,
+                            std::uint32_t set, std::uint32_t offset) const {
+        vkCmdBindDescriptorSets(command_buffer, bind_point, layout, set, 1, &descriptor_set, 1, &offset);
+    }
+} // namespace vk_playground
@@ -0,0 +1,246 @@
+#include "upload_manager.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include <frame_stats.hpp>
+
+namespace vk_playground {
+    void upload_manager::create(const VkDevice& device, memory_allocator& allocator, std::uint32_t graphics_family, std::uint32_t transfer_family,
+                                const VkQueue& transfer_queue, bool core_timeline, VkDeviceSize staging_size) {
+        this->device = device;
+        this->allocator = &allocator;
+        this->graphics_family = graphics_family;
+        this->transfer_family = transfer_family;
+        this->transfer_queue = transfer_queue;
+        stats = {};
+        stats.dedicated_queue = dedicated();
+
+        VkBufferCreateInfo staging_info{}; {
+            staging_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+            staging_info.size = staging_size;
+            staging_info.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+            staging_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        }
+
+        // Coherent so writes need no explicit flush, the staging buffer is only ever read by copies
+        staging = allocator.create_buffer(staging_info, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        if (staging.memory.mapped == nullptr) {
+            throw std::runtime_error("Error, staging buffer is not host visible");
+        }
+        ring = ring_allocator(staging_size);
+
+        if (dedicated()) {
+            transfer_timeline.create(device, core_timeline);
+        }
+    }
+
+    void upload_manager::destroy() {
+        batches.clear();
+        pending.clear();
+        if (dedicated()) {
+            transfer_timeline.destroy();
+        }
+        if (staging.buffer) {
+            allocator->destroy_buffer(staging);
+            staging = {};
+        }
+    }
+
+    bool upload_manager::dedicated() const {
+        return transfer_family != graphics_family;
+    }
+
+    bool upload_manager::idle() const {
+        return pending.empty();
+    }
+
+    const upload_statistics& upload_manager::statistics() const {
+        return stats;
+    }
+
+    VkSemaphore upload_manager::semaphore() const {
+        return transfer_timeline.handle();
+    }
+
+    void upload_manager::upload(VkBuffer buffer, VkDeviceSize offset, std::span<const std::byte> data) {
+        auto copy = std::make_shared<std::vector<std::byte>>(data.begin(), data.end());
+        std::span<const std::byte> view{ copy->data(), copy->size() };
+        upload(buffer, offset, view, std::move(copy));
+    }
+
+    void upload_manager::upload(VkBuffer buffer, VkDeviceSize offset, std::span<const std::byte> data, std::shared_ptr<const void> owner) {
+        if (data.empty()) {
+            return;
+        }
+
+        pending.push_back({ buffer, offset, data, std::move(owner), 0 });
+    }
+
+    upload_manager::transfer_batch& upload_manager::next_batch() {
+        // Reuse the pool of a batch the transfer queue has finished, there are only ever a few in flight
+        for (auto& batch : batches) {
+            if (batch.value <= transfer_timeline.completed()) {
+                vkResetCommandPool(device, batch.pool, 0);
+                return batch;
+            }
+        }
+
+        auto& batch = batches.emplace_back();
+
+        VkCommandPoolCreateInfo command_pool_info{}; {
+            command_pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+            command_pool_info.queueFamilyIndex = transfer_family;
+            command_pool_info.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+        }
+
+        if (vkCreateCommandPool(device, &command_pool_info, nullptr, batch.pool.put(device)) != VK_SUCCESS) {
+            throw std::runtime_error("Failed creating transfer command pool");
+        }
+
+        VkCommandBufferAllocateInfo command_buf_info{}; {
+            command_buf_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+            command_buf_info.commandPool = batch.pool;
+            command_buf_info.commandBufferCount = 1;
+            command_buf_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        }
+
+        if (vkAllocateCommandBuffers(device, &command_buf_info, &batch.command_buffer) != VK_SUCCESS) {
+            throw std::runtime_error("Failed allocating transfer command buffer");
+        }
+
+        return batch;
+    }
+
+    std::uint64_t upload_manager::flush(const VkCommandBuffer& graphics_command_buffer, std::uint64_t graphics_value, std::uint64_t graphics_completed) {
+        // Staging is released by whichever queue ran the copies
+        ring.release(dedicated() ? transfer_timeline.poll() : graphics_completed);
+
+        if (pending.empty()) {
+            return 0;
+        }
+
+        struct staged_copy {
+            VkBuffer buffer;
+            VkBufferCopy region;
+        };
+        std::vector<staged_copy> copies{};
+
+        auto budget = ring.size() / 2;
+        auto* staging_data = static_cast<std::byte*>(staging.memory.mapped);
+        while (!pending.empty() && budget >= copy_alignment) {
+            auto& upload = pending.front();
+            auto chunk = std::min<VkDeviceSize>(upload.data.size() - upload.uploaded, budget);
+
+            // The ring may only have a shorter run left before it wraps or reaches data in flight
+            auto offset = ring.allocate(chunk, copy_alignment);
+            while (!offset && chunk > min_chunk) {
+                chunk = std::max(chunk / 2, min_chunk);
+                offset = ring.allocate(chunk, copy_alignment);
+            }
+            if (!offset) {
+                break;
+            }
+
+            const auto copy_start = bench_clock::now();
+            std::memcpy(staging_data + *offset, upload.data.data() + upload.uploaded, chunk);
+            stats.staging_ms += elapsed_ms(copy_start);
+            copies.push_back({ upload.buffer, { *offset, upload.offset + upload.uploaded, chunk } });
+
+            upload.uploaded += chunk;
+            budget -= std::min(budget, align_up(chunk, copy_alignment));
+            stats.bytes += chunk;
+            if (upload.uploaded == upload.data.size()) {
+                pending.pop_front();
+            }
+        }
+
+        if (copies.empty()) {
+            return 0;
+        }
+        stats.copies += copies.size();
+        ++stats.batches;
+
+        if (!dedicated()) {
+            for (const auto& copy : copies) {
+                vkCmdCopyBuffer(graphics_command_buffer, staging.buffer, copy.buffer, 1, &copy.region);
+            }
+
+            VkMemoryBarrier barrier{}; {
+                barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+                barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+                barrier.dstAccessMask = consumer_access;
+            }
+
+            vkCmdPipelineBarrier(graphics_command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, consumer_stages, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+            ring.mark(graphics_value);
+
+            return 0;
+        }
+
+        // Release on the transfer queue and acquire on the graphics queue, same ranges on both sides
+        std::vector<VkBufferMemoryBarrier> ownership_barriers(copies.size());
+        for (std::size_t i = 0; i < copies.size(); ++i) {
+            auto& barrier = ownership_barriers[i]; {
+                barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+                barrier.srcQueueFamilyIndex = transfer_family;
+                barrier.dstQueueFamilyIndex = graphics_family;
+                barrier.buffer = copies[i].buffer;
+                barrier.offset = copies[i].region.dstOffset;
+                barrier.size = copies[i].region.size;
+            }
+        }
+
+        auto& batch = next_batch();
+
+        VkCommandBufferBeginInfo cmd_buf_begin_info{}; {
+            cmd_buf_begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+            cmd_buf_begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        }
+
+        vkBeginCommandBuffer(batch.command_buffer, &cmd_buf_begin_info);
+        for (const auto& copy : copies) {
+            vkCmdCopyBuffer(batch.command_buffer, staging.buffer, copy.buffer, 1, &copy.region);
+        }
+        for (auto& barrier : ownership_barriers) {
+            barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            barrier.dstAccessMask = 0;
+        }
+        vkCmdPipelineBarrier(batch.command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0,
+                             0, nullptr, ownership_barriers.size(), ownership_barriers.data(), 0, nullptr);
+        vkEndCommandBuffer(batch.command_buffer);
+
+        batch.value = transfer_timeline.next();
+        const auto signal_semaphore = transfer_timeline.handle();
+
+        VkTimelineSemaphoreSubmitInfo timeline_submit_info{}; {
+            timeline_submit_info.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+            timeline_submit_info.signalSemaphoreValueCount = 1;
+            timeline_submit_info.pSignalSemaphoreValues = &batch.value;
+        }
+
+        VkSubmitInfo submit_info{}; {
+            submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+            submit_info.pNext = &timeline_submit_info;
+            submit_info.commandBufferCount = 1;
+            submit_info.pCommandBuffers = &batch.command_buffer;
+            submit_info.signalSemaphoreCount = 1;
+            submit_info.pSignalSemaphores = &signal_semaphore;
+        }
+
+        if (vkQueueSubmit(transfer_queue, 1, &submit_info, nullptr) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to submit transfer batch");
+        }
+        ring.mark(batch.value);
+
+        for (auto& barrier : ownership_barriers) {
+            barrier.srcAccessMask = 0;
+            barrier.dstAccessMask = consumer_access;
+        }
+        vkCmdPipelineBarrier(graphics_command_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, consumer_stages, 0,
+                             0, nullptr, ownership_barriers.size(), ownership_barriers.data(), 0, nullptr);
+
+        return batch.value;
+    }
+} // namespace vk_playground
@@ -0,0 +1,195 @@
+// Converts Wavefront OBJ files into the binary mesh format read by load_mesh().
+//
+//   mesh_converter input.obj output.vmsh
+//
+// Only positions and faces are read, polygons are fanned into triangles. Each o, g or usemtl
+// statement starts a new submesh. Vertex colors come from the "v x y z r g b" extension when
+// present, otherwise from the vertex position inside the mesh bounds.
+
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include <mesh_format.hpp>
+
+using namespace vk_playground;
+
+struct obj_mesh {
+    std::vector<mesh_vertex> vertices{};
+    std::vector<bool> has_color{};
+    std::vector<std::uint32_t> indices{};
+    std::vector<mesh_submesh> submeshes{};
+};
+
+static mesh_bounds empty_bounds() {
+    return { { FLT_MAX, FLT_MAX, FLT_MAX }, { -FLT_MAX, -FLT_MAX, -FLT_MAX } };
+}
+
+static void expand(mesh_bounds& bounds, const float* position) {
+    for (int i = 0; i < 3; ++i) {
+        bounds.min[i] = std::min(bounds.min[i], position[i]);
+        bounds.max[i] = std::max(bounds.max[i], position[i]);
+    }
+}
+
+static std::uint32_t resolve_index(const std::string& token, std::size_t vertex_count) {
+    // "v", "v/vt", "v//vn" or "v/vt/vn", only the position index matters
+    const long index = std::stol(token.substr(0, token.find('/')));
+    const long resolved = index < 0 ? static_cast<long>(vertex_count) + index : index - 1;
+    if (resolved < 0 || resolved >= static_cast<long>(vertex_count)) {
+        throw std::runtime_error("Error, face references missing vertex " + token);
+    }
+
+    return static_cast<std::uint32_t>(resolved);
+}
+
+static void close_submesh(obj_mesh& mesh) {
+    if (!mesh.submeshes.empty() && mesh.submeshes.back().index_count == 0) {
+        mesh.submeshes.pop_back();
+    }
+
+    mesh_submesh submesh{}; {
+        submesh.first_index = mesh.indices.size();
+        submesh.bounds = empty_bounds();
+    }
+    mesh.submeshes.emplace_back(submesh);
+}
+
+static obj_mesh parse_obj(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        throw std::runtime_error("Error, " + path + " not found");
+    }
+
+    obj_mesh mesh{};
+    close_submesh(mesh);
+
+    std::string line{};
+    std::vector<std::string> face{};
+    while (std::getline(file, line)) {
+        std::istringstream stream(line);
+        std::string keyword{};
+        stream >> keyword;
+
+        if (keyword == "v") {
+            mesh_vertex vertex{};
+            stream >> vertex.position[0] >> vertex.position[1] >> vertex.position[2];
+            const bool colored = static_cast<bool>(stream >> vertex.color[0] >> vertex.color[1] >> vertex.color[2]);
+            mesh.vertices.emplace_back(vertex);
+            mesh.has_color.emplace_back(colored);
+        } else if (keyword == "f") {
+            face.clear();
+            for (std::string token{}; stream >> token;) {
+                face.emplace_back(token);
+            }
+            if (face.size() < 3) {
+                continue;
+            }
+
+            auto& submesh = mesh.submeshes.back();
+            const auto first = resolve_index(face[0], mesh.vertices.size());
+            for (std::size_t i = 1; i + 1 < face.size(); ++i) {
+                for (auto index : { first, resolve_index(face[i], mesh.vertices.size()), resolve_index(face[i + 1], mesh.vertices.size()) }) {
+                    mesh.indices.emplace_back(index);
+                    expand(submesh.bounds, mesh.vertices[index].position);
+                }
+                submesh.index_count += 3;
+            }
+        } else if (keyword == "o" || keyword == "g" || keyword == "usemtl") {
+            close_submesh(mesh);
+        }
+    }
+
+    if (mesh.submeshes.back().index_count == 0) {
+        mesh.submeshes.pop_back();
+    }
+
+    return mesh;
+}
+
+static void write_padding(std::ofstream& file) {
+    static const char zeros[mesh_stream_alignment]{};
+    const auto position = static_cast<std::uint64_t>(file.tellp());
+    file.write(zeros, (mesh_stream_alignment - position % mesh_stream_alignment) % mesh_stream_alignment);
+}
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        std::cerr << "usage: mesh_converter input.obj output.vmsh\n";
+        return 1;
+    }
+
+    try {
+        const auto start = std::chrono::steady_clock::now();
+        auto mesh = parse_obj(argv[1]);
+        if (mesh.indices.empty()) {
+            throw std::runtime_error(std::string("Error, ") + argv[1] + " has no faces");
+        }
+
+        mesh_header header{}; {
+            header.magic = mesh_magic;
+            header.version = mesh_version;
+            header.vertex_stride = sizeof(mesh_vertex);
+            header.index_size = sizeof(std::uint32_t);
+            header.vertex_count = mesh.vertices.size();
+            header.index_count = mesh.indices.size();
+            header.submesh_count = mesh.submeshes.size();
+            header.bounds = empty_bounds();
+        }
+        for (const auto& vertex : mesh.vertices) {
+            expand(header.bounds, vertex.position);
+        }
+
+        for (std::size_t i = 0; i < mesh.vertices.size(); ++i) {
+            if (mesh.has_color[i]) {
+                continue;
+            }
+            for (int axis = 0; axis < 3; ++axis) {
+                const auto extent = header.bounds.max[axis] - header.bounds.min[axis];
+                mesh.vertices[i].color[axis] = extent > 0.0f ? (mesh.vertices[i].position[axis] - header.bounds.min[axis]) / extent : 1.0f;
+            }
+        }
+
+        const auto aligned = [](std::uint64_t value) {
+            return (value + mesh_stream_alignment - 1) / mesh_stream_alignment * mesh_stream_alignment;
+        };
+        header.submesh_offset = aligned(sizeof(mesh_header));
+        header.vertex_offset = aligned(header.submesh_offset + mesh.submeshes.size() * sizeof(mesh_submesh));
+        header.index_offset = aligned(header.vertex_offset + mesh.vertices.size() * sizeof(mesh_vertex));
+
+        std::ofstream file(argv[2], std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            throw std::runtime_error(std::string("Error, failed to open ") + argv[2] + " for writing");
+        }
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        write_padding(file);
+        file.write(reinterpret_cast<const char*>(mesh.submeshes.data()), mesh.submeshes.size() * sizeof(mesh_submesh));
+        write_padding(file);
+        file.write(reinterpret_cast<const char*>(mesh.vertices.data()), mesh.vertices.size() * sizeof(mesh_vertex));
+        write_padding(file);
+        file.write(reinterpret_cast<const char*>(mesh.indices.data()), mesh.indices.size() * sizeof(std::uint32_t));
+        if (!file) {
+            throw std::runtime_error(std::string("Error, failed writing ") + argv[2]);
+        }
+
+        std::cout << fmt::format("{}: {} vertices, {} triangles, {} submeshes, {} bytes in {:.2f} ms\n",
+                                 argv[2], header.vertex_count, header.index_count / 3, header.submesh_count,
+                                 static_cast<std::uint64_t>(file.tellp()),
+                                 std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    } catch (const std::exception& error) {
+        std::cerr << error.what() << '\n';
+        return 1;
+    }
+
+    return 0;
+}